@@ -17,7 +17,18 @@
 extern "C" {
 #endif
 
-#ifdef CONFIG_DEBUG_ASSERT
+#if defined(HOST_TOOLS_BUILD)
+/*
+ * EC code linked into host tools has no panic_assert_fail(); stop the tool
+ * right there so that a debugger or core dump shows the failed assertion.
+ */
+#define ASSERT(cond)                       \
+	do {                               \
+		if (!(cond))               \
+			__builtin_trap();  \
+	} while (0)
+
+#elif defined(CONFIG_DEBUG_ASSERT)
 #ifdef CONFIG_DEBUG_ASSERT_REBOOTS
 
 #ifdef CONFIG_DEBUG_ASSERT_BRIEF
@@ -64,9 +75,9 @@ extern noreturn void panic_assert_fail(const char *msg, const char *func,
 	} while (0)
 #endif /* CONFIG_DEBUG_ASSERT_REBOOTS */
 
-#else /* !CONFIG_DEBUG_ASSERT */
+#else /* !HOST_TOOLS_BUILD && !CONFIG_DEBUG_ASSERT */
 #define ASSERT(cond)
-#endif /* CONFIG_DEBUG_ASSERT */
+#endif /* HOST_TOOLS_BUILD */
 
 /* This collides with cstdlib, so exclude it where cstdlib is supported. */
 #ifndef assert
@@ -9,8 +9,10 @@
 #include "host_command.h"
 #include "shared_mem.h"
 #include "spi.h"
+#include "spi_chip.h"
 #include "spi_flash.h"
 #include "system.h"
+#include "task.h"
 #include "util.h"
 #include "hooks.h"
 #include "tfdp_chip.h"
@@ -22,6 +24,16 @@
 
 static int entire_flash_locked;
 
+#ifdef CONFIG_FLASH_READ_ASYNC
+#ifndef CHIP_FAMILY_MEC172X
+#error "Background flash reads need MEC172x back to back SPI transactions"
+#endif
+/* Serializes flash access against background reads */
+static struct mutex flash_mutex;
+/* Read command, must stay valid while the transfer is in flight */
+static uint8_t async_read_cmd[4];
+#endif
+
 /* The previous write protect state before sys jump */
 
 struct flash_wp_state {
@@ -40,8 +52,58 @@ int crec_flash_physical_read(int offset, int size, char *data)
 	trace13(0, FLASH, 0,
 		"flash_phys_read: offset=0x%08X size=0x%08X dataptr=0x%08X",
 		offset, size, (uint32_t)data);
+#ifdef CONFIG_FLASH_READ_ASYNC
+	int rv;
+
+	mutex_lock(&flash_mutex);
+	rv = spi_flash_read(data, offset, size);
+	mutex_unlock(&flash_mutex);
+	return rv;
+#else
 	return spi_flash_read(data, offset, size);
+#endif
+}
+
+#ifdef CONFIG_FLASH_READ_ASYNC
+/*
+ * Background reads use a single QMSPI descriptor transfer with RX DMA. The
+ * flash mutex is held from the start of the read until it is waited on so
+ * that no other flash operation can be issued while the DMA is running. The
+ * SPI port mutex is held too, for the status and protect register accesses
+ * which go straight to spi_transaction().
+ */
+int crec_flash_physical_read_async(int offset, int size, char *data)
+{
+	int rv;
+
+	if (offset < 0 || size <= 0 ||
+	    offset + size > CONFIG_FLASH_SIZE_BYTES)
+		return EC_ERROR_INVAL;
+
+	mutex_lock(&flash_mutex);
+
+	async_read_cmd[0] = SPI_FLASH_READ;
+	async_read_cmd[1] = (offset >> 16) & 0xFF;
+	async_read_cmd[2] = (offset >> 8) & 0xFF;
+	async_read_cmd[3] = offset & 0xFF;
+
+	rv = spi_transaction_async_locked(SPI_FLASH_DEVICE, async_read_cmd,
+					  sizeof(async_read_cmd),
+					  (uint8_t *)data, size);
+	if (rv != EC_SUCCESS)
+		mutex_unlock(&flash_mutex);
+	return rv;
+}
+
+int crec_flash_physical_read_wait(void)
+{
+	int rv;
+
+	rv = spi_transaction_flush_locked(SPI_FLASH_DEVICE);
+	mutex_unlock(&flash_mutex);
+	return rv;
 }
+#endif /* CONFIG_FLASH_READ_ASYNC */
 
 /**
  * Write to physical flash.
@@ -68,6 +130,9 @@ int crec_flash_physical_write(int offset, int size, const char *data)
 	if ((offset | size | (uint32_t)(uintptr_t)data) & 3)
 		return EC_ERROR_INVAL;
 
+#ifdef CONFIG_FLASH_READ_ASYNC
+	mutex_lock(&flash_mutex);
+#endif
 	for (i = 0; i < size; i += write_size) {
 		write_size = MIN((size - i), SPI_FLASH_MAX_WRITE_SIZE);
 		ret = spi_flash_write(offset + i,
@@ -76,6 +141,9 @@ int crec_flash_physical_write(int offset, int size, const char *data)
 		if (ret != EC_SUCCESS)
 			break;
 	}
+#ifdef CONFIG_FLASH_READ_ASYNC
+	mutex_unlock(&flash_mutex);
+#endif
 	return ret;
 }
 
@@ -97,7 +165,13 @@ int crec_flash_physical_erase(int offset, int size)
 	trace12(0, FLASH, 0,
 		"flash_phys_erase: offset=0x%08X size=0x%08X",
 		offset, size);
+#ifdef CONFIG_FLASH_READ_ASYNC
+	mutex_lock(&flash_mutex);
+#endif
 	ret = spi_flash_erase(offset, size);
+#ifdef CONFIG_FLASH_READ_ASYNC
+	mutex_unlock(&flash_mutex);
+#endif
 	return ret;
 }
 
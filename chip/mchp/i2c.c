@@ -7,6 +7,8 @@
 
 #include "common.h"
 #include "console.h"
+#include "dma.h"
+#include "dma_chip.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "i2c.h"
@@ -70,6 +72,7 @@
 #define COMP_BIDEN		BIT(5) /* enable Bus idle timeouts */
 #define COMP_IDLE		BIT(29) /* i2c bus is idle */
 #define COMP_RW_BITS_MASK	0x3C /* R/W bits mask */
+#define COMP_MNAKX		BIT(24) /* controller received NACK */
 /* Configuration */
 #define CFG_PORT_MASK		(0x0F) /* port selection field */
 #define CFG_TCEN		BIT(4) /* Enable HW bus timeouts */
@@ -77,6 +80,8 @@
 #define CFG_RESET		BIT(9) /* reset controller */
 #define CFG_ENABLE		BIT(10) /* enable controller */
 #define CFG_GC_DIS		BIT(14) /* disable general call address */
+#define CFG_FLUSH_MXBUF		BIT(18) /* flush controller TX buffer */
+#define CFG_FLUSH_MRBUF		BIT(19) /* flush controller RX buffer */
 #define CFG_ENIDI		BIT(29) /* Enable I2C idle interrupt */
 /* Enable network layer controller done interrupt */
 #define CFG_ENMI		BIT(30)
@@ -785,6 +790,150 @@ static int i2c_mrx_data(int ctrl)
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_MCHP_I2C_DMA_THRESHOLD
+/*
+ * The network layer takes the address bytes from the same buffer as the
+ * data, so the write phase of a DMA transfer is staged here.
+ */
+#define I2C_DMA_TX_BUF_SIZE 64
+static uint8_t dma_tx_buf[I2C_CONTROLLER_COUNT][I2C_DMA_TX_BUF_SIZE];
+
+/*
+ * Use the network layer and DMA for complete (START to STOP) transactions
+ * long enough that polling each byte would keep the CPU busy.
+ */
+static bool i2c_use_dma(int ctrl)
+{
+	int out_size = cdata[ctrl].out_size;
+	int in_size = cdata[ctrl].in_size;
+
+#ifdef CHIP_FAMILY_MEC152X
+	/* Controllers 5-7 do not implement network layer hardware */
+	if (ctrl > MCHP_I2C_CTRL4)
+		return false;
+#endif
+	if (cdata[ctrl].xflags != I2C_XFER_SINGLE ||
+	    cdata[ctrl].transaction_state != I2C_TRANSACTION_STOPPED)
+		return false;
+	if (out_size + in_size < CONFIG_MCHP_I2C_DMA_THRESHOLD)
+		return false;
+
+	/* Room for the write and read addresses */
+	return out_size + 2 <= I2C_DMA_TX_BUF_SIZE &&
+	       in_size <= MCMD_RCNT_MASK0;
+}
+
+/*
+ * Sleep until the controller clears MPROCEED, which it does when pausing
+ * between the write and read phases and when the command is done. The
+ * controller done interrupt (CFG_ENMI) fires on both.
+ */
+static int wait_controller_cmd(int ctrl)
+{
+	const uint32_t busy = MCMD_MRUN | MCMD_MPROCEED;
+	uintptr_t raddr = chip_i2c_ctrl_base(ctrl);
+	uint64_t deadline = get_time().val + cdata[ctrl].timeout_us;
+	uint64_t now;
+
+	while ((MCHP_I2C_MASTER_CMD(raddr) & busy) == busy) {
+		now = get_time().val;
+		if (now >= deadline)
+			return EC_ERROR_TIMEOUT;
+		wait_for_interrupt(ctrl, deadline - now);
+	}
+	return EC_SUCCESS;
+}
+
+/*
+ * I2C Controller transfer using the network layer.
+ * DMA feeds the controller TX buffer with the address and write data, and
+ * empties the controller RX buffer into the caller's buffer; the hardware
+ * generates START, Repeated-START, (N)ACK and STOP itself.
+ * Caller has filled in cdata[ctrl] parameters
+ */
+static int i2c_dma_xfer(int ctrl)
+{
+	uintptr_t raddr = chip_i2c_ctrl_base(ctrl);
+	uint8_t *tx = dma_tx_buf[ctrl];
+	int out_size = cdata[ctrl].out_size;
+	int in_size = cdata[ctrl].in_size;
+	struct dma_option dma = {
+		/* Channels are dedicated to the device of the same number */
+		.channel = MCHP_DMAC_I2C0_MASTER + 2 * ctrl,
+		.periph = (void *)&MCHP_I2C_MASTER_TX_BUF(raddr),
+	};
+	uint32_t cmd = MCMD_MRUN | MCMD_MPROCEED | MCMD_START0 | MCMD_STOP;
+	int wcnt = 0;
+	int rv;
+
+	cdata[ctrl].flags |= (1ul << 24);
+	if (out_size) {
+		tx[wcnt++] = cdata[ctrl].periph_addr_8bit;
+		memcpy(tx + wcnt, cdata[ctrl].outp, out_size);
+		wcnt += out_size;
+	}
+	if (in_size) {
+		/* Repeated-START before the read address if we wrote first */
+		if (wcnt)
+			cmd |= MCMD_STARTN;
+		tx[wcnt++] = cdata[ctrl].periph_addr_8bit | 0x01;
+	}
+	cmd |= (wcnt << MCMD_WCNT_BITPOS) | (in_size << MCMD_RCNT_BITPOS);
+
+	MCHP_I2C_CONFIG(raddr) |= CFG_FLUSH_MXBUF | CFG_FLUSH_MRBUF;
+	MCHP_I2C_COMPLETE(raddr) = MCHP_I2C_COMPLETE(raddr);
+	dma_clear_isr(dma.channel);
+	dma_xfr_prepare_tx(&dma, wcnt, tx, 1);
+	dma_go(dma_get_channel(dma.channel));
+
+	MCHP_I2C_CONFIG(raddr) |= CFG_ENMI;
+	cdata[ctrl].transaction_state = I2C_TRANSACTION_OPEN;
+	MCHP_I2C_MASTER_CMD(raddr) = cmd;
+
+	rv = wait_controller_cmd(ctrl);
+	if (rv == EC_SUCCESS && (MCHP_I2C_MASTER_CMD(raddr) & MCMD_MRUN)) {
+		/* Paused after the write phase: point the channel at RX */
+		cdata[ctrl].flags |= (1ul << 25);
+		dma_disable(dma.channel);
+		dma_clear_isr(dma.channel);
+		dma.periph = (void *)&MCHP_I2C_MASTER_RX_BUF(raddr);
+		dma_xfr_start_rx(&dma, 1, in_size, cdata[ctrl].inp);
+		MCHP_I2C_MASTER_CMD(raddr) |= MCMD_MPROCEED;
+		rv = wait_controller_cmd(ctrl);
+	}
+
+	dma_disable(dma.channel);
+	dma_clear_isr(dma.channel);
+	MCHP_I2C_CONFIG(raddr) &= ~CFG_ENMI;
+	cdata[ctrl].i2c_complete |= MCHP_I2C_COMPLETE(raddr);
+
+	if (rv) {
+		/* Stop the network layer mid-command */
+		cdata[ctrl].flags |= (1ul << 26);
+		MCHP_I2C_MASTER_CMD(raddr) = 0;
+		reset_controller(ctrl);
+		return rv;
+	}
+	if (cdata[ctrl].i2c_complete & COMP_MNAKX) {
+		cdata[ctrl].flags |= (1ul << 27);
+		return EC_ERROR_UNKNOWN;
+	}
+
+	cdata[ctrl].transaction_state = I2C_TRANSACTION_STOPPED;
+	return EC_SUCCESS;
+}
+#else
+static bool i2c_use_dma(int ctrl)
+{
+	return false;
+}
+
+static int i2c_dma_xfer(int ctrl)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+#endif /* CONFIG_MCHP_I2C_DMA_THRESHOLD */
+
 /*
  * Called from common I2C
  */
@@ -833,6 +982,13 @@ int chip_i2c_xfer(int port, uint16_t periph_addr_flags, const uint8_t *out,
 	}
 
 	ret_done = EC_SUCCESS;
+	if (i2c_use_dma(ctrl)) {
+		ret_done = i2c_dma_xfer(ctrl);
+		if (ret_done)
+			goto err_chip_i2c_xfer;
+		goto xfer_done;
+	}
+
 	if (out_size) {
 		ret_done = i2c_mtx(ctrl);
 		if (ret_done)
@@ -850,6 +1006,7 @@ int chip_i2c_xfer(int port, uint16_t periph_addr_flags, const uint8_t *out,
 			goto err_chip_i2c_xfer;
 	}
 
+xfer_done:
 	cdata[ctrl].flags |= (1ul << 15);
 	/* MCHP wait for STOP to complete */
 	if (cdata[ctrl].xflags & I2C_XFER_STOP)
@@ -1034,7 +1191,7 @@ static void handle_interrupt(int controller)
 	/* Clear all interrupt status */
 	r = MCHP_I2C_COMPLETE(raddr);
 	MCHP_I2C_COMPLETE(raddr) = r;
-	cdata[controller].i2c_complete = r;
+	cdata[controller].i2c_complete |= r;
 	MCHP_INT_SOURCE(MCHP_I2C_GIRQ) = MCHP_I2C_GIRQ_BIT(controller);
 
 	/* Wake up the task which was waiting on the I2C interrupt, if any. */
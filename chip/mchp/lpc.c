@@ -33,8 +33,22 @@
 #define CPRINTS(...)
 #endif
 
+/*
+ * EMI0 memory layout: host command packet, memory-mapped data, then the
+ * optional bulk window for EC_CMD_FLASH_READ_BULK.
+ */
+#define MEM_MAPPED_BULK_OFFSET 0x200
+#ifdef CONFIG_HOSTCMD_FLASH_READ_BULK
+#define MEM_MAPPED_SIZE \
+	(MEM_MAPPED_BULK_OFFSET + CONFIG_HOSTCMD_FLASH_READ_BULK_SIZE)
+#else
+#define MEM_MAPPED_SIZE MEM_MAPPED_BULK_OFFSET
+#endif
+/* Host programs a 16-bit EMI offset */
+BUILD_ASSERT(MEM_MAPPED_SIZE < 0x10000);
+
 static uint8_t
-mem_mapped[0x200] __attribute__((section(".bss.big_align")));
+mem_mapped[MEM_MAPPED_SIZE] __attribute__((section(".bss.big_align")));
 
 static struct host_packet lpc_packet;
 static struct host_cmd_handler_args host_cmd_args;
@@ -274,6 +288,14 @@ uint8_t *lpc_get_memmap_range(void)
 	return mem_mapped + 0x100;
 }
 
+#ifdef CONFIG_HOSTCMD_FLASH_READ_BULK
+__override uint8_t *lpc_get_bulk_window(int *size)
+{
+	*size = CONFIG_HOSTCMD_FLASH_READ_BULK_SIZE;
+	return mem_mapped + MEM_MAPPED_BULK_OFFSET;
+}
+#endif
+
 void lpc_mem_mapped_init(void)
 {
 	/* We support LPC arguments and version 3 protocol */
@@ -387,7 +409,8 @@ void chip_8042_config(uint32_t io_base)
  * in SRAM. EMI hardware adds 16-bit offset Host programs into
  * EC_Address_LSB/MSB registers.
  * Limit EMI read / write range. First 256 bytes are RW for host
- * commands. Second 256 bytes are RO for memory-mapped data.
+ * commands. Second 256 bytes are RO for memory-mapped data. The
+ * bulk window, if any, follows and is also RO.
  * Hardware decodes a fixed 16 byte IO range.
  */
 void chip_emi0_config(uint32_t io_base)
@@ -402,7 +425,7 @@ void chip_emi0_config(uint32_t io_base)
 
 	MCHP_EMI_MBA0(0) = (uint32_t)mem_mapped;
 
-	MCHP_EMI_MRL0(0) = 0x200;
+	MCHP_EMI_MRL0(0) = MEM_MAPPED_SIZE;
 	MCHP_EMI_MWL0(0) = 0x100;
 
 	MCHP_INT_ENABLE(MCHP_EMI_GIRQ) = MCHP_EMI_GIRQ_BIT(0);
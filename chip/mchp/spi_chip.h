@@ -54,6 +54,22 @@
 const void *spi_dma_option(const struct spi_device_t *spi_device,
 				int is_tx);
 
+/*
+ * Start an asynchronous transaction holding the SPI port mutex, so that
+ * spi_transaction() callers on the same port wait for it. The mutex is
+ * released by spi_transaction_flush_locked(), or before returning if the
+ * transaction could not be started.
+ */
+int spi_transaction_async_locked(const struct spi_device_t *spi_device,
+				 const uint8_t *txdata, int txlen,
+				 uint8_t *rxdata, int rxlen);
+
+/*
+ * Finish a transaction started with spi_transaction_async_locked() and
+ * release the SPI port mutex.
+ */
+int spi_transaction_flush_locked(const struct spi_device_t *spi_device);
+
 #endif /* #ifndef _QMSPI_CHIP_H */
 /**   @}
  */
@@ -0,0 +1,117 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* CRC-32 context API on the STM32 CRC unit */
+
+#include "common.h"
+#include "crc.h"
+#include "registers.h"
+#include "task.h"
+#include "util.h"
+
+#define CRC32_INITIAL 0xFFFFFFFF
+
+#define CRC_CR_WORD (STM32_CRC_CR_REV_OUT | STM32_CRC_CR_REV_IN_WORD)
+#define CRC_CR_BYTE (STM32_CRC_CR_REV_OUT | STM32_CRC_CR_REV_IN_BYTE)
+
+static uint32_t bitrev32(uint32_t v)
+{
+	v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+	v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+	v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+	return __builtin_bswap32(v);
+}
+
+/*
+ * Load a (reflected) CRC state into the unit. DR reads back the state
+ * bit-reversed because of REV_OUT, so INIT takes the reverse of what DR
+ * will return.
+ */
+static void crc_hw_load(uint32_t state)
+{
+	STM32_CRC_INIT = bitrev32(state);
+	STM32_CRC_CR = STM32_CRC_CR_RESET | CRC_CR_WORD;
+	while (STM32_CRC_CR & STM32_CRC_CR_RESET)
+		;
+}
+
+void crc32_ctx_init(uint32_t *ctx)
+{
+	*ctx = CRC32_INITIAL;
+}
+
+/*
+ * Interrupts stay locked while the unit holds a context state, so long
+ * buffers go through in chunks of this many bytes.
+ */
+#define CRC_HW_CHUNK 64
+
+static void crc_hw_hash_chunk(uint32_t *ctx, const uint8_t *p, int size)
+{
+	uint32_t saved;
+	uint32_t key;
+
+	key = irq_lock();
+
+	/* Preserve the stream of the static variant */
+	STM32_RCC_AHBENR |= BIT(6);
+	clock_wait_bus_cycles(BUS_AHB, 1);
+	saved = STM32_CRC_DR;
+
+	crc_hw_load(*ctx);
+
+	while (size && ((uintptr_t)p & 3)) {
+		STM32_CRC_CR = CRC_CR_BYTE;
+		STM32_CRC_DR8 = *p++;
+		size--;
+	}
+
+	STM32_CRC_CR = CRC_CR_WORD;
+	for (; size >= 4; size -= 4, p += 4)
+		STM32_CRC_DR32 = *(const uint32_t *)p;
+
+	STM32_CRC_CR = CRC_CR_BYTE;
+	while (size--)
+		STM32_CRC_DR8 = *p++;
+
+	*ctx = STM32_CRC_DR;
+
+	crc_hw_load(saved);
+
+	irq_unlock(key);
+}
+
+void crc32_ctx_hash(uint32_t *ctx, const void *buf, int size)
+{
+	const uint8_t *p = buf;
+	int n;
+
+	while (size > 0) {
+		n = MIN(size, CRC_HW_CHUNK);
+		crc_hw_hash_chunk(ctx, p, n);
+		p += n;
+		size -= n;
+	}
+}
+
+void crc32_ctx_hash32(uint32_t *ctx, uint32_t val)
+{
+	crc32_ctx_hash(ctx, &val, sizeof(val));
+}
+
+void crc32_ctx_hash16(uint32_t *ctx, uint16_t val)
+{
+	crc32_ctx_hash(ctx, &val, sizeof(val));
+}
+
+void crc32_ctx_hash8(uint32_t *ctx, uint8_t val)
+{
+	crc32_ctx_hash(ctx, &val, sizeof(val));
+}
+
+uint32_t crc32_ctx_result(uint32_t *ctx)
+{
+	return *ctx ^ 0xFFFFFFFF;
+}
@@ -16,6 +16,8 @@ static inline void crc32_init(void)
 	STM32_RCC_AHBENR |= BIT(6); /* switch on CRC controller */
 	/* Delay 1 AHB clock cycle after the clock is enabled */
 	clock_wait_bus_cycles(BUS_AHB, 1);
+	/* the context variant below may have changed the initial value */
+	STM32_CRC_INIT = 0xFFFFFFFF;
 	/* reset CRC state */
 	STM32_CRC_CR = STM32_CRC_CR_RESET | STM32_CRC_CR_REV_OUT
 		     | STM32_CRC_CR_REV_IN_WORD;
@@ -38,4 +40,22 @@ static inline uint32_t crc32_result(void)
 	return STM32_CRC_DR ^ 0xFFFFFFFF;
 }
 
+/*
+ * Provided context variant, computed on the CRC unit. Each call saves and
+ * restores the state of the static variant above, so both can be used at
+ * the same time.
+ */
+
+void crc32_ctx_init(uint32_t *ctx);
+
+void crc32_ctx_hash(uint32_t *ctx, const void *buf, int size);
+
+void crc32_ctx_hash32(uint32_t *ctx, uint32_t val);
+
+void crc32_ctx_hash16(uint32_t *ctx, uint16_t val);
+
+void crc32_ctx_hash8(uint32_t *ctx, uint8_t val);
+
+uint32_t crc32_ctx_result(uint32_t *ctx);
+
 #endif /* __CROS_EC_CRC_HW_H */
@@ -6,6 +6,7 @@
 /* Console output module for Chrome EC */
 
 #include "console.h"
+#include "printf.h"
 #include "uart.h"
 #include "usb_console.h"
 #include "util.h"
@@ -119,6 +120,30 @@ int cprints(enum console_channel channel, const char *format, ...)
 	if (console_channel_is_disabled(channel))
 		return EC_SUCCESS;
 
+#ifdef CONFIG_CONSOLE_TOKENIZED
+	/* Only the UART log is tokenized; the USB console stays text. */
+	va_start(args, format);
+	rv = uart_vtokenize(TOKENIZE_TIMESTAMP, format, args);
+	va_end(args);
+
+	if (IS_ENABLED(CONFIG_USB_CONSOLE)) {
+		char ts[32];
+
+		snprintf(ts, sizeof(ts), "[%pT ", PRINTF_TIMESTAMP_NOW);
+		r = usb_puts(ts);
+		if (r)
+			rv = r;
+		usb_va_start(args, format);
+		r = usb_vprintf(format, args);
+		if (r)
+			rv = r;
+		usb_va_end(args);
+		r = usb_puts("]\n");
+		if (r)
+			rv = r;
+	}
+	return rv;
+#else
 	rv = cprintf(channel, "[%pT ", PRINTF_TIMESTAMP_NOW);
 
 	va_start(args, format);
@@ -135,6 +160,7 @@ int cprints(enum console_channel channel, const char *format, ...)
 
 	r = cputs(channel, "]\n");
 	return r ? r : rv;
+#endif /* CONFIG_CONSOLE_TOKENIZED */
 }
 #endif /* CONFIG_ZEPHYR */
 
@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "atomic.h"
 #include "common.h"
 #include "console.h"
 #include "event_log.h"
@@ -19,115 +20,181 @@ static struct event_log_entry log_events[UNIT_COUNT];
 BUILD_ASSERT(POWER_OF_TWO(UNIT_COUNT));
 
 /*
- * The FIFO pointers are defined as following :
- * "log_head" is the next available event to dequeue.
- * "log_tail" is marking the end of the FIFO content (after last committed
- *  event)
- * "log_tail_next" is the next available spot to enqueue events.
- * The pointers are not wrapped until they are used, so we don't need an extra
- * entry to disambiguate between full and empty FIFO.
+ * The FIFO is lock-free for any number of writers and a single reader (host
+ * commands, VDM or TPM command handler):
  *
- * For concurrency, several tasks might try to enqueue events in parallel with
- * log_add_event(). Only one task is dequeuing events (host commands, VDM,
- * TPM command handler). When the FIFO is full, log_add_event() will discard
- * the oldest events, so "log_head" is incremented/decremented in a critical
- * section since it is accessed from both log_add_event() and
- * log_dequeue_event(). log_tail_next is also protected as several writers can
- * race to add an event to the queue.
- * When a writer is done adding its event, it is updating log_tail,
- * so the event can be consumed by log_dequeue_event().
+ * "log_free" counts the units which are neither reserved nor waiting to be
+ * read.  A writer first takes its units from it, and drops the event if there
+ * isn't enough room, so writers never wait for the reader or each other.
+ * "log_tail_next" is the next unit to hand out; a writer which got its room
+ * takes its position from it with a single atomic add.
+ * "log_committed" has a bit per unit, set by the writer on the first unit of
+ * its entry once the entry is complete.  Entries can complete in any order;
+ * the reader stops at the first one which hasn't.
+ * "log_head" is the next unit to read, and only the reader touches it.
+ *
+ * The positions are not wrapped until they are used.
  */
 static size_t log_head;
-static size_t log_tail;
-static size_t log_tail_next;
+static atomic_t log_tail_next;
+static atomic_t log_free = UNIT_COUNT;
+static atomic_t log_committed[DIV_ROUND_UP(UNIT_COUNT, 32)];
+
+/* Events dropped because the FIFO was full */
+static atomic_t log_dropped;
+
+/* Event types which are not logged, a bit per type */
+static atomic_t log_types_disabled[256 / 32];
 
 /* Size of one FIFO entry */
 #define ENTRY_SIZE(payload_sz) (1+DIV_ROUND_UP((payload_sz), UNIT_SIZE))
 
+/* Copy into / out of the FIFO, starting at a unit and wrapping at the end */
+static void log_copy_in(size_t unit, size_t offset, const void *src,
+			size_t len)
+{
+	uint8_t *fifo = (uint8_t *)log_events;
+	size_t start = (unit & UNIT_COUNT_MASK) * UNIT_SIZE + offset;
+	size_t first = MIN(len, sizeof(log_events) - start);
+
+	memcpy(fifo + start, src, first);
+	memcpy(fifo, (const uint8_t *)src + first, len - first);
+}
+
+static void log_copy_out(void *dest, size_t unit, size_t len)
+{
+	const uint8_t *fifo = (const uint8_t *)log_events;
+	size_t start = (unit & UNIT_COUNT_MASK) * UNIT_SIZE;
+	size_t first = MIN(len, sizeof(log_events) - start);
+
+	memcpy(dest, fifo + start, first);
+	memcpy((uint8_t *)dest + first, fifo, len - first);
+}
+
+int log_event_type_enabled(uint8_t type)
+{
+	return !(log_types_disabled[type / 32] & BIT(type % 32));
+}
+
+void log_enable_event_type(uint8_t type, int enable)
+{
+	if (enable)
+		atomic_clear_bits(&log_types_disabled[type / 32],
+				  BIT(type % 32));
+	else
+		atomic_or(&log_types_disabled[type / 32], BIT(type % 32));
+}
+
 void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 			  void *payload, uint32_t timestamp)
 {
-	struct event_log_entry *r;
+	struct event_log_entry r;
 	size_t payload_size = EVENT_LOG_SIZE(size);
 	size_t total_size = ENTRY_SIZE(payload_size);
-	size_t current_tail, first;
-	uint32_t lock_key;
-
-	/* --- critical section : reserve queue space --- */
-	lock_key = irq_lock();
-	current_tail = log_tail_next;
-	log_tail_next = current_tail + total_size;
-	irq_unlock(lock_key);
-	/* --- end of critical section --- */
-
-	/* Out of space : discard the oldest entry */
-	while ((UNIT_COUNT - (current_tail - log_head)) < total_size) {
-		struct event_log_entry *oldest;
-		/* --- critical section : atomically free-up space --- */
-		lock_key = irq_lock();
-		oldest = log_events + (log_head & UNIT_COUNT_MASK);
-		log_head += ENTRY_SIZE(EVENT_LOG_SIZE(oldest->size));
-		irq_unlock(lock_key);
-		/* --- end of critical section --- */
+	size_t current_tail;
+
+	if (!log_event_type_enabled(type))
+		return;
+
+	/* Reserve room; if there isn't any, give it back and drop the event */
+	if (atomic_sub(&log_free, total_size) < (atomic_val_t)total_size) {
+		atomic_add(&log_free, total_size);
+		atomic_add(&log_dropped, 1);
+		return;
 	}
+	current_tail = atomic_add(&log_tail_next, total_size);
+
+	r.timestamp = timestamp;
+	r.type = type;
+	r.size = size;
+	r.data = data;
+	log_copy_in(current_tail, 0, &r, UNIT_SIZE);
+	log_copy_in(current_tail, UNIT_SIZE, payload, payload_size);
 
-	r = log_events + (current_tail & UNIT_COUNT_MASK);
-
-	r->timestamp = timestamp;
-	r->type = type;
-	r->size = size;
-	r->data = data;
-	/* copy the payload into the FIFO */
-	first = MIN(total_size - 1, (UNIT_COUNT -
-		    (current_tail & UNIT_COUNT_MASK)) - 1);
-	if (first)
-		memcpy(r->payload, payload, first * UNIT_SIZE);
-	if (first < total_size - 1)
-		memcpy(log_events, ((uint8_t *)payload) + first * UNIT_SIZE,
-			(total_size - first) * UNIT_SIZE);
-	/* mark the entry available in the queue if nobody is behind us */
-	if (current_tail == log_tail)
-		log_tail = log_tail_next;
+	/* Publish the entry */
+	current_tail &= UNIT_COUNT_MASK;
+	atomic_or(&log_committed[current_tail / 32], BIT(current_tail % 32));
+}
+
+/*
+ * Remove the entry at the head of the FIFO, if it is complete and its
+ * payload fits in max_payload bytes.
+ *
+ * Returns the payload size, or -1 if there is no such entry.
+ */
+static int log_take_entry(struct event_log_entry *r, size_t max_payload)
+{
+	size_t head = log_head & UNIT_COUNT_MASK;
+	atomic_t *word = &log_committed[head / 32];
+	size_t payload_size;
+
+	/* Claim the entry; nobody else clears the bit */
+	if (!(atomic_clear_bits(word, BIT(head % 32)) & BIT(head % 32)))
+		return -1;
+
+	log_copy_out(r, log_head, UNIT_SIZE);
+	payload_size = EVENT_LOG_SIZE(r->size);
+	if (payload_size > max_payload) {
+		/* Leave it for next time */
+		atomic_or(word, BIT(head % 32));
+		return -1;
+	}
+	log_copy_out(r->payload, log_head + 1, payload_size);
+
+	log_head += ENTRY_SIZE(payload_size);
+	atomic_add(&log_free, ENTRY_SIZE(payload_size));
+
+	return payload_size;
 }
 
 int log_dequeue_event(struct event_log_entry *r)
 {
 	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
-	unsigned int total_size, first;
-	struct event_log_entry *entry;
-	size_t current_head;
-	uint32_t lock_key;
+	int payload_size = log_take_entry(r, EVENT_LOG_SIZE_MASK);
 
-retry:
-	current_head = log_head;
 	/* The log FIFO is empty */
-	if (log_tail == current_head) {
+	if (payload_size < 0) {
 		memset(r, 0, UNIT_SIZE);
 		r->type = EVENT_LOG_NO_ENTRY;
 		return UNIT_SIZE;
 	}
 
-	entry = log_events + (current_head & UNIT_COUNT_MASK);
-	total_size = ENTRY_SIZE(EVENT_LOG_SIZE(entry->size));
-	first = MIN(total_size, UNIT_COUNT - (current_head & UNIT_COUNT_MASK));
-	memcpy(r, entry, first * UNIT_SIZE);
-	if (first < total_size)
-		memcpy(r + first, log_events, (total_size-first) * UNIT_SIZE);
-
-	/* --- critical section : remove the entry from the queue --- */
-	lock_key = irq_lock();
-	if (log_head != current_head) { /* our entry was thrown away */
-		irq_unlock(lock_key);
-		goto retry;
-	}
-	log_head += total_size;
-	irq_unlock(lock_key);
-	/* --- end of critical section --- */
-
 	/* fixup the timestamp : number of milliseconds in the past */
 	r->timestamp = now - r->timestamp;
 
-	return total_size * UNIT_SIZE;
+	return ENTRY_SIZE(payload_size) * UNIT_SIZE;
+}
+
+int log_dequeue_events(void *buf, int size, int *count)
+{
+	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+	uint8_t *out = buf;
+	int used = 0;
+
+	*count = 0;
+	while (size - used >= (int)UNIT_SIZE) {
+		struct event_log_entry *r = (void *)(out + used);
+		/* The payload is padded, so it must fit in whole words */
+		int max_payload = (size - used - UNIT_SIZE) & ~3;
+		int payload_size = log_take_entry(r, max_payload);
+		int padded;
+
+		if (payload_size < 0)
+			break;
+
+		padded = (payload_size + 3) & ~3;
+		memset(r->payload + payload_size, 0, padded - payload_size);
+		r->timestamp = now - r->timestamp;
+		used += UNIT_SIZE + padded;
+		(*count)++;
+	}
+
+	return used;
+}
+
+int log_get_dropped(void)
+{
+	return atomic_clear(&log_dropped);
 }
 
 #ifdef CONFIG_CMD_DLOG
@@ -137,15 +204,29 @@ retry:
 static int command_dlog(int argc, char **argv)
 {
 	size_t log_cur;
-	const uint8_t * const log_events_end =
-		(uint8_t *)&log_events[UNIT_COUNT];
 
 	if (argc > 1) {
 		if (!strcasecmp(argv[1], "clear")) {
-			interrupt_disable();
-			log_head = log_tail = log_tail_next = 0;
-			interrupt_enable();
+			struct {
+				struct event_log_entry r;
+				uint8_t payload[EVENT_LOG_SIZE_MASK];
+			} e;
 
+			/* Drain the FIFO, keeping the log_free accounting */
+			while (log_take_entry(&e.r, EVENT_LOG_SIZE_MASK) >= 0)
+				;
+
+			return EC_SUCCESS;
+		}
+		if (argc == 3 && (!strcasecmp(argv[1], "on") ||
+				  !strcasecmp(argv[1], "off"))) {
+			char *e;
+			int type = strtoi(argv[2], &e, 0);
+
+			if (*e || type < 0 || type > 0xff)
+				return EC_ERROR_PARAM2;
+			log_enable_event_type(type,
+					      !strcasecmp(argv[1], "on"));
 			return EC_SUCCESS;
 		}
 		/* Too many parameters */
@@ -154,33 +235,34 @@ static int command_dlog(int argc, char **argv)
 
 	ccprintf(" TIMESTAMP | TYPE |  DATA | SIZE | PAYLOAD\n");
 	log_cur = log_head;
-	while (log_cur != log_tail) {
-		struct event_log_entry *r;
-		uint8_t *payload;
+	/* Stop at the first entry which isn't complete yet */
+	while (log_committed[(log_cur & UNIT_COUNT_MASK) / 32] &
+	       BIT((log_cur & UNIT_COUNT_MASK) % 32)) {
+		struct {
+			struct event_log_entry r;
+			uint8_t payload[EVENT_LOG_SIZE_MASK];
+		} e;
 		uint32_t payload_bytes;
+		int i;
 
-		r = &log_events[log_cur & UNIT_COUNT_MASK];
-		payload_bytes = EVENT_LOG_SIZE(r->size);
+		log_copy_out(&e.r, log_cur, UNIT_SIZE);
+		payload_bytes = EVENT_LOG_SIZE(e.r.size);
+		log_copy_out(e.r.payload, log_cur + 1, payload_bytes);
 		log_cur += ENTRY_SIZE(payload_bytes);
 
-		ccprintf("%10d   %4d  0x%04X   %4d   ", r->timestamp, r->type,
-			r->data, payload_bytes);
+		ccprintf("%10d   %4d  0x%04X   %4d   ", e.r.timestamp,
+			e.r.type, e.r.data, payload_bytes);
 
 		/* display payload if exists */
-		payload = r->payload;
-		while (payload_bytes--) {
-			if (payload >= log_events_end)
-				payload = (uint8_t *)&log_events[0];
-
-			ccprintf("%02X", *payload);
-			payload++;
-		}
+		for (i = 0; i < payload_bytes; i++)
+			ccprintf("%02X", e.r.payload[i]);
 		ccprintf("\n");
 	}
+	ccprintf("Dropped: %d\n", (int)log_dropped);
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(dlog,
 			command_dlog,
-			"[clear]",
-			"Display/clear TPM event logs");
+			"[clear | on <type> | off <type>]",
+			"Display/clear TPM event logs or mask event types");
 #endif
@@ -7,17 +7,21 @@
 
 #include "common.h"
 #include "console.h"
+#include "crc.h"
 #include "cros_board_info.h"
 #include "flash.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
+#include "lpc.h"
 #include "otp.h"
 #include "rwsig.h"
+#include "sha256.h"
 #include "shared_mem.h"
 #include "system.h"
 #include "util.h"
 #include "vboot_hash.h"
+#include "watchdog.h"
 
 /*
  * Contents of erased flash, as a 32-bit value.  Most platforms erase flash
@@ -1353,6 +1357,198 @@ DECLARE_HOST_COMMAND(EC_CMD_FLASH_READ,
 		     flash_command_read,
 		     EC_VER_MASK(0));
 
+#ifdef CONFIG_HOSTCMD_FLASH_BLOCK_HASH
+#if defined(CONFIG_SW_CRC) || defined(CONFIG_HW_CRC)
+#define BLOCK_HASH_CRC32
+#endif
+
+/* Bytes read per step when hashing flash that is not memory mapped */
+#define BLOCK_HASH_READ_SIZE 256
+SHARED_MEM_CHECK_SIZE(BLOCK_HASH_READ_SIZE);
+
+/*
+ * Most bytes hashed by one command, so the host can't keep the host command
+ * task busy for long.  Large enough for the biggest erase blocks.
+ */
+#define BLOCK_HASH_MAX_BYTES (128 * 1024)
+
+/* Large, so keep it off the host command task stack */
+static struct sha256_ctx block_hash_ctx;
+
+static void block_hash_update(uint8_t type, uint32_t *crc,
+			      const uint8_t *data, int size)
+{
+#ifdef BLOCK_HASH_CRC32
+	if (type == EC_FLASH_BLOCK_HASH_CRC32) {
+		crc32_ctx_hash(crc, data, size);
+		return;
+	}
+#endif
+	SHA256_update(&block_hash_ctx, data, size);
+}
+
+/**
+ * Hash one block of flash.
+ *
+ * @param type		enum ec_flash_block_hash_type
+ * @param offset	Flash offset of the block
+ * @param size		Size of the block in bytes
+ * @param digest	Destination for the digest
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+static int flash_hash_block(uint8_t type, int offset, int size,
+			    uint8_t *digest)
+{
+	uint32_t crc;
+#ifdef CONFIG_MAPPED_STORAGE
+	const char *src;
+
+	if (crec_flash_dataptr(offset, size, 1, &src) < 0)
+		return EC_ERROR_INVAL;
+#else
+	char *buf;
+	int pos;
+	int rv;
+
+	if (!flash_range_ok(offset, size, 1))
+		return EC_ERROR_INVAL;
+#endif
+
+#ifdef BLOCK_HASH_CRC32
+	crc32_ctx_init(&crc);
+#endif
+	SHA256_init(&block_hash_ctx);
+
+#ifdef CONFIG_MAPPED_STORAGE
+	crec_flash_lock_mapped_storage(1);
+	block_hash_update(type, &crc, (const uint8_t *)src, size);
+	crec_flash_lock_mapped_storage(0);
+#else
+	rv = shared_mem_acquire(BLOCK_HASH_READ_SIZE, &buf);
+	if (rv != EC_SUCCESS)
+		return rv;
+
+	for (pos = 0; pos < size; pos += BLOCK_HASH_READ_SIZE) {
+		int n = MIN(BLOCK_HASH_READ_SIZE, size - pos);
+
+		rv = crec_flash_read(offset + pos, n, buf);
+		if (rv != EC_SUCCESS)
+			break;
+		block_hash_update(type, &crc, (const uint8_t *)buf, n);
+	}
+	shared_mem_release(buf);
+	if (rv != EC_SUCCESS)
+		return rv;
+#endif
+
+#ifdef BLOCK_HASH_CRC32
+	if (type == EC_FLASH_BLOCK_HASH_CRC32) {
+		crc = crc32_ctx_result(&crc);
+		memcpy(digest, &crc, sizeof(crc));
+		return EC_SUCCESS;
+	}
+#endif
+	memcpy(digest, SHA256_final(&block_hash_ctx), SHA256_DIGEST_SIZE);
+	return EC_SUCCESS;
+}
+
+static enum ec_status
+flash_command_block_hash(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_flash_block_hash *p = args->params;
+	struct ec_response_flash_block_hash *r = args->response;
+	uint32_t offset = p->offset + EC_FLASH_REGION_START;
+	int digest_size;
+	int max_blocks;
+	int i;
+
+	switch (p->hash_type) {
+	case EC_FLASH_BLOCK_HASH_SHA256:
+		digest_size = SHA256_DIGEST_SIZE;
+		break;
+#ifdef BLOCK_HASH_CRC32
+	case EC_FLASH_BLOCK_HASH_CRC32:
+		digest_size = sizeof(uint32_t);
+		break;
+#endif
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+
+	if (!p->block_size || !p->num_blocks)
+		return EC_RES_INVALID_PARAM;
+
+	if (p->block_size > BLOCK_HASH_MAX_BYTES)
+		return EC_RES_OVERFLOW;
+
+#ifdef CONFIG_VBOOT_HASH
+	/* The hash engine may be busy with the vboot hash */
+	if (vboot_hash_in_progress())
+		return EC_RES_BUSY;
+#endif
+
+	max_blocks = (args->response_max - sizeof(*r)) / digest_size;
+	if (max_blocks < 1)
+		return EC_RES_OVERFLOW;
+	max_blocks = MIN(max_blocks, p->num_blocks);
+	max_blocks = MIN(max_blocks, BLOCK_HASH_MAX_BYTES / p->block_size);
+
+	for (i = 0; i < max_blocks; i++) {
+		watchdog_reload();
+		if (flash_hash_block(p->hash_type,
+				     offset + i * p->block_size,
+				     p->block_size,
+				     r->digest + i * digest_size))
+			return EC_RES_ERROR;
+	}
+
+	r->num_blocks = max_blocks;
+	r->digest_size = digest_size;
+	r->reserved = 0;
+	args->response_size = sizeof(*r) + max_blocks * digest_size;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_FLASH_BLOCK_HASH,
+		     flash_command_block_hash,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_FLASH_BLOCK_HASH */
+
+#ifdef CONFIG_HOSTCMD_FLASH_READ_BULK
+/* Chips without a bulk window leave the command unavailable */
+__overridable uint8_t *lpc_get_bulk_window(int *size)
+{
+	return NULL;
+}
+
+static enum ec_status
+flash_command_read_bulk(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_flash_read_bulk *p = args->params;
+	struct ec_response_flash_read_bulk *r = args->response;
+	uint32_t offset = p->offset + EC_FLASH_REGION_START;
+	uint8_t *window;
+	int window_size;
+	int size;
+
+	window = lpc_get_bulk_window(&window_size);
+	if (!window)
+		return EC_RES_UNAVAILABLE;
+
+	size = MIN(p->size, window_size);
+	if (crec_flash_read(offset, size, (char *)window))
+		return EC_RES_ERROR;
+
+	r->size = size;
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_FLASH_READ_BULK,
+		     flash_command_read_bulk,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_FLASH_READ_BULK */
+
 /**
  * Flash write command
  *
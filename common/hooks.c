@@ -20,8 +20,6 @@
 #define CPRINTS(format, args...)
 #endif
 
-#define DEFERRED_FUNCS_COUNT (__deferred_funcs_end - __deferred_funcs)
-
 struct hook_ptrs {
 	const struct hook_data *start;
 	const struct hook_data *end;
@@ -102,38 +100,78 @@ static void record_hook_delay(uint64_t now, uint64_t last, uint64_t interval,
 }
 #endif
 
+/*
+ * Sort each hook type into priority order, once.  __hooks_order[] holds, for
+ * the hook at each position in the hook sections, the index within its type
+ * of the hook to call at that position.  The sort is stable, so hooks with
+ * equal priority run in link order.
+ */
+static int hooks_sorted;
+
+static void hook_sort(void)
+{
+	const struct hook_data *start;
+	uint16_t *order;
+	int type, count, i, j;
+	uint16_t idx;
+
+	for (type = 0; type < ARRAY_SIZE(hook_list); type++) {
+		start = hook_list[type].start;
+		count = hook_list[type].end - start;
+		order = __hooks_order + (start - __hooks_init);
+
+		/* Insertion sort; this only runs once */
+		for (i = 0; i < count; i++) {
+			idx = i;
+			for (j = i; j > 0 &&
+			     start[order[j - 1]].priority > start[idx].priority;
+			     j--)
+				order[j] = order[j - 1];
+			order[j] = idx;
+		}
+	}
+
+	hooks_sorted = 1;
+}
+
 void hook_notify(enum hook_type type)
 {
-	const struct hook_data *start, *end, *p;
-	int count, called = 0;
-	int last_prio = HOOK_PRIO_FIRST - 1, prio;
+	const struct hook_data *start, *p;
+	const uint16_t *order;
+	int count, i;
 #ifdef CONFIG_HOOK_DEBUG
 	uint64_t start_time = get_time().val;
-	uint64_t run_time;
+	uint64_t run_time, hook_start;
+	struct hook_stats *stats;
 #endif
 
 	CPRINTS("hook notify %d", type);
 
+	/*
+	 * The first notification comes from main() or from the hook task's
+	 * HOOK_INIT, before other tasks are enabled, so sorting can't race.
+	 */
+	if (!hooks_sorted)
+		hook_sort();
+
 	start = hook_list[type].start;
-	end = hook_list[type].end;
-	count = end - start;
+	count = hook_list[type].end - start;
+	order = __hooks_order + (start - __hooks_init);
 
 	/* Call all the hooks in priority order */
-	while (called < count) {
-		/* Find the lowest remaining priority */
-		for (p = start, prio = HOOK_PRIO_LAST + 1; p < end; p++) {
-			if (p->priority < prio && p->priority > last_prio)
-				prio = p->priority;
-		}
-		last_prio = prio;
-
-		/* Call all the hooks with that priority */
-		for (p = start; p < end; p++) {
-			if (p->priority == prio) {
-				called++;
-				p->routine();
-			}
-		}
+	for (i = 0; i < count; i++) {
+		p = start + order[i];
+#ifdef CONFIG_HOOK_DEBUG
+		hook_start = get_time().val;
+#endif
+		p->routine();
+#ifdef CONFIG_HOOK_DEBUG
+		run_time = get_time().val - hook_start;
+		stats = __hook_stats + (p - __hooks_init);
+		if (run_time > stats->max_run_time)
+			stats->max_run_time = run_time;
+		stats->avg_run_time = (stats->avg_run_time * 7 + run_time) >> 3;
+#endif
 	}
 
 #ifdef CONFIG_HOOK_DEBUG
@@ -144,24 +182,160 @@ void hook_notify(enum hook_type type)
 #endif
 }
 
+/*
+ * Deferred routines which are armed are kept in a binary min-heap keyed on
+ * their firing time in __deferred_until[].  __deferred_heap[] holds deferred
+ * function indices in heap order and __deferred_heap_pos[] maps each index
+ * back to its heap position, so arming, re-arming and cancelling are all
+ * O(log n).  A routine is in the heap if and only if its firing time is
+ * non-zero.  The heap is only touched with interrupts locked, since
+ * hook_call_deferred() may be called from interrupt context.
+ */
+static int deferred_heap_count;
+
+/* Time the hook task will next wake on its own, or 0 if it is running */
+static uint64_t hook_wake_time;
+
+#ifdef CONFIG_CMD_DEFERRED
+/* Longest and average time a deferred routine ran after its firing time */
+static uint32_t max_deferred_lateness;
+static uint32_t avg_deferred_lateness;
+#endif
+
+static inline void deferred_heap_set(int pos, uint16_t i)
+{
+	__deferred_heap[pos] = i;
+	__deferred_heap_pos[i] = pos;
+}
+
+static void deferred_heap_sift_up(int pos)
+{
+	uint16_t i = __deferred_heap[pos];
+	int parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (__deferred_until[__deferred_heap[parent]] <=
+		    __deferred_until[i])
+			break;
+		deferred_heap_set(pos, __deferred_heap[parent]);
+		pos = parent;
+	}
+	deferred_heap_set(pos, i);
+}
+
+static void deferred_heap_sift_down(int pos)
+{
+	uint16_t i = __deferred_heap[pos];
+	int child;
+
+	while ((child = 2 * pos + 1) < deferred_heap_count) {
+		if (child + 1 < deferred_heap_count &&
+		    __deferred_until[__deferred_heap[child + 1]] <
+		    __deferred_until[__deferred_heap[child]])
+			child++;
+		if (__deferred_until[i] <=
+		    __deferred_until[__deferred_heap[child]])
+			break;
+		deferred_heap_set(pos, __deferred_heap[child]);
+		pos = child;
+	}
+	deferred_heap_set(pos, i);
+}
+
+/* Remove deferred routine i from the heap.  Must be in the heap. */
+static void deferred_heap_remove(int i)
+{
+	int pos = __deferred_heap_pos[i];
+	uint16_t last;
+
+	__deferred_until[i] = 0;
+	if (--deferred_heap_count == pos)
+		return;
+
+	/* Move the last entry into the hole and restore heap order */
+	last = __deferred_heap[deferred_heap_count];
+	deferred_heap_set(pos, last);
+	deferred_heap_sift_up(pos);
+	deferred_heap_sift_down(__deferred_heap_pos[last]);
+}
+
+/* Set (or change) the firing time of deferred routine i */
+static void deferred_heap_arm(int i, uint64_t until)
+{
+	int pos;
+
+	if (__deferred_until[i]) {
+		pos = __deferred_heap_pos[i];
+		__deferred_until[i] = until;
+		deferred_heap_sift_up(pos);
+		deferred_heap_sift_down(__deferred_heap_pos[i]);
+	} else {
+		__deferred_until[i] = until;
+		deferred_heap_set(deferred_heap_count, i);
+		deferred_heap_sift_up(deferred_heap_count++);
+	}
+}
+
+/**
+ * Take the earliest deferred routine due before time t off the heap.
+ *
+ * @return Deferred function index, or -1 if nothing is due.
+ */
+static int deferred_heap_pop_due(uint64_t t)
+{
+	uint32_t key = irq_lock();
+	int i = -1;
+
+	if (deferred_heap_count && __deferred_until[__deferred_heap[0]] < t) {
+		i = __deferred_heap[0];
+#ifdef CONFIG_CMD_DEFERRED
+		{
+			uint32_t late = t - __deferred_until[i];
+
+			if (late > max_deferred_lateness)
+				max_deferred_lateness = late;
+			avg_deferred_lateness =
+				(avg_deferred_lateness * 7 + late) >> 3;
+		}
+#endif
+		deferred_heap_remove(i);
+	}
+
+	irq_unlock(key);
+	return i;
+}
+
 int hook_call_deferred(const struct deferred_data *data, int us)
 {
 	int i = data - __deferred_funcs;
+	uint64_t until;
+	uint32_t key;
+	int wake = 0;
 
 	if (data < __deferred_funcs || data >= __deferred_funcs_end)
 		return EC_ERROR_INVAL;  /* Routine not registered */
 
+	key = irq_lock();
 	if (us == -1) {
 		/* Cancel */
-		__deferred_until[i] = 0;
+		if (__deferred_until[i])
+			deferred_heap_remove(i);
 	} else {
 		/* Set alarm */
-		__deferred_until[i] = get_time().val + us;
+		until = get_time().val + us;
+		deferred_heap_arm(i, until);
 
-		/* Wake task so it can re-sleep for the proper time */
-		if (hook_task_started)
-			task_wake(TASK_ID_HOOKS);
+		/*
+		 * Only wake the task if it is asleep and would otherwise
+		 * sleep past the new firing time.
+		 */
+		wake = hook_wake_time && until < hook_wake_time;
 	}
+	irq_unlock(key);
+
+	if (wake && hook_task_started)
+		task_wake(TASK_ID_HOOKS);
 
 	return EC_SUCCESS;
 }
@@ -182,27 +356,22 @@ void hook_task(void *u)
 
 	while (1) {
 		uint64_t t = get_time().val;
+		uint64_t until;
+		uint32_t key;
 		int next = 0;
 		int i;
 
-		interrupt_disable();
 		/* Handle deferred routines */
-		for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
-			if (__deferred_until[i] && __deferred_until[i] < t) {
-				/*
-				 * Call deferred function.  Clear timer first,
-				 * so it can request itself be called later.
-				 */
-				__deferred_until[i] = 0;
-				interrupt_enable();
-				CPRINTS("hook call deferred 0x%pP",
-					__deferred_funcs[i].routine);
-				__deferred_funcs[i].routine();
-				interrupt_disable();
-			}
+		while ((i = deferred_heap_pop_due(t)) >= 0) {
+			/*
+			 * Call deferred function.  Its timer is already
+			 * cleared, so it can request itself be called later.
+			 */
+			CPRINTS("hook call deferred 0x%pP",
+				__deferred_funcs[i].routine);
+			__deferred_funcs[i].routine();
 		}
 
-		interrupt_enable();
 		if (t - last_tick >= HOOK_TICK_INTERVAL) {
 #ifdef CONFIG_HOOK_DEBUG
 			record_hook_delay(t, last_tick, HOOK_TICK_INTERVAL,
@@ -228,25 +397,29 @@ void hook_task(void *u)
 		if (last_tick + HOOK_TICK_INTERVAL > t)
 			next = last_tick + HOOK_TICK_INTERVAL - t;
 
-		interrupt_disable();
-		for (i = 0; i < DEFERRED_FUNCS_COUNT && next > 0; i++) {
-			if (!__deferred_until[i])
-				continue;
-
-			if (__deferred_until[i] < t)
+		/* The earliest deferred routine is at the top of the heap */
+		key = irq_lock();
+		if (deferred_heap_count && next > 0) {
+			until = __deferred_until[__deferred_heap[0]];
+			if (until < t)
 				next = 0;
-			else if (__deferred_until[i] - t < next)
-				next = __deferred_until[i] - t;
+			else if (until - t < next)
+				next = until - t;
 		}
-
-		interrupt_enable();
+		hook_wake_time = next > 0 ? t + next : 0;
+		irq_unlock(key);
 
 		/*
 		 * If nothing is immediately pending, sleep until the next
 		 * event.
 		 */
-		if (next > 0)
+		if (next > 0) {
 			task_wait_event(next);
+
+			key = irq_lock();
+			hook_wake_time = 0;
+			irq_unlock(key);
+		}
 	}
 }
 
@@ -266,6 +439,8 @@ static void print_hook_delay(uint32_t interval, uint32_t delay, uint32_t avg)
 
 static int command_stats(int argc, char **argv)
 {
+	const struct hook_data *p;
+	struct hook_stats *stats;
 	int i;
 
 	ccprintf("HOOK_TICK:\n");
@@ -276,14 +451,64 @@ static int command_stats(int argc, char **argv)
 	print_hook_delay(SECOND, max_hook_second_delay, avg_hook_second_delay);
 
 	ccprintf("Max run time for each hook:\n");
-	for (i = 0; i < ARRAY_SIZE(hook_list); ++i)
+	for (i = 0; i < ARRAY_SIZE(hook_list); ++i) {
 		ccprintf("%3d:%6d us (Avg: %5d us)\n", i,
 			 (uint32_t)max_hook_run_time[i],
 			 (uint32_t)avg_hook_run_time[i]);
 
+		if (argc < 2 || strcasecmp(argv[1], "all"))
+			continue;
+
+		for (p = hook_list[i].start; p < hook_list[i].end; p++) {
+			stats = __hook_stats + (p - __hooks_init);
+			ccprintf("    %4d %pP:%6d us (Avg: %5d us)\n",
+				 p->priority, p->routine, stats->max_run_time,
+				 stats->avg_run_time);
+		}
+		cflush();
+	}
+
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(hookstats, command_stats,
-			NULL,
-			"Print stats of hooks");
+			"[all]",
+			"Print stats of hooks; 'all' includes each routine");
+#endif
+
+#ifdef CONFIG_CMD_DEFERRED
+static int command_deferred(int argc, char **argv)
+{
+	uint64_t now = get_time().val;
+	uint64_t until;
+	uint32_t key;
+	int i;
+
+	for (i = 0; i < __deferred_funcs_end - __deferred_funcs; i++) {
+		key = irq_lock();
+		until = __deferred_until[i];
+		irq_unlock(key);
+
+		if (!until)
+			continue;
+
+		if (until < now)
+			ccprintf("  %pP: late by %d us\n",
+				 __deferred_funcs[i].routine,
+				 (uint32_t)(now - until));
+		else
+			ccprintf("  %pP: due in %d us\n",
+				 __deferred_funcs[i].routine,
+				 (uint32_t)(until - now));
+		cflush();
+	}
+
+	ccprintf("%d queued; lateness max %d us, avg %d us\n",
+		 deferred_heap_count, max_deferred_lateness,
+		 avg_deferred_lateness);
+
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(deferred, command_deferred,
+			     NULL,
+			     "Print queued deferred routines and lateness");
 #endif
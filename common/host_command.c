@@ -363,12 +363,12 @@ host_packet_bad:
 }
 
 /**
- * Find a command by command number.
+ * Search the host command section for a command number.
  *
  * @param command	Command number to find
  * @return The command structure, or NULL if no match found.
  */
-static const struct host_command *find_host_command(int command)
+static const struct host_command *search_host_command(int command)
 {
 	if (IS_ENABLED(CONFIG_ZEPHYR)) {
 		return zephyr_find_host_command(command);
@@ -406,8 +406,153 @@ static const struct host_command *find_host_command(int command)
 	}
 }
 
+#ifdef CONFIG_HOSTCMD_DISPATCH_TABLE
+/*
+ * Direct-index dispatch table.
+ *
+ * Command numbers below EC_CMD_BOARD_SPECIFIC_LAST are split into pages of
+ * 256 commands.  Each page which has at least one handler owns a dense run of
+ * slots in hcmd_slots[], covering its lowest through its highest command, so
+ * the standard (0x00xx/0x01xx) and OEM (0x3Exx) spaces each cost only as many
+ * slots as they span.  A slot holds the index of the handler in __hcmds plus
+ * one, or 0 if the command is not implemented.
+ */
+#define HCMD_PAGE_SHIFT		8
+#define HCMD_PAGE_MASK		(BIT(HCMD_PAGE_SHIFT) - 1)
+#define HCMD_PAGE_COUNT		((EC_CMD_BOARD_SPECIFIC_LAST >> \
+				  HCMD_PAGE_SHIFT) + 1)
+
+/* Page has no handlers */
+#define HCMD_PAGE_EMPTY		0xffff
+/* Page did not fit in hcmd_slots[]; search the section instead */
+#define HCMD_PAGE_SEARCH	0xfffe
+
+struct hcmd_page {
+	uint16_t slot;	/* First slot in hcmd_slots[], or HCMD_PAGE_* */
+	uint8_t base;	/* Lowest command in the page (low byte) */
+	uint8_t last;	/* Highest command in the page (low byte) */
+};
+
+static struct hcmd_page hcmd_pages[HCMD_PAGE_COUNT];
+static uint8_t hcmd_slots[CONFIG_HOSTCMD_DISPATCH_TABLE_SIZE];
+static int hcmd_table_ready;
+
+static void hcmd_table_build(void)
+{
+	const struct host_command *cmd;
+	struct hcmd_page *page;
+	int used = 0;
+	int i, n;
+
+	/* Slots are one byte wide */
+	if (__hcmds_end - __hcmds >= UINT8_MAX) {
+		CPRINTS("HC dispatch table disabled: %d commands",
+			(int)(__hcmds_end - __hcmds));
+		return;
+	}
+
+	for (i = 0; i < HCMD_PAGE_COUNT; i++)
+		hcmd_pages[i].slot = HCMD_PAGE_EMPTY;
+
+	/* Find the range of commands used in each page */
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		if (cmd->command < 0 ||
+		    cmd->command > EC_CMD_BOARD_SPECIFIC_LAST)
+			continue;
+
+		page = &hcmd_pages[cmd->command >> HCMD_PAGE_SHIFT];
+		n = cmd->command & HCMD_PAGE_MASK;
+
+		if (page->slot == HCMD_PAGE_EMPTY) {
+			page->slot = 0;
+			page->base = n;
+			page->last = n;
+		} else {
+			page->base = MIN(page->base, n);
+			page->last = MAX(page->last, n);
+		}
+	}
+
+	/* Hand out slot ranges, falling back to a search if we run out */
+	for (i = 0; i < HCMD_PAGE_COUNT; i++) {
+		page = &hcmd_pages[i];
+		if (page->slot == HCMD_PAGE_EMPTY)
+			continue;
+
+		n = page->last - page->base + 1;
+		if (used + n > (int)ARRAY_SIZE(hcmd_slots)) {
+			CPRINTS("HC dispatch page 0x%02x00 needs %d slots", i,
+				n);
+			page->slot = HCMD_PAGE_SEARCH;
+			continue;
+		}
+
+		page->slot = used;
+		used += n;
+	}
+
+	memset(hcmd_slots, 0, sizeof(hcmd_slots));
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		if (cmd->command < 0 ||
+		    cmd->command > EC_CMD_BOARD_SPECIFIC_LAST)
+			continue;
+
+		page = &hcmd_pages[cmd->command >> HCMD_PAGE_SHIFT];
+		if (page->slot == HCMD_PAGE_SEARCH)
+			continue;
+
+		n = page->slot + (cmd->command & HCMD_PAGE_MASK) - page->base;
+		/* Keep the first handler, as the section search would */
+		if (!hcmd_slots[n])
+			hcmd_slots[n] = cmd - __hcmds + 1;
+	}
+
+	hcmd_table_ready = 1;
+}
+#endif /* CONFIG_HOSTCMD_DISPATCH_TABLE */
+
+/**
+ * Find a command by command number.
+ *
+ * @param command	Command number to find
+ * @return The command structure, or NULL if no match found.
+ */
+static const struct host_command *find_host_command(int command)
+{
+#ifdef CONFIG_HOSTCMD_DISPATCH_TABLE
+	/*
+	 * Until the table is built (commands may arrive before HOOK_INIT),
+	 * or for commands outside the table, fall through to the search.
+	 */
+	if (hcmd_table_ready && command >= 0 &&
+	    command <= EC_CMD_BOARD_SPECIFIC_LAST) {
+		const struct hcmd_page *page =
+			&hcmd_pages[command >> HCMD_PAGE_SHIFT];
+		int n = command & HCMD_PAGE_MASK;
+		uint8_t slot;
+
+		if (page->slot == HCMD_PAGE_EMPTY)
+			return NULL;
+
+		if (page->slot != HCMD_PAGE_SEARCH) {
+			if (n < page->base || n > page->last)
+				return NULL;
+
+			slot = hcmd_slots[page->slot + n - page->base];
+			return slot ? &__hcmds[slot - 1] : NULL;
+		}
+	}
+#endif
+
+	return search_host_command(command);
+}
+
 static void host_command_init(void)
 {
+#ifdef CONFIG_HOSTCMD_DISPATCH_TABLE
+	hcmd_table_build();
+#endif
+
 	/* Initialize memory map ID area */
 	host_get_memmap(EC_MEMMAP_ID)[0] = 'E';
 	host_get_memmap(EC_MEMMAP_ID)[1] = 'C';
@@ -572,6 +717,75 @@ DECLARE_HOST_COMMAND(EC_CMD_GET_CMD_VERSIONS,
 		     host_command_get_cmd_versions,
 		     EC_VER_MASK(0) | EC_VER_MASK(1));
 
+#ifdef CONFIG_HOSTCMD_BATCH
+static void host_command_batch_respond(struct host_cmd_handler_args *args)
+{
+	/* Sub-command responses go out with the batch response */
+}
+
+static enum ec_status
+host_command_batch(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_batch *p = args->params;
+	struct ec_response_batch *r = args->response;
+	const uint8_t *in = (const uint8_t *)(p + 1);
+	const uint8_t *in_end = (const uint8_t *)args->params +
+		args->params_size;
+	uint8_t *out = (uint8_t *)(r + 1);
+	uint8_t *out_end = (uint8_t *)args->response + args->response_max;
+	struct host_cmd_handler_args sub;
+	int i;
+
+	if (args->params_size < sizeof(*p) || args->response_max < sizeof(*r))
+		return EC_RES_INVALID_PARAM;
+
+	for (i = 0; i < p->num_commands; i++) {
+		const struct ec_batch_request *req =
+			(const struct ec_batch_request *)in;
+		struct ec_batch_response *res = (struct ec_batch_response *)out;
+
+		if (in + sizeof(*req) > in_end ||
+		    in + EC_BATCH_RECORD_SIZE(req->params_size) > in_end)
+			return EC_RES_REQUEST_TRUNCATED;
+
+		/* Stop once there is no room left to report a result */
+		if (out + sizeof(*res) > out_end)
+			break;
+
+		sub.send_response = host_command_batch_respond;
+		sub.command = req->command;
+		sub.version = req->command_version;
+		sub.params = req + 1;
+		sub.params_size = req->params_size;
+		sub.response = res + 1;
+		/* Keep room for padding the response to a whole record */
+		sub.response_max = (out_end - (uint8_t *)(res + 1)) & ~3;
+		sub.response_size = 0;
+		sub.result = EC_RES_SUCCESS;
+
+		/* Batches can't be nested */
+		if (sub.command == EC_CMD_BATCH)
+			res->result = EC_RES_INVALID_COMMAND;
+		else
+			res->result = host_command_process(&sub);
+
+		res->response_size = res->result == EC_RES_SUCCESS ?
+			sub.response_size : 0;
+
+		in += EC_BATCH_RECORD_SIZE(req->params_size);
+		out += EC_BATCH_RECORD_SIZE(res->response_size);
+	}
+
+	r->num_commands = i;
+	args->response_size = out - (uint8_t *)args->response;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_BATCH,
+		     host_command_batch,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_BATCH */
+
 static int host_command_is_suppressed(uint16_t cmd)
 {
 #ifdef CONFIG_SUPPRESSED_HOST_COMMANDS
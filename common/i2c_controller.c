@@ -12,6 +12,7 @@
 #include "crc8.h"
 #include "host_command.h"
 #include "gpio.h"
+#include "hooks.h"
 #include "i2c.h"
 #include "i2c_bitbang.h"
 #include "i2c_private.h"
@@ -219,6 +220,31 @@ static int i2c_xfer_no_retry(const int port,
 }
 #endif /* CONFIG_I2C_XFER_LARGE_TRANSFER */
 
+#ifdef CONFIG_I2C_XFER_TASK_COUNT
+/* I2C transactions started by each task */
+static uint32_t task_xfer_count[TASK_ID_COUNT];
+
+uint32_t i2c_task_xfer_count(void)
+{
+	task_id_t id = task_get_current();
+
+	return id < TASK_ID_COUNT ? task_xfer_count[id] : 0;
+}
+
+static void count_task_xfer(int flags)
+{
+	task_id_t id = task_get_current();
+
+	/* Continuations of a transaction don't send a new start */
+	if ((flags & I2C_XFER_START) && id < TASK_ID_COUNT)
+		task_xfer_count[id]++;
+}
+#else
+static inline void count_task_xfer(int flags)
+{
+}
+#endif /* CONFIG_I2C_XFER_TASK_COUNT */
+
 int i2c_xfer_unlocked(const int port,
 		      const uint16_t addr_flags,
 		      const uint8_t *out, int out_size,
@@ -233,6 +259,8 @@ int i2c_xfer_unlocked(const int port,
 		return EC_ERROR_INVAL;
 	}
 
+	count_task_xfer(flags);
+
 	for (i = 0; i <= CONFIG_I2C_NACK_RETRY_COUNT; i++) {
 #ifdef CONFIG_ZEPHYR
 		struct i2c_msg msg[2];
@@ -324,6 +352,113 @@ int i2c_xfer(const int port,
 	return rv;
 }
 
+/* Whether two ports are guarded by the same lock in port_mutex */
+static int i2c_same_lock(int port_a, int port_b)
+{
+#ifdef CONFIG_I2C_MULTI_PORT_CONTROLLER
+	port_a = i2c_port_to_controller(port_a);
+	port_b = i2c_port_to_controller(port_b);
+#endif
+	return port_a == port_b;
+}
+
+int i2c_xfer_batch(struct i2c_op *ops, int count)
+{
+	int locked_port = -1;
+	int errors = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		struct i2c_op *op = ops + i;
+
+		if (locked_port >= 0 && !i2c_same_lock(locked_port, op->port)) {
+			i2c_lock(locked_port, 0);
+			locked_port = -1;
+		}
+		if (locked_port < 0) {
+			i2c_lock(op->port, 1);
+			locked_port = op->port;
+		}
+
+		op->rv = i2c_xfer_unlocked(op->port, op->addr_flags,
+					   op->out, op->out_size,
+					   op->in, op->in_size,
+					   I2C_XFER_SINGLE);
+		if (op->rv)
+			errors++;
+	}
+
+	if (locked_port >= 0)
+		i2c_lock(locked_port, 0);
+
+	return errors;
+}
+
+#ifdef CONFIG_I2C_XFER_QUEUE
+/*
+ * Batches waiting for the hook task.  Guarded by irq_lock() so that batches
+ * can be submitted from interrupts.
+ */
+static struct i2c_batch *queue_head;
+static struct i2c_batch *queue_tail;
+
+static struct i2c_batch *i2c_queue_pop(void)
+{
+	uint32_t irq_lock_key = irq_lock();
+	struct i2c_batch *batch = queue_head;
+
+	if (batch) {
+		queue_head = batch->next;
+		if (!queue_head)
+			queue_tail = NULL;
+		/* Let the done callback submit it again */
+		batch->queued = 0;
+	}
+
+	irq_unlock(irq_lock_key);
+	return batch;
+}
+
+static void i2c_queue_run(void)
+{
+	struct i2c_batch *batch;
+
+	while ((batch = i2c_queue_pop()) != NULL) {
+		batch->errors = i2c_xfer_batch(batch->ops, batch->count);
+		if (batch->done)
+			batch->done(batch);
+		if (batch->task != TASK_ID_INVALID)
+			task_set_event(batch->task, batch->event);
+	}
+}
+DECLARE_DEFERRED(i2c_queue_run);
+
+int i2c_submit(struct i2c_batch *batch)
+{
+	uint32_t irq_lock_key;
+
+	if (batch->count <= 0)
+		return EC_ERROR_INVAL;
+
+	irq_lock_key = irq_lock();
+	if (batch->queued) {
+		irq_unlock(irq_lock_key);
+		return EC_ERROR_BUSY;
+	}
+	batch->queued = 1;
+	batch->next = NULL;
+	if (queue_tail)
+		queue_tail->next = batch;
+	else
+		queue_head = batch;
+	queue_tail = batch;
+	irq_unlock(irq_lock_key);
+
+	hook_call_deferred(&i2c_queue_run_data, 0);
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_I2C_XFER_QUEUE */
+
 void i2c_lock(int port, int lock)
 {
 #ifdef CONFIG_I2C_MULTI_PORT_CONTROLLER
@@ -5,9 +5,14 @@
 
 #include "common.h"
 #include "console.h"
+#include "ec_commands.h"
+#include "host_command.h"
 #include "i2c.h"
+#include "queue.h"
 #include "stddef.h"
 #include "stdbool.h"
+#include "task.h"
+#include "timer.h"
 #include "util.h"
 
 #define CPUTS(outstr) cputs(CC_I2C, outstr)
@@ -23,6 +28,53 @@ struct i2c_trace_range {
 
 static struct i2c_trace_range trace_entries[8];
 
+#ifdef CONFIG_I2C_TRACE_BINARY
+/* Bytes recorded in each direction; the rest of a transfer is cut off */
+#define TRACE_MAX_DATA 32
+
+static struct queue const trace_ring =
+	QUEUE_NULL(CONFIG_I2C_TRACE_BUFFER_SIZE, uint8_t);
+
+/* Records which didn't fit in the ring */
+static uint16_t trace_dropped;
+
+/* Record transfers in the ring rather than printing them */
+static bool trace_binary = true;
+
+/*
+ * Copy a transfer into the ring.  Several ports may be transferring at once,
+ * so records are added under irq_lock(); there is no formatting here, only
+ * a few short copies.
+ */
+static void trace_record(int port, uint16_t addr_flags,
+			 const uint8_t *out_data, size_t out_size,
+			 const uint8_t *in_data, size_t in_size)
+{
+	struct ec_i2c_trace_record r;
+	uint32_t lock_key;
+
+	r.timestamp = get_time().le.lo;
+	r.addr_flags = addr_flags;
+	r.port = port;
+	r.flags = 0;
+	if (out_size > TRACE_MAX_DATA || in_size > TRACE_MAX_DATA)
+		r.flags |= EC_I2C_TRACE_TRUNCATED;
+	r.out_size = MIN(out_size, TRACE_MAX_DATA);
+	r.in_size = MIN(in_size, TRACE_MAX_DATA);
+
+	lock_key = irq_lock();
+	if (queue_space(&trace_ring) < sizeof(r) + r.out_size + r.in_size) {
+		if (trace_dropped < UINT16_MAX)
+			trace_dropped++;
+	} else {
+		queue_add_units(&trace_ring, &r, sizeof(r));
+		queue_add_units(&trace_ring, out_data, r.out_size);
+		queue_add_units(&trace_ring, in_data, r.in_size);
+	}
+	irq_unlock(lock_key);
+}
+#endif /* CONFIG_I2C_TRACE_BINARY */
+
 void i2c_trace_notify(int port, uint16_t addr_flags,
 		      const uint8_t *out_data, size_t out_size,
 		      const uint8_t *in_data, size_t in_size)
@@ -39,6 +91,13 @@ void i2c_trace_notify(int port, uint16_t addr_flags,
 	return;
 
 trace_enabled:
+#ifdef CONFIG_I2C_TRACE_BINARY
+	if (trace_binary) {
+		trace_record(port, addr_flags, out_data, out_size,
+			     in_data, in_size);
+		return;
+	}
+#endif
 	CPRINTF("i2c: %d:0x%X ", port, addr);
 	if (out_size) {
 		CPRINTF("wr ");
@@ -81,6 +140,12 @@ static int command_i2ctrace_list(void)
 		}
 	}
 
+#ifdef CONFIG_I2C_TRACE_BINARY
+	ccprintf("mode: %s, %zd bytes queued, %d dropped\n",
+		 trace_binary ? "binary" : "text",
+		 queue_count(&trace_ring), trace_dropped);
+#endif
+
 	return EC_SUCCESS;
 }
 
@@ -180,6 +245,18 @@ static int command_i2ctrace(int argc, char **argv)
 	if (argc < 3)
 		return EC_ERROR_PARAM_COUNT;
 
+#ifdef CONFIG_I2C_TRACE_BINARY
+	if (!strcasecmp(argv[1], "mode") && argc == 3) {
+		if (!strcasecmp(argv[2], "binary"))
+			trace_binary = true;
+		else if (!strcasecmp(argv[2], "text"))
+			trace_binary = false;
+		else
+			return EC_ERROR_PARAM2;
+		return EC_SUCCESS;
+	}
+#endif
+
 	id_or_port = strtoi(argv[2], &end, 0);
 	if (*end || id_or_port < 0)
 		return EC_ERROR_PARAM2;
@@ -211,5 +288,63 @@ static int command_i2ctrace(int argc, char **argv)
 DECLARE_CONSOLE_COMMAND(i2ctrace,
 			command_i2ctrace,
 			"[list | disable <id> | enable <port> <address> | "
-			"enable <port> <address-low> <address-high>]",
+			"enable <port> <address-low> <address-high>"
+#ifdef CONFIG_I2C_TRACE_BINARY
+			" | mode <text|binary>"
+#endif
+			"]",
 			"Trace I2C transactions");
+
+#ifdef CONFIG_I2C_TRACE_BINARY
+static void i2c_trace_read(struct ec_response_i2c_trace *r, size_t max_size)
+{
+	struct ec_i2c_trace_record rec;
+	size_t used = 0;
+	size_t len;
+	uint32_t lock_key;
+
+	/* Only whole records; this is the only reader of the ring */
+	while (queue_peek_units(&trace_ring, &rec, 0, sizeof(rec)) ==
+	       sizeof(rec)) {
+		len = sizeof(rec) + rec.out_size + rec.in_size;
+		if (used + len > max_size)
+			break;
+		queue_remove_units(&trace_ring, r->records + used, len);
+		used += len;
+	}
+
+	lock_key = irq_lock();
+	r->dropped = trace_dropped;
+	trace_dropped = 0;
+	irq_unlock(lock_key);
+	r->size = used;
+}
+
+static enum ec_status
+i2c_trace_host_command(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_i2c_trace *p = args->params;
+	struct ec_response_i2c_trace *r = args->response;
+	size_t i;
+
+	switch (p->subcmd) {
+	case EC_I2C_TRACE_READ:
+		i2c_trace_read(r, args->response_max - sizeof(*r));
+		args->response_size = sizeof(*r) + r->size;
+		return EC_RES_SUCCESS;
+	case EC_I2C_TRACE_ENABLE:
+		if (command_i2ctrace_enable(p->port, p->addr_lo, p->addr_hi))
+			return EC_RES_INVALID_PARAM;
+		trace_binary = true;
+		return EC_RES_SUCCESS;
+	case EC_I2C_TRACE_DISABLE:
+		for (i = 0; i < ARRAY_SIZE(trace_entries); i++)
+			trace_entries[i].enabled = 0;
+		return EC_RES_SUCCESS;
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+}
+DECLARE_HOST_COMMAND(EC_CMD_I2C_TRACE, i2c_trace_host_command,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_I2C_TRACE_BINARY */
@@ -15,6 +15,7 @@
 #include "i8042_protocol.h"
 #include "keyboard_8042_sharedlib.h"
 #include "keyboard_config.h"
+#include "keyboard_latency.h"
 #include "keyboard_protocol.h"
 #include "lightbar.h"
 #include "lpc.h"
@@ -89,6 +90,12 @@ enum {
 struct data_byte {
 	uint8_t chan;
 	uint8_t byte;
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	/* Byte belongs to a scanned key event; times are get_time().le.lo */
+	uint8_t timed;
+	uint32_t scan_start;
+	uint32_t queued;
+#endif
 };
 
 static struct queue const to_host = QUEUE_NULL(16, struct data_byte);
@@ -265,13 +272,21 @@ static void aux_enable_irq(int enable)
  * @param len		Number of bytes to send to the host
  * @param to_host	Data to send
  * @param chan		Channel to send data on
+ * @param scan_start	Start of the scan which saw the key, for latency
+ *			statistics; NULL if the bytes aren't a scanned key.
  */
-static void i8042_send_to_host(int len, const uint8_t *bytes,
-			       uint8_t chan)
+static void i8042_queue_to_host(int len, const uint8_t *bytes,
+				uint8_t chan, const uint32_t *scan_start)
 {
 	int i;
 	struct data_byte data;
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+	data.timed = !!scan_start;
+	data.scan_start = scan_start ? *scan_start : 0;
+	data.queued = get_time().le.lo;
+#endif
+
 	/* Enqueue output data if there's space */
 	mutex_lock(&to_host_mutex);
 
@@ -292,6 +307,12 @@ static void i8042_send_to_host(int len, const uint8_t *bytes,
 	task_wake(TASK_ID_KEYPROTO);
 }
 
+static void i8042_send_to_host(int len, const uint8_t *bytes,
+			       uint8_t chan)
+{
+	i8042_queue_to_host(len, bytes, chan, NULL);
+}
+
 /* Change to set 1 if the I8042_XLATE flag is set. */
 static enum scancode_set_list acting_code_set(enum scancode_set_list set)
 {
@@ -436,6 +457,11 @@ void keyboard_state_changed(int row, int col, int is_pressed)
 	uint8_t scan_code[MAX_SCAN_CODE_LEN];
 	int32_t len = 0;
 	enum ec_error_list ret;
+	uint32_t scan_start;
+	int scanned = keyboard_latency_take_scan(&scan_start);
+
+	if (scanned)
+		keyboard_latency_record(EC_KEYBOARD_LATENCY_SCAN, scan_start);
 
 #ifdef CONFIG_KEYBOARD_DEBUG
 	char mylabel = get_keycap_label(row, col);
@@ -452,7 +478,8 @@ void keyboard_state_changed(int row, int col, int is_pressed)
 	if (ret == EC_SUCCESS) {
 		ASSERT(len > 0);
 		if (keystroke_enabled)
-			i8042_send_to_host(len, scan_code, CHAN_KBD);
+			i8042_queue_to_host(len, scan_code, CHAN_KBD,
+					    scanned ? &scan_start : NULL);
 	}
 
 	if (is_pressed) {
@@ -881,6 +908,42 @@ static void i8042_handle_from_host(void)
 	}
 }
 
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+/* Scanned key byte sitting in the host data port, waiting to be read */
+static int latency_in_flight;
+static uint32_t latency_scan_start;
+static uint32_t latency_written;
+
+static void latency_byte_written(const struct data_byte *entry)
+{
+	if (!entry->timed)
+		return;
+
+	keyboard_latency_record(EC_KEYBOARD_LATENCY_QUEUE, entry->queued);
+	latency_in_flight = 1;
+	latency_scan_start = entry->scan_start;
+	latency_written = get_time().le.lo;
+}
+
+/*
+ * The host has read the byte once the output buffer is empty.  This is
+ * noticed the next time the task runs, which on chips that interrupt on
+ * output buffer empty is right away.
+ */
+static void latency_check_host_read(void)
+{
+	if (!latency_in_flight || lpc_keyboard_has_char())
+		return;
+
+	keyboard_latency_record(EC_KEYBOARD_LATENCY_HOST, latency_written);
+	keyboard_latency_record(EC_KEYBOARD_LATENCY_TOTAL, latency_scan_start);
+	latency_in_flight = 0;
+}
+#else
+static inline void latency_byte_written(const struct data_byte *entry) {}
+static inline void latency_check_host_read(void) {}
+#endif
+
 void keyboard_protocol_task(void *u)
 {
 	int wait = -1;
@@ -917,6 +980,8 @@ void keyboard_protocol_task(void *u)
 			/* Handle command/data write from host */
 			i8042_handle_from_host();
 
+			latency_check_host_read();
+
 			/* Check if we have data to send to host */
 			if (queue_is_empty(&to_host))
 				break;
@@ -959,6 +1024,7 @@ void keyboard_protocol_task(void *u)
 				kblog_put('K', entry.byte);
 				lpc_keyboard_put_char(
 					entry.byte, i8042_keyboard_irq_enabled);
+				latency_byte_written(&entry);
 			}
 			retries = 0;
 		}
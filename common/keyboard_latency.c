@@ -0,0 +1,172 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Keypress-to-host latency statistics */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "keyboard_latency.h"
+#include "timer.h"
+#include "util.h"
+
+#ifndef CONFIG_KEYBOARD_PROTOCOL_8042
+#error "Keyboard latency statistics need the 8042 protocol"
+#endif
+
+/*
+ * Four buckets per power of two.  The first four hold 0-3 us exactly; the
+ * last one also takes everything from 2^20 us (about a second) up.
+ */
+#define SUB_BUCKETS 4
+#define BUCKETS 80
+
+struct latency_stage {
+	uint32_t count;
+	uint32_t max;
+	uint16_t hist[BUCKETS];
+};
+
+/*
+ * Each stage is only recorded by one task (SCAN by the keyboard scanner, the
+ * rest by the 8042 protocol task), so updates don't need locking.
+ */
+static struct latency_stage stages[EC_KEYBOARD_LATENCY_STAGE_COUNT];
+
+static uint32_t pending_scan_start;
+static int scan_pending;
+
+static const char * const stage_names[] = {
+	[EC_KEYBOARD_LATENCY_SCAN] = "scan",
+	[EC_KEYBOARD_LATENCY_QUEUE] = "queue",
+	[EC_KEYBOARD_LATENCY_HOST] = "host",
+	[EC_KEYBOARD_LATENCY_TOTAL] = "total",
+};
+BUILD_ASSERT(ARRAY_SIZE(stage_names) == EC_KEYBOARD_LATENCY_STAGE_COUNT);
+
+static int bucket_of(uint32_t us)
+{
+	int e;
+
+	if (us < SUB_BUCKETS)
+		return us;
+
+	e = __fls(us);
+	return MIN(SUB_BUCKETS * (e - 1) + ((us >> (e - 2)) & 3), BUCKETS - 1);
+}
+
+/* Largest value which falls in a bucket */
+static uint32_t bucket_top(int bucket)
+{
+	int e = bucket / SUB_BUCKETS + 1;
+	int m = bucket % SUB_BUCKETS;
+
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+
+	return ((SUB_BUCKETS + m + 1) << (e - 2)) - 1;
+}
+
+void keyboard_latency_scan(uint32_t scan_start)
+{
+	pending_scan_start = scan_start;
+	scan_pending = 1;
+}
+
+int keyboard_latency_take_scan(uint32_t *scan_start)
+{
+	if (!scan_pending)
+		return 0;
+
+	*scan_start = pending_scan_start;
+	scan_pending = 0;
+	return 1;
+}
+
+void keyboard_latency_record(enum ec_keyboard_latency_stage stage,
+			     uint32_t start)
+{
+	struct latency_stage *s = stages + stage;
+	uint32_t us = get_time().le.lo - start;
+	int b = bucket_of(us);
+
+	s->count++;
+	s->max = MAX(s->max, us);
+	if (s->hist[b] < UINT16_MAX)
+		s->hist[b]++;
+}
+
+static uint32_t percentile(const struct latency_stage *s, int pct)
+{
+	/* Rank of the sample we want, rounded up */
+	uint32_t want = (s->count * pct + 99) / 100;
+	uint32_t seen = 0;
+	int b;
+
+	for (b = 0; b < BUCKETS; b++) {
+		seen += s->hist[b];
+		if (seen >= want)
+			return MIN(bucket_top(b), s->max);
+	}
+
+	/* The histogram saturated; the max is the best we can do */
+	return s->max;
+}
+
+static void get_stats(struct ec_keyboard_latency_stats *out)
+{
+	int i;
+
+	for (i = 0; i < EC_KEYBOARD_LATENCY_STAGE_COUNT; i++) {
+		const struct latency_stage *s = stages + i;
+
+		out[i].count = s->count;
+		out[i].p50_us = s->count ? percentile(s, 50) : 0;
+		out[i].p99_us = s->count ? percentile(s, 99) : 0;
+		out[i].max_us = s->max;
+	}
+}
+
+static enum ec_status
+keyboard_latency_command(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_keyboard_latency *p = args->params;
+	struct ec_response_keyboard_latency *r = args->response;
+
+	get_stats(r->stage);
+	if (p->flags & EC_KEYBOARD_LATENCY_CLEAR)
+		memset(stages, 0, sizeof(stages));
+
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_KEYBOARD_LATENCY, keyboard_latency_command,
+		     EC_VER_MASK(0));
+
+static int command_kblatency(int argc, char **argv)
+{
+	struct ec_keyboard_latency_stats stats[EC_KEYBOARD_LATENCY_STAGE_COUNT];
+	int i;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(stages, 0, sizeof(stages));
+		return EC_SUCCESS;
+	}
+
+	get_stats(stats);
+	ccprintf("stage       count   p50 us   p99 us   max us\n");
+	for (i = 0; i < EC_KEYBOARD_LATENCY_STAGE_COUNT; i++)
+		ccprintf("%-6s %10u %8u %8u %8u\n", stage_names[i],
+			 stats[i].count, stats[i].p50_us, stats[i].p99_us,
+			 stats[i].max_us);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(kblatency, command_kblatency, "[clear]",
+			"Print or clear keypress latency statistics");
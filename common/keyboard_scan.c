@@ -13,6 +13,7 @@
 #include "hooks.h"
 #include "host_command.h"
 #include "keyboard_config.h"
+#include "keyboard_latency.h"
 #include "keyboard_protocol.h"
 #include "keyboard_raw.h"
 #include "keyboard_scan.h"
@@ -231,11 +232,94 @@ static void simulate_key(int row, int col, int pressed)
 	ensure_keyboard_scanned(kbd_polls);
 }
 
+/*
+ * Wait for a freshly driven column to settle.  Sleeping lets other tasks run
+ * meanwhile; usleep() falls back to udelay() before the scheduler starts, so
+ * this is still fine for the boot key scan.
+ */
+static void settle_column(void)
+{
+	if (IS_ENABLED(CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE))
+		usleep(keyscan_config.output_settle_us);
+	else
+		udelay(keyscan_config.output_settle_us);
+}
+
+BUILD_ASSERT(KEYBOARD_COLS_MAX <= 32);
+
+/**
+ * Transpose the matrix into one bitmap of columns per row.
+ *
+ * @param state		Keyboard state, one bitmap of rows per column.
+ * @param cols		Destination for KEYBOARD_ROWS column bitmaps.
+ *
+ * @return Bitmap of the rows pressed in more than one column.  Only these
+ * rows can take part in ghosting, so with one key down there's nothing more
+ * to do.
+ */
+static uint32_t transpose_matrix(const uint8_t *state, uint32_t *cols)
+{
+	uint32_t any = 0;
+	uint32_t shared = 0;
+	int c;
+
+	memset(cols, 0, KEYBOARD_ROWS * sizeof(*cols));
+	for (c = 0; c < keyboard_cols; c++) {
+		uint32_t rows = state[c];
+
+		shared |= any & rows;
+		any |= rows;
+		while (rows)
+			cols[get_next_bit(&rows)] |= BIT(c);
+	}
+
+	return shared;
+}
+
+/**
+ * Fix up keys that changed while the matrix was being read.
+ *
+ * If two columns share at least one key but their states are different,
+ * maybe the state changed between two keyboard_raw_read_rows()s.  If this
+ * happened, update both columns to the union of them.  Merging can make more
+ * columns overlap, so repeat until nothing changes.
+ *
+ * @param state		Keyboard state to fix.
+ */
+static void fix_transitional_ghost(uint8_t *state)
+{
+	uint32_t cols[KEYBOARD_ROWS];
+	uint32_t shared;
+	int changed;
+
+	do {
+		changed = 0;
+		shared = transpose_matrix(state, cols);
+
+		while (shared) {
+			uint32_t group = cols[get_next_bit(&shared)];
+			uint32_t c_mask = group;
+			uint8_t merged = 0;
+
+			while (c_mask)
+				merged |= state[get_next_bit(&c_mask)];
+			while (group) {
+				int c = get_next_bit(&group);
+
+				if (state[c] != merged) {
+					state[c] = merged;
+					changed = 1;
+				}
+			}
+		}
+	} while (changed);
+}
+
 /**
  * Read the raw keyboard matrix state.
  *
- * Used in pre-init, so must not make task-switching-dependent calls; udelay()
- * is ok because it's a spin-loop.
+ * Used in pre-init, so must not make task-switching-dependent calls;
+ * settle_column() only sleeps once the scheduler is running.
  *
  * @param state		Destination for new state (must be KEYBOARD_COLS_MAX
  *			long).
@@ -263,7 +347,7 @@ static int read_matrix(uint8_t *state)
 
 		/* Select column, then wait a bit for it to settle */
 		keyboard_raw_drive_column(c);
-		udelay(keyscan_config.output_settle_us);
+		settle_column();
 
 		/* Read the row state */
 		state[c] = keyboard_raw_read_rows();
@@ -274,28 +358,7 @@ static int read_matrix(uint8_t *state)
 	}
 
 	/* 2. Detect transitional ghost */
-	for (c = 0; c < keyboard_cols; c++) {
-		int c2;
-
-		for (c2 = 0; c2 < c; c2++) {
-			/*
-			 * If two columns shares at least one key but their
-			 * states are different, maybe the state changed between
-			 * two "keyboard_raw_read_rows"s. If this happened,
-			 * update both columns to the union of them.
-			 *
-			 * Note that in theory we need to rescan from col 0 if
-			 * anything is updated, to make sure the newly added
-			 * bits does not introduce more inconsistency.
-			 * Let's ignore this rare case for now.
-			 */
-			if ((state[c] & state[c2]) && (state[c] != state[c2])) {
-				uint8_t merged = state[c] | state[c2];
-
-				state[c] = state[c2] = merged;
-			}
-		}
-	}
+	fix_transitional_ghost(state);
 
 	/* 3. Fix result */
 	for (c = 0; c < keyboard_cols; c++) {
@@ -431,21 +494,21 @@ static int check_runtime_keys(const uint8_t *state)
  */
 static int has_ghosting(const uint8_t *state)
 {
-	int c, c2;
+	uint32_t cols[KEYBOARD_ROWS];
+	uint32_t shared = transpose_matrix(state, cols);
 
-	for (c = 0; c < keyboard_cols; c++) {
-		if (!state[c])
-			continue;
+	while (shared) {
+		uint32_t row = cols[get_next_bit(&shared)];
+		uint32_t others = shared;
 
-		for (c2 = c + 1; c2 < keyboard_cols; c2++) {
+		while (others) {
 			/*
-			 * A little bit of cleverness here.  Ghosting happens
-			 * if 2 columns share at least 2 keys.  So we OR the
-			 * columns together and then see if more than one bit
-			 * is set.  x&(x-1) is non-zero only if x has more than
-			 * one bit set.
+			 * Ghosting happens if 2 columns share at least 2 keys,
+			 * which is the same as 2 rows sharing at least 2
+			 * columns.  x&(x-1) is non-zero only if x has more
+			 * than one bit set.
 			 */
-			uint8_t common = state[c] & state[c2];
+			uint32_t common = row & cols[get_next_bit(&others)];
 
 			if (common & (common - 1))
 				return 1;
@@ -461,6 +524,9 @@ static void key_state_changed(int row, int col, uint8_t state)
 	if (!keyboard_scan_is_enabled())
 		return;
 
+	/* Latency counts from the scan which first saw the edge */
+	keyboard_latency_scan(scan_time[scan_edge_index[col][row]]);
+
 	/* No-op for protocols that require full keyboard matrix (e.g. MKBP). */
 	keyboard_state_changed(row, col, !!(state & BIT(row)));
 }
@@ -75,6 +75,8 @@ static int tx_msg_cnt;
 static int tx_retry_cnt = -1;
 static uint8_t rx_buffer[BUFFER_SIZE];
 static int rx_pos = -1;
+/* Next register of a read which continues without a new start, or -1 */
+static int reg_read_pos = -1;
 
 static const char * const ctrl_msg_name[] = {
 	[0]				= "C-RSVD_0",
@@ -486,6 +488,7 @@ static void tcpci_reset_register_defaults(void)
 void mock_tcpci_reset(void)
 {
 	tcpci_reset_register_defaults();
+	reg_read_pos = -1;
 }
 
 void mock_tcpci_set_reg(int reg_offset, uint16_t value)
@@ -521,6 +524,31 @@ uint16_t mock_tcpci_get_reg(int reg_offset)
 	return tcpci_regs[reg_offset].value;
 }
 
+/* Register reads auto-increment through consecutive registers */
+static int tcpci_read_regs(int offset, uint8_t *in, int in_size, int flags)
+{
+	struct tcpci_reg *reg;
+	int pos = 0;
+
+	while (pos < in_size) {
+		reg = tcpci_regs + offset;
+		if (offset >= ARRAY_SIZE(tcpci_regs) || reg->size == 0 ||
+		    pos + reg->size > in_size) {
+			ccprints("ERROR: read of 0x%x in_size %d",
+				 offset, in_size - pos);
+			return EC_ERROR_UNKNOWN;
+		}
+		in[pos] = reg->value;
+		if (reg->size == 2)
+			in[pos + 1] = reg->value >> 8;
+		pos += reg->size;
+		offset += reg->size;
+	}
+
+	reg_read_pos = (flags & I2C_XFER_STOP) ? -1 : offset;
+	return EC_SUCCESS;
+}
+
 int tcpci_i2c_xfer(int port, uint16_t addr_flags,
 		const uint8_t *out, int out_size,
 		uint8_t *in, int in_size, int flags)
@@ -551,6 +579,10 @@ int tcpci_i2c_xfer(int port, uint16_t addr_flags,
 		return EC_SUCCESS;
 	}
 
+	if (out_size == 0 && reg_read_pos >= 0)
+		return tcpci_read_regs(reg_read_pos, in, in_size, flags);
+	reg_read_pos = -1;
+
 	if (out_size == 0) {
 		ccprints("ERROR: out_size == 0");
 		return EC_ERROR_UNKNOWN;
@@ -599,17 +631,7 @@ int tcpci_i2c_xfer(int port, uint16_t addr_flags,
 		memcpy(in, rx_buffer, in_size);
 		rx_pos += in_size;
 	} else if (out_size == 1) {
-		if (in_size != reg->size) {
-			ccprints("ERROR: %s in_size %d != %d", reg->name,
-				 in_size, reg->size);
-			return EC_ERROR_UNKNOWN;
-		}
-		if (reg->size == 1)
-			in[0] = reg->value;
-		else if (reg->size == 2) {
-			in[0] = reg->value;
-			in[1] = reg->value >> 8;
-		}
+		return tcpci_read_regs(reg->offset, in, in_size, flags);
 	} else {
 		uint16_t value = 0;
 
@@ -134,6 +134,23 @@ static enum sensor_config motion_sense_get_ec_config(void)
 		return SENSOR_CONFIG_MAX;
 	}
 }
+
+/*
+ * Number of samples the hardware FIFO of a forced mode sensor may collect
+ * between two reads: as many as the latency requested with ec_rate allows.
+ */
+static int motion_sense_hw_fifo_batch(const struct motion_sensor_t *sensor,
+				      int period_us, int ec_rate_us)
+{
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+	if (motion_sensor_in_forced_mode(sensor) && sensor->drv->read_fifo &&
+	    period_us > 0)
+		return CLAMP(ec_rate_us / period_us, 1,
+			     CONFIG_ACCEL_HW_FIFO_BATCH);
+#endif
+	return 1;
+}
+
 /* motion_sense_set_data_rate
  *
  * Set the sensor data rate. It is altered when the AP change the data
@@ -193,6 +210,9 @@ int motion_sense_set_data_rate(struct motion_sensor_t *sensor)
 	 * it may appear to be in the future.
 	 */
 	sensor->collection_rate = odr > 0 ? SECOND * 1000 / odr : 0;
+	sensor->collection_rate *= motion_sense_hw_fifo_batch(sensor,
+			sensor->collection_rate,
+			sensor->config[config_id].ec_rate);
 	sensor->next_collection = ts.le.lo + sensor->collection_rate;
 	sensor->oversampling = 0;
 	mutex_unlock(&g_sensor_mutex);
@@ -260,11 +280,20 @@ static int motion_sense_select_ec_rate(
 {
 	if (interrupt == 0 && motion_sensor_in_forced_mode(sensor)) {
 		int rate_mhz = BASE_ODR(sensor->config[config_id].odr);
-		/* we have to run ec at the sensor frequency rate.*/
-		if (rate_mhz > 0)
-			return SECOND * 1000 / rate_mhz;
-		else
+		int period;
+
+		/*
+		 * we have to run ec at the sensor frequency rate, or less often
+		 * if the sensor hardware FIFO collects the samples.
+		 */
+		if (rate_mhz > 0) {
+			period = SECOND * 1000 / rate_mhz;
+			return period * motion_sense_hw_fifo_batch(
+				sensor, period,
+				sensor->config[config_id].ec_rate);
+		} else {
 			return 0;
+		}
 	} else {
 		return sensor->config[config_id].ec_rate;
 	}
@@ -651,6 +680,45 @@ static int motion_sense_read(struct motion_sensor_t *sensor)
 }
 
 
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+/*
+ * Drain the hardware FIFO of a forced mode sensor and stage its samples.
+ * Only the time of the newest sample is known; the older ones are spaced back
+ * from it by the sensor data period.
+ */
+static int motion_sense_drain_hw_fifo(struct motion_sensor_t *sensor)
+{
+	/* Room for a late read; anything left waits for the next one. */
+	static intv3_t v[2 * CONFIG_ACCEL_HW_FIFO_BATCH];
+	struct ec_response_motion_sensor_data vector;
+	uint32_t now, period;
+	int ret, count, odr, i;
+
+	ret = sensor->drv->read_fifo(sensor, v, ARRAY_SIZE(v), &count);
+	now = __hw_clock_source_read();
+	if (ret != EC_SUCCESS)
+		return ret;
+	/* Nothing new, same as a sensor not ready yet. */
+	if (count == 0)
+		return EC_ERROR_BUSY;
+
+	odr = sensor->drv->get_data_rate(sensor);
+	period = odr > 0 ? SECOND * 1000 / odr : 0;
+
+	vector.flags = 0;
+	vector.sensor_num = sensor - motion_sensors;
+	for (i = 0; i < count; i++) {
+		ec_motion_sensor_fill_values(&vector, v[i]);
+		motion_sense_fifo_stage_data(&vector, sensor, 3,
+					     now - (count - 1 - i) * period);
+	}
+	motion_sense_fifo_commit_data();
+	memcpy(sensor->raw_xyz, v[count - 1], sizeof(sensor->raw_xyz));
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_ACCEL_HW_FIFO_BATCH */
+
 static inline void increment_sensor_collection(struct motion_sensor_t *sensor,
 					       const timestamp_t *ts)
 {
@@ -708,6 +776,31 @@ static void motion_sense_push_raw_xyz(struct motion_sensor_t *s)
 	}
 }
 
+/**
+ * Read a forced mode sensor and commit its new data: a batch from its
+ * hardware FIFO when it has one, else a single sample.
+ *
+ * @param sensor Pointer to the sensor.
+ * @return EC_SUCCESS if new data was committed.
+ */
+static int motion_sense_forced_read(struct motion_sensor_t *sensor)
+{
+	int ret;
+
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+	if (sensor->drv->read_fifo &&
+	    !(IS_ENABLED(CONFIG_ACCEL_SPOOF_MODE) &&
+	      (sensor->flags & MOTIONSENSE_FLAG_IN_SPOOF_MODE)))
+		return motion_sense_drain_hw_fifo(sensor);
+#endif
+
+	ret = motion_sense_read(sensor);
+	if (ret == EC_SUCCESS)
+		motion_sense_push_raw_xyz(sensor);
+
+	return ret;
+}
+
 static int motion_sense_process(struct motion_sensor_t *sensor,
 				uint32_t *event,
 				const timestamp_t *ts)
@@ -744,15 +837,13 @@ static int motion_sense_process(struct motion_sensor_t *sensor,
 			 * would crash in increment_sensor_collection.
 			 */
 			increment_sensor_collection(sensor, ts);
-			ret = motion_sense_read(sensor);
+			ret = motion_sense_forced_read(sensor);
 		} else {
 			ret = EC_ERROR_BUSY;
 		}
 
-		if (ret == EC_SUCCESS) {
-			motion_sense_push_raw_xyz(sensor);
+		if (ret == EC_SUCCESS)
 			has_data_read = 1;
-		}
 	}
 	if (IS_ENABLED(CONFIG_ACCEL_FIFO) &&
 	    *event & TASK_EVENT_MOTION_FLUSH_PENDING) {
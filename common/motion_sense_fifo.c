@@ -221,6 +221,66 @@ static inline bool is_new_timestamp(uint8_t sensor_num)
 	       !(next_timestamp_initialized & BIT(sensor_num));
 }
 
+/**
+ * Peek into the staged data at a given offset. This function performs no bound
+ * checking and is purely for confinience.
+ *
+ * @param offset The offset into the staged data to peek into.
+ * @return Pointer to the entry at the given offset.
+ */
+static inline struct ec_response_motion_sensor_data *
+peek_fifo_staged(size_t offset)
+{
+	return (struct ec_response_motion_sensor_data *)
+		queue_get_write_chunk(&fifo, offset).buffer;
+}
+
+/**
+ * Reserve the next staging slot of the fifo, making room for it if needed.
+ * Entries are built in place there rather than copied in.
+ *
+ * WARNING: This function MUST be called from within a locked context of
+ * g_sensor_mutex.
+ *
+ * @return Pointer to the slot, NULL if none could be found.
+ */
+static struct ec_response_motion_sensor_data *fifo_reserve_staged(void)
+{
+	struct ec_response_motion_sensor_data *slot;
+
+	/* Make sure we have room for the data */
+	fifo_ensure_space();
+
+	/*
+	 * Get the next writable block in the fifo. We don't need to lock this
+	 * because it will always be past the tail and thus the AP will never
+	 * read this until motion_sense_fifo_commit_data() is called.
+	 */
+	slot = peek_fifo_staged(fifo_staged.count);
+
+	/*
+	 * This should never happen since we already ensured there was space,
+	 * but if there was a bug, we don't want to write to address 0. Just
+	 * don't add any data to the queue instead.
+	 */
+	if (!slot) {
+		CPRINTS("Failed to get write chunk for new fifo data!");
+		return NULL;
+	}
+
+	return slot;
+}
+
+/**
+ * Flags describing the device state, added to every staged entry.
+ */
+static inline uint8_t fifo_mode_flags(void)
+{
+	if (IS_ENABLED(CONFIG_TABLET_MODE) && tablet_get_mode())
+		return MOTIONSENSE_SENSOR_FLAG_TABLET_MODE;
+	return 0;
+}
+
 /**
  * Stage a single data unit to the motion sense fifo. Note that for the AP to
  * see this data, it must be committed.
@@ -234,7 +294,7 @@ static void fifo_stage_unit(
 	struct motion_sensor_t *sensor,
 	int valid_data)
 {
-	struct queue_chunk chunk;
+	struct ec_response_motion_sensor_data *slot;
 	int i;
 
 	mutex_lock(&g_sensor_mutex);
@@ -274,27 +334,8 @@ static void fifo_stage_unit(
 		}
 	}
 
-	/* Make sure we have room for the data */
-	fifo_ensure_space();
-
-	if (IS_ENABLED(CONFIG_TABLET_MODE))
-		data->flags |= (tablet_get_mode() ?
-				MOTIONSENSE_SENSOR_FLAG_TABLET_MODE : 0);
-
-	/*
-	 * Get the next writable block in the fifo. We don't need to lock this
-	 * because it will always be past the tail and thus the AP will never
-	 * read this until motion_sense_fifo_commit_data() is called.
-	 */
-	chunk = queue_get_write_chunk(&fifo, fifo_staged.count);
-
-	if (!chunk.buffer) {
-		/*
-		 * This should never happen since we already ensured there was
-		 * space, but if there was a bug, we don't want to write to
-		 * address 0. Just don't add any data to the queue instead.
-		 */
-		CPRINTS("Failed to get write chunk for new fifo data!");
+	slot = fifo_reserve_staged();
+	if (!slot) {
 		mutex_unlock(&g_sensor_mutex);
 		return;
 	}
@@ -307,7 +348,8 @@ static void fifo_stage_unit(
 	 * be written to the next available block and this one will remain
 	 * staged.
 	 */
-	memcpy(chunk.buffer, data, fifo.unit_bytes);
+	memcpy(slot, data, fifo.unit_bytes);
+	slot->flags |= fifo_mode_flags();
 	fifo_staged.count++;
 
 	/*
@@ -333,26 +375,29 @@ static void fifo_stage_unit(
  */
 static void fifo_stage_timestamp(uint32_t timestamp, uint8_t sensor_num)
 {
-	struct ec_response_motion_sensor_data vector;
+	struct ec_response_motion_sensor_data *slot;
 
-	vector.flags = MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
-	vector.timestamp = timestamp;
-	vector.sensor_num = sensor_num;
-	fifo_stage_unit(&vector, NULL, 0);
-}
+	mutex_lock(&g_sensor_mutex);
 
-/**
- * Peek into the staged data at a given offset. This function performs no bound
- * checking and is purely for confinience.
- *
- * @param offset The offset into the staged data to peek into.
- * @return Pointer to the entry at the given offset.
- */
-static inline struct ec_response_motion_sensor_data *
-peek_fifo_staged(size_t offset)
-{
-	return (struct ec_response_motion_sensor_data *)
-		queue_get_write_chunk(&fifo, offset).buffer;
+	/* Update the next value of the sensor's timestamp if it is new. */
+	if (is_new_timestamp(sensor_num)) {
+		next_timestamp[sensor_num].next =
+			next_timestamp[sensor_num].prev = timestamp;
+		next_timestamp_initialized |= BIT(sensor_num);
+	}
+
+	/* Timestamps are small enough to build right in the fifo. */
+	slot = fifo_reserve_staged();
+	if (slot) {
+		slot->flags = MOTIONSENSE_SENSOR_FLAG_TIMESTAMP |
+			      fifo_mode_flags();
+		slot->sensor_num = sensor_num;
+		slot->reserved = 0;
+		slot->timestamp = timestamp;
+		fifo_staged.count++;
+	}
+
+	mutex_unlock(&g_sensor_mutex);
 }
 
 void motion_sense_fifo_init(void)
@@ -600,12 +645,21 @@ inline int motion_sense_fifo_over_thres(void)
 int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 			   uint16_t *out_size)
 {
-	int count;
+	struct queue_chunk chunk;
+	int count = 0, n;
 
 	mutex_lock(&g_sensor_mutex);
-	count = MIN(capacity_bytes / fifo.unit_bytes,
-		    MIN(queue_count(&fifo), max_count));
-	count = queue_remove_units(&fifo, out, count);
+	max_count = MIN(capacity_bytes / fifo.unit_bytes,
+			MIN(queue_count(&fifo), max_count));
+	/* At most two spans: up to the end of the buffer, then from its start */
+	while (count < max_count) {
+		chunk = queue_get_read_chunk(&fifo);
+		n = MIN(chunk.count, max_count - count);
+		memcpy((uint8_t *)out + count * fifo.unit_bytes, chunk.buffer,
+		       n * fifo.unit_bytes);
+		queue_advance_head(&fifo, n);
+		count += n;
+	}
 	mutex_unlock(&g_sensor_mutex);
 	*out_size = count * fifo.unit_bytes;
 
@@ -57,27 +57,44 @@ void pd_log_recv_vdm(int port, int cnt, uint32_t *payload)
 	}
 }
 
+/*
+ * Ask the connected accessories for their next log entry.
+ *
+ * Returns -1 if an accessory is busy and the host should retry, else the
+ * number of entries which came in.
+ */
+static int fetch_acc_log_entries(void)
+{
+	int i, res;
+
+	incoming_logs = 0;
+	for (i = 0; i < board_get_usb_pd_port_count(); ++i) {
+		/* only accessories who knows Google logging format */
+		if (pd_get_identity_vid(i) != USB_VID_GOOGLE)
+			continue;
+		res = pd_fetch_acc_log_entry(i);
+		if (res == EC_RES_BUSY) /* host should retry */
+			return -1;
+	}
+
+	return incoming_logs;
+}
+
 /* we are a PD MCU/EC, send back the events to the host */
 static enum ec_status hc_pd_get_log_entry(struct host_cmd_handler_args *args)
 {
 	struct ec_response_pd_log *r = args->response;
+	int res;
 
 dequeue_retry:
 	args->response_size = log_dequeue_event((struct event_log_entry *)r);
 	/* if the MCU log no longer has entries, try connected accessories */
 	if (r->type == PD_EVENT_NO_ENTRY) {
-		int i, res;
-		incoming_logs = 0;
-		for (i = 0; i < board_get_usb_pd_port_count(); ++i) {
-			/* only accessories who knows Google logging format */
-			if (pd_get_identity_vid(i) != USB_VID_GOOGLE)
-				continue;
-			res = pd_fetch_acc_log_entry(i);
-			if (res == EC_RES_BUSY) /* host should retry */
-				return EC_RES_BUSY;
-		}
+		res = fetch_acc_log_entries();
+		if (res < 0) /* host should retry */
+			return EC_RES_BUSY;
 		/* we have received new entries from an accessory */
-		if (incoming_logs)
+		if (res)
 			goto dequeue_retry;
 		/* else the current entry is already "PD_EVENT_NO_ENTRY" */
 	}
@@ -88,6 +105,33 @@ DECLARE_HOST_COMMAND(EC_CMD_PD_GET_LOG_ENTRY,
 		     hc_pd_get_log_entry,
 		     EC_VER_MASK(0));
 
+static enum ec_status
+hc_pd_get_log_entries(struct host_cmd_handler_args *args)
+{
+	struct ec_response_pd_log_entries *r = args->response;
+	int size = args->response_max - sizeof(*r);
+	int count, used, res;
+
+	used = log_dequeue_events(r->entries, size, &count);
+	/* if the MCU log is empty, try connected accessories */
+	if (!count) {
+		res = fetch_acc_log_entries();
+		if (res < 0) /* host should retry */
+			return EC_RES_BUSY;
+		if (res)
+			used = log_dequeue_events(r->entries, size, &count);
+	}
+
+	r->count = count;
+	r->dropped = MIN(log_get_dropped(), UINT16_MAX);
+	args->response_size = sizeof(*r) + used;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_PD_GET_LOG_ENTRIES,
+		     hc_pd_get_log_entries,
+		     EC_VER_MASK(0));
+
 static enum ec_status hc_pd_write_log_entry(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_pd_write_log_entry *p = args->params;
@@ -100,8 +100,28 @@ static int print_hex_buffer(int (*addchar)(void *context, int c),
 	return EC_SUCCESS;
 }
 
-int vfnprintf(int (*addchar)(void *context, int c), void *context,
-	      const char *format, va_list args)
+/*
+ * Add a run of characters, in one call if the caller supplied addstr().
+ * Returns 0 if all were added, non-zero if any were dropped.
+ */
+static int add_span(int (*addchar)(void *context, int c),
+		    int (*addstr)(void *context, const char *str, int len),
+		    void *context, const char *str, int len)
+{
+	if (addstr)
+		return len ? addstr(context, str, len) : 0;
+
+	while (len--) {
+		if (addchar(context, *str++))
+			return 1;
+	}
+	return 0;
+}
+
+static int vfnprintf_impl(int (*addchar)(void *context, int c),
+			  int (*addstr)(void *context, const char *str,
+					int len),
+			  void *context, const char *format, va_list args)
 {
 	/*
 	 * Longest uint64 in decimal = 20
@@ -120,9 +140,14 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 		int c = *format++;
 		char sign = 0;
 
-		/* Copy normal characters */
+		/* Copy normal characters, up to the next format */
 		if (c != '%') {
-			if (addchar(context, c))
+			const char *start = format - 1;
+
+			while (*format && *format != '%')
+				format++;
+			if (add_span(addchar, addstr, context, start,
+				     format - start))
 				return EC_ERROR_OVERFLOW;
 			continue;
 		}
@@ -434,7 +459,6 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 		if (precision < 0) {
 			/* If precision is unset, print everything */
 			vlen = strlen(vstr);
-			precision = MAX(vlen, pad_width);
 		} else {
 			/*
 			 * If precision is set, ensure that we do not
@@ -443,15 +467,16 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 			vlen = strnlen(vstr, precision);
 		}
 
+		/* Print vlen characters; vlen then counts the padding too */
+		precision = vlen;
 
 		while (vlen < pad_width && !(flags & PF_LEFT)) {
 			if (addchar(context, flags & PF_PADZERO ? '0' : ' '))
 				return EC_ERROR_OVERFLOW;
 			vlen++;
 		}
-		while (--precision >= 0 && *vstr)
-			if (addchar(context, *vstr++))
-				return EC_ERROR_OVERFLOW;
+		if (add_span(addchar, addstr, context, vstr, precision))
+			return EC_ERROR_OVERFLOW;
 		while (vlen < pad_width && flags & PF_LEFT) {
 			if (addchar(context, ' '))
 				return EC_ERROR_OVERFLOW;
@@ -463,6 +488,290 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 	return EC_SUCCESS;
 }
 
+int vfnprintf(int (*addchar)(void *context, int c), void *context,
+	      const char *format, va_list args)
+{
+	return vfnprintf_impl(addchar, NULL, context, format, args);
+}
+
+int vfnprintf_span(int (*addchar)(void *context, int c),
+		   int (*addstr)(void *context, const char *str, int len),
+		   void *context, const char *format, va_list args)
+{
+	return vfnprintf_impl(addchar, addstr, context, format, args);
+}
+
+#ifdef CONFIG_CONSOLE_TOKENIZED
+static const char base64_chars[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Context for vfntokenize(); base64-encodes the record as it is built */
+struct tokenize_context {
+	int (*addchar)(void *context, int c);
+	void *context;
+	uint32_t group;		/* Bytes waiting to be encoded */
+	int count;		/* Number of bytes in group */
+	int rv;			/* Set once a character is dropped */
+};
+
+static void tokenize_addchar(struct tokenize_context *t, int c)
+{
+	if (t->rv == EC_SUCCESS && t->addchar(t->context, c))
+		t->rv = EC_ERROR_OVERFLOW;
+}
+
+static void tokenize_byte(struct tokenize_context *t, uint8_t b)
+{
+	int i;
+
+	t->group = (t->group << 8) | b;
+	if (++t->count < 3)
+		return;
+
+	for (i = 18; i >= 0; i -= 6)
+		tokenize_addchar(t, base64_chars[(t->group >> i) & 0x3f]);
+	t->group = 0;
+	t->count = 0;
+}
+
+static void tokenize_flush(struct tokenize_context *t)
+{
+	int i;
+
+	if (!t->count)
+		return;
+
+	/* Encode the last 1 or 2 bytes as a padded group */
+	t->group <<= 8 * (3 - t->count);
+	for (i = 0; i < 4; i++) {
+		int c = base64_chars[(t->group >> (18 - 6 * i)) & 0x3f];
+
+		tokenize_addchar(t, i <= t->count ? c : '=');
+	}
+}
+
+/* Unsigned LEB128 */
+static void tokenize_varint(struct tokenize_context *t, uint64_t v)
+{
+	while (v >= 0x80) {
+		tokenize_byte(t, (v & 0x7f) | 0x80);
+		v >>= 7;
+	}
+	tokenize_byte(t, v);
+}
+
+/* Zigzag, so small negative numbers stay short */
+static void tokenize_signed(struct tokenize_context *t, int64_t v)
+{
+	tokenize_varint(t, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+static void tokenize_bytes(struct tokenize_context *t, const char *buf,
+			   int len)
+{
+	tokenize_varint(t, len);
+	while (len--)
+		tokenize_byte(t, *buf++);
+}
+
+/* Parse a width or precision; returns -1 if it is out of range */
+static int tokenize_field(struct tokenize_context *t, const char **format,
+			  int *c, va_list *args)
+{
+	int n = 0;
+
+	if (*c == '*') {
+		n = va_arg(*args, int);
+		tokenize_signed(t, n);
+		*c = *(*format)++;
+	} else {
+		while (*c >= '0' && *c <= '9') {
+			n = (10 * n) + *c - '0';
+			*c = *(*format)++;
+		}
+	}
+
+	return (n < 0 || n > MAX_FORMAT) ? -1 : n;
+}
+
+int vfntokenize(int (*addchar)(void *context, int c), void *context,
+		int tflags, const char *format, va_list args)
+{
+	struct tokenize_context t = {
+		.addchar = addchar,
+		.context = context,
+	};
+	uint32_t token = (uintptr_t)format;
+	va_list ap;
+	int err = EC_SUCCESS;
+	int i;
+
+	if (IS_ENABLED(SECTION_IS_RW))
+		tflags |= TOKENIZE_RW;
+	if (IS_ENABLED(CONFIG_PRINTF_LEGACY_LI_FORMAT))
+		tflags |= TOKENIZE_LEGACY_LI;
+	if (IS_ENABLED(CONFIG_CONSOLE_VERBOSE))
+		tflags |= TOKENIZE_VERBOSE_TIME;
+
+	tokenize_addchar(&t, TOKENIZE_MARKER);
+	tokenize_byte(&t, tflags);
+	for (i = 0; i < 32; i += 8)
+		tokenize_byte(&t, token >> i);
+	if (tflags & TOKENIZE_TIMESTAMP)
+		tokenize_varint(&t, get_time().val);
+
+	/*
+	 * Walk the format the same way vfnprintf() does, but only record the
+	 * arguments; the host formats them.
+	 */
+	va_copy(ap, args);
+	while (*format) {
+		int c = *format++;
+		int flags = 0;
+		int precision = -1;
+		uint64_t v;
+
+		if (c != '%')
+			continue;
+
+		c = *format++;
+		if (c == '%')
+			continue;
+		if (c == '\0')
+			break;
+
+		if (c == 'c') {
+			tokenize_signed(&t, va_arg(ap, int));
+			continue;
+		}
+
+		if (c == '-')
+			c = *format++;
+		if (c == '+')
+			c = *format++;
+		if (c == '0')
+			c = *format++;
+
+		if (tokenize_field(&t, &format, &c, &ap) < 0) {
+			format = error_str;
+			continue;
+		}
+
+		if (c == '.') {
+			c = *format++;
+			precision = tokenize_field(&t, &format, &c, &ap);
+			if (precision < 0) {
+				format = error_str;
+				continue;
+			}
+		}
+
+		if (c == 's') {
+			const char *vstr = va_arg(ap, const char *);
+
+			if (vstr == NULL)
+				vstr = "(NULL)";
+			tokenize_bytes(&t, vstr, precision < 0 ? strlen(vstr) :
+				       strnlen(vstr, precision));
+			continue;
+		}
+
+		if (c == 'l') {
+			if (sizeof(long) == sizeof(uint64_t))
+				flags |= PF_64BIT;
+
+			c = *format++;
+			if (c == 'l') {
+				flags |= PF_64BIT;
+				c = *format++;
+			}
+
+			if (!(flags & PF_64BIT)) {
+				format = error_str;
+				continue;
+			}
+		} else if (c == 'z') {
+			if (sizeof(size_t) == sizeof(uint64_t))
+				flags |= PF_64BIT;
+
+			c = *format++;
+		}
+
+		if (c == 'p') {
+			int ptrspec = *format++;
+			void *ptrval = va_arg(ap, void *);
+
+			if (ptrspec == 'T') {
+				/* %pT - timestamp in us */
+				v = ptrval == PRINTF_TIMESTAMP_NOW ?
+					get_time().val : *(uint64_t *)ptrval;
+				tokenize_varint(&t, v);
+			} else if (ptrspec == 'h') {
+				/* %ph - hex buffer, sent as raw bytes */
+				struct hex_buffer_params *hexbuf = ptrval;
+
+				if (hexbuf)
+					tokenize_bytes(&t, hexbuf->buffer,
+						       hexbuf->size);
+				else
+					tokenize_varint(&t, 0);
+			} else if (ptrspec == 'P') {
+				tokenize_varint(&t, (uintptr_t)ptrval);
+			} else if (ptrspec == 'b') {
+				/* %pb - count + 1 (0 if NULL), then value */
+				struct binary_print_params *binary = ptrval;
+
+				if (binary) {
+					tokenize_varint(&t, binary->count + 1);
+					tokenize_varint(&t, binary->value);
+				} else {
+					tokenize_varint(&t, 0);
+				}
+			} else {
+				err = EC_ERROR_INVAL;
+				break;
+			}
+			continue;
+		}
+
+		if (flags & PF_64BIT)
+			v = va_arg(ap, uint64_t);
+		else
+			v = va_arg(ap, uint32_t);
+
+		switch (c) {
+#ifdef CONFIG_PRINTF_LEGACY_LI_FORMAT
+		case 'i':
+			/* force 32-bit for compatibility */
+			tokenize_signed(&t, (int32_t)v);
+			break;
+#endif
+		case 'd':
+			if (flags & PF_64BIT)
+				tokenize_signed(&t, (int64_t)v);
+			else
+				tokenize_signed(&t, (int32_t)v);
+			break;
+		case 'u':
+		case 'T':
+		case 'X':
+		case 'x':
+			tokenize_varint(&t, v);
+			break;
+		default:
+			/* Bad format specifier; the host prints error_str */
+			format = error_str;
+		}
+	}
+	va_end(ap);
+
+	tokenize_flush(&t);
+	tokenize_addchar(&t, '\n');
+
+	return t.rv ? t.rv : err;
+}
+#endif /* CONFIG_CONSOLE_TOKENIZED */
+
 /* Context for snprintf() */
 struct snprintf_context {
 	char *str;
@@ -488,6 +797,18 @@ static int snprintf_addchar(void *context, int c)
 	return 0;
 }
 
+/* Add a run of characters to the string context; see snprintf_addchar() */
+static int snprintf_addstr(void *context, const char *str, int len)
+{
+	struct snprintf_context *ctx = (struct snprintf_context *)context;
+	int n = MIN(len, ctx->size);
+
+	memcpy(ctx->str, str, n);
+	ctx->str += n;
+	ctx->size -= n;
+	return n < len;
+}
+
 int crec_snprintf(char *str, size_t size, const char *format, ...)
 {
 	va_list args;
@@ -511,7 +832,8 @@ int crec_vsnprintf(char *str, size_t size, const char *format, va_list args)
 	ctx.str = str;
 	ctx.size = size - 1;  /* Reserve space for terminating '\0' */
 
-	rv = vfnprintf(snprintf_addchar, &ctx, format, args);
+	rv = vfnprintf_span(snprintf_addchar, snprintf_addstr, &ctx, format,
+			    args);
 
 	/* Terminate string */
 	*ctx.str = '\0';
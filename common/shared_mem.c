@@ -36,6 +36,10 @@ int shared_mem_acquire(int size, char **dest_ptr)
 	if (size > shared_mem_size() || size <= 0)
 		return EC_ERROR_INVAL;
 
+	if (IS_ENABLED(CONFIG_SHMEM_POOLS) &&
+	    shmem_pool_acquire(size, dest_ptr) == EC_SUCCESS)
+		return EC_SUCCESS;
+
 	if (buf_in_use)
 		return EC_ERROR_BUSY;
 
@@ -58,6 +62,9 @@ int shared_mem_acquire(int size, char **dest_ptr)
 
 void shared_mem_release(void *ptr)
 {
+	if (IS_ENABLED(CONFIG_SHMEM_POOLS) && shmem_pool_release(ptr))
+		return;
+
 	buf_in_use = 0;
 }
 
@@ -67,6 +74,8 @@ static int command_shmem(int argc, char **argv)
 	ccprintf("Size:%6d\n", shared_mem_size());
 	ccprintf("Used:%6d\n", buf_in_use);
 	ccprintf("Max: %6d\n", max_used);
+	if (IS_ENABLED(CONFIG_SHMEM_POOLS))
+		shmem_pool_print_stats();
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem,
@@ -317,6 +317,10 @@ int shared_mem_acquire(int size, char **dest_ptr)
 	if (in_interrupt_context())
 		return EC_ERROR_INVAL;
 
+	if (IS_ENABLED(CONFIG_SHMEM_POOLS) &&
+	    shmem_pool_acquire(size, dest_ptr) == EC_SUCCESS)
+		return EC_SUCCESS;
+
 	if (!free_buf_chain)
 		return EC_ERROR_BUSY;
 
@@ -345,6 +349,9 @@ void shared_mem_release(void *ptr)
 	if (in_interrupt_context())
 		return;
 
+	if (IS_ENABLED(CONFIG_SHMEM_POOLS) && shmem_pool_release(ptr))
+		return;
+
 	mutex_lock(&shmem_lock);
 	do_release((struct shm_buffer *)ptr - 1);
 	mutex_unlock(&shmem_lock);
@@ -384,6 +391,8 @@ static int command_shmem(int argc, char **argv)
 	ccprintf("Free:          %6zd\n", free_size);
 	ccprintf("Max free buf:  %6zd\n", max_free);
 	ccprintf("Max allocated: %6d\n", max_allocated_size);
+	if (IS_ENABLED(CONFIG_SHMEM_POOLS))
+		shmem_pool_print_stats();
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem,
@@ -0,0 +1,126 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Fixed size block pools in front of the shared memory buffer */
+
+#include "atomic.h"
+#include "common.h"
+#include "console.h"
+#include "shared_mem.h"
+#include "util.h"
+
+static const struct {
+	uint16_t block_size;
+	uint8_t blocks;
+} pool_config[] = {
+#define SHMEM_POOL(size, count) { .block_size = (size), .blocks = (count) },
+	CONFIG_SHMEM_POOL_LIST
+#undef SHMEM_POOL
+};
+
+#define POOL_COUNT ARRAY_SIZE(pool_config)
+
+/* Storage for all the pools, one after the other */
+#define SHMEM_POOL(size, count) + (size) * (count)
+static uint8_t pool_buf[0 CONFIG_SHMEM_POOL_LIST] __aligned(8);
+#undef SHMEM_POOL
+
+#define SHMEM_POOL(size, count) \
+	BUILD_ASSERT((size) % 8 == 0 && (count) > 0 && (count) <= 32);
+CONFIG_SHMEM_POOL_LIST
+#undef SHMEM_POOL
+
+static struct {
+	atomic_t used;		/* Bitmap of blocks handed out */
+	atomic_t in_use;	/* Number of blocks handed out */
+	int max_used;		/* High-water mark of in_use */
+	uint32_t full;		/* Requests which found the pool full */
+} pools[POOL_COUNT];
+
+static inline int pool_bytes(int i)
+{
+	return pool_config[i].block_size * pool_config[i].blocks;
+}
+
+/*
+ * Claim a free block of a pool without locking: if another task claims the
+ * same block first, atomic_or() shows it was already set and we try again.
+ *
+ * @return The block index, or -1 if the pool is full.
+ */
+static int claim_block(int i)
+{
+	uint32_t all = UINT32_MAX >> (32 - pool_config[i].blocks);
+	uint32_t free_blocks, bit;
+	int in_use;
+
+	while ((free_blocks = ~pools[i].used & all)) {
+		bit = BIT(__fls(free_blocks));
+		if (atomic_or(&pools[i].used, bit) & bit)
+			continue;
+
+		/* Statistics only, a lost update doesn't matter */
+		in_use = atomic_add(&pools[i].in_use, 1) + 1;
+		if (in_use > pools[i].max_used)
+			pools[i].max_used = in_use;
+		return __fls(bit);
+	}
+
+	pools[i].full++;
+	return -1;
+}
+
+int shmem_pool_acquire(int size, char **dest_ptr)
+{
+	uint8_t *buf = pool_buf;
+	int i, block;
+
+	for (i = 0; i < POOL_COUNT; buf += pool_bytes(i), i++) {
+		if (size > pool_config[i].block_size)
+			continue;
+
+		block = claim_block(i);
+		if (block >= 0) {
+			*dest_ptr = (char *)buf +
+				    block * pool_config[i].block_size;
+			return EC_SUCCESS;
+		}
+	}
+
+	return EC_ERROR_BUSY;
+}
+
+int shmem_pool_release(void *ptr)
+{
+	uint8_t *p = ptr;
+	uint8_t *buf = pool_buf;
+	int i;
+
+	if (p < pool_buf || p >= pool_buf + sizeof(pool_buf))
+		return 0;
+
+	for (i = 0; i < POOL_COUNT; buf += pool_bytes(i), i++) {
+		if (p < buf + pool_bytes(i)) {
+			atomic_sub(&pools[i].in_use, 1);
+			atomic_clear_bits(&pools[i].used,
+				BIT((p - buf) / pool_config[i].block_size));
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void shmem_pool_print_stats(void)
+{
+	int i;
+
+	ccprintf("Pool  Block  Blocks  Used  Max  Full\n");
+	for (i = 0; i < POOL_COUNT; i++)
+		ccprintf("%4d %6d %7d %5d %4d %5d\n", i,
+			 pool_config[i].block_size, pool_config[i].blocks,
+			 (int)pools[i].in_use, pools[i].max_used,
+			 pools[i].full);
+}
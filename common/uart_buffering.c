@@ -28,6 +28,9 @@
 #define TX_BUF_DIFF(i, j) (((i) - (j)) & (CONFIG_UART_TX_BUF_SIZE - 1))
 #define RX_BUF_DIFF(i, j) (((i) - (j)) & (CONFIG_UART_RX_BUF_SIZE - 1))
 
+/* Most characters copied into the transmit buffer with interrupts locked */
+#define TX_STR_CHUNK 32
+
 /* Check if both UART TX/RX buffer sizes are power of two. */
 BUILD_ASSERT((CONFIG_UART_TX_BUF_SIZE & (CONFIG_UART_TX_BUF_SIZE - 1)) == 0);
 BUILD_ASSERT((CONFIG_UART_RX_BUF_SIZE & (CONFIG_UART_RX_BUF_SIZE - 1)) == 0);
@@ -76,6 +79,332 @@ void uart_init_buffer(void)
 	}
 }
 
+#ifndef CONFIG_POLLING_UART
+/*
+ * Copy a run of characters into the transmit buffer, as much as fits.
+ *
+ * Returns the number of characters copied.
+ */
+static int tx_buf_write(const char *str, int len)
+{
+	int head = tx_buf_head;
+	/* One slot always stays empty, as in uart_tx_char_raw() */
+	int room = TX_BUF_DIFF(tx_buf_tail - 1, head);
+	int n = MIN(len, room);
+	int first = MIN(n, CONFIG_UART_TX_BUF_SIZE - head);
+	int new_head = (head + n) & (CONFIG_UART_TX_BUF_SIZE - 1);
+
+	if (!n)
+		return 0;
+
+	/*
+	 * Same READ_RECENT bookkeeping as uart_tx_char_raw(), once for the
+	 * whole run: a snapshot head we write over ends up just ahead of the
+	 * new head.
+	 */
+	if (TX_BUF_DIFF(tx_last_snapshot_head, head) - 1 < n &&
+	    tx_last_snapshot_head != head &&
+	    tx_last_snapshot_head != tx_snapshot_head)
+		tx_last_snapshot_head = TX_BUF_NEXT(new_head);
+	if (TX_BUF_DIFF(tx_next_snapshot_head, head) - 1 < n &&
+	    tx_next_snapshot_head != head)
+		tx_next_snapshot_head = TX_BUF_NEXT(new_head);
+
+	memcpy((char *)tx_buf + head, str, first);
+	memcpy((char *)tx_buf, str + first, n - first);
+	tx_buf_head = new_head;
+
+	if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
+		tx_checksum = uart_buffer_calc_checksum();
+
+	return n;
+}
+#endif
+
+#ifdef CONFIG_UART_TX_TASK_RINGS
+#ifdef CONFIG_POLLING_UART
+#error "Per-task console rings need a buffered UART"
+#endif
+
+BUILD_ASSERT((CONFIG_UART_TX_TASK_RING_SIZE &
+	      (CONFIG_UART_TX_TASK_RING_SIZE - 1)) == 0);
+
+#define RING_MASK (CONFIG_UART_TX_TASK_RING_SIZE - 1)
+#define RING_DIFF(i, j) (((i) - (j)) & RING_MASK)
+
+/*
+ * How long a partly written line keeps its place in the transmit buffer
+ * before lines from other rings may go ahead of its remainder.  Covers a
+ * printf() that is preempted halfway through, without holding back a prompt
+ * that never gets its newline.
+ */
+#define LINE_HOLD_US (5 * MSEC)
+
+/*
+ * Each ring holds lines, each prefixed with the low 32 bits of the time the
+ * line was started.  head is only written by the ring's producer and tail
+ * only by uart_merge_task_rings(), so tasks need no locking; interrupts and
+ * code running before the scheduler share the last ring and take the IRQ
+ * lock instead.
+ */
+struct uart_task_ring {
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	/* Producer: the last line written has no newline yet */
+	uint8_t line_open;
+	/* Merge: the current line's timestamp has been consumed */
+	uint8_t in_line;
+	/* Merge: timestamp of the current line */
+	uint32_t line_start;
+	char buf[CONFIG_UART_TX_TASK_RING_SIZE];
+};
+
+#define SHARED_RING TASK_ID_COUNT
+
+static struct uart_task_ring task_rings[TASK_ID_COUNT + 1];
+
+static void uart_merge_task_rings(int keep);
+
+static int task_ring_index(void)
+{
+	task_id_t id;
+
+	if (in_interrupt_context() || !task_start_called())
+		return SHARED_RING;
+	id = task_get_current();
+	return id < TASK_ID_COUNT ? id : SHARED_RING;
+}
+
+static int task_ring_copy_in(struct uart_task_ring *r, int head,
+			     const void *src, int len)
+{
+	int first = MIN(len, CONFIG_UART_TX_TASK_RING_SIZE - head);
+
+	memcpy(r->buf + head, src, first);
+	memcpy(r->buf, (const char *)src + first, len - first);
+	return (head + len) & RING_MASK;
+}
+
+static int task_ring_copy_out(struct uart_task_ring *r, int tail,
+			      void *dest, int len)
+{
+	int first = MIN(len, CONFIG_UART_TX_TASK_RING_SIZE - tail);
+
+	memcpy(dest, r->buf + tail, first);
+	memcpy((char *)dest + first, r->buf, len - first);
+	return (tail + len) & RING_MASK;
+}
+
+/*
+ * Make room in a full ring by merging it into the transmit buffer right away,
+ * instead of waiting for the UART to drain.  Leaves a ring's worth of the
+ * transmit buffer free, so that a flooding task can't crowd the others out.
+ *
+ * Returns non-zero if that freed any room.
+ */
+static int task_ring_drain(struct uart_task_ring *r)
+{
+	int tail = r->tail;
+
+	uart_merge_task_rings(CONFIG_UART_TX_TASK_RING_SIZE);
+	return r->tail != tail;
+}
+
+static int task_ring_write(struct uart_task_ring *r, const char *str, int len)
+{
+	while (len > 0) {
+		const char *nl = memchr(str, '\n', len);
+		int run = nl ? nl - str + 1 : len;
+		int head = r->head;
+		int room = RING_DIFF(r->tail - 1, head);
+		int n;
+
+		if (!r->line_open) {
+			uint32_t now = get_time().le.lo;
+
+			if (room <= sizeof(now)) {
+				if (task_ring_drain(r))
+					continue;
+				return 1;
+			}
+			head = task_ring_copy_in(r, head, &now, sizeof(now));
+			room -= sizeof(now);
+			r->line_open = 1;
+		}
+
+		n = MIN(run, room);
+		r->head = task_ring_copy_in(r, head, str, n);
+		str += n;
+		len -= n;
+		if (n < run) {
+			/* Full partway through the line */
+			if (task_ring_drain(r))
+				continue;
+			return 1;
+		}
+
+		if (nl)
+			r->line_open = 0;
+	}
+	return 0;
+}
+
+static int task_ring_put(const char *str, int len)
+{
+	int i = task_ring_index();
+	uint32_t key;
+	int rv;
+
+	if (i != SHARED_RING)
+		return task_ring_write(task_rings + i, str, len);
+
+	key = irq_lock();
+	rv = task_ring_write(task_rings + i, str, len);
+	irq_unlock(key);
+	return rv;
+}
+
+static int task_rings_empty(void)
+{
+	int i;
+
+	for (i = 0; i <= SHARED_RING; i++) {
+		if (task_rings[i].head != task_rings[i].tail)
+			return 0;
+	}
+	return 1;
+}
+
+static void uart_kick_output(void)
+{
+	uart_tx_start();
+}
+DECLARE_DEFERRED(uart_kick_output);
+
+/*
+ * Pick the ring whose next line was started first, or -1 if all rings are
+ * empty.
+ */
+static int task_ring_oldest(int skip)
+{
+	uint32_t oldest = 0;
+	int best = -1;
+	int i;
+
+	for (i = 0; i <= SHARED_RING; i++) {
+		struct uart_task_ring *r = task_rings + i;
+		uint32_t start;
+
+		if (i == skip || r->head == r->tail)
+			continue;
+		if (r->in_line)
+			start = r->line_start;
+		else
+			task_ring_copy_out(r, r->tail, &start, sizeof(start));
+		if (best < 0 || (int32_t)(start - oldest) < 0) {
+			oldest = start;
+			best = i;
+		}
+	}
+	return best;
+}
+
+/**
+ * Move whole lines from the task rings into the transmit buffer.
+ *
+ * Lines go in the order they were started.  Once part of a line is in the
+ * transmit buffer, the rest of it goes next, so lines from different tasks
+ * are never interleaved, unless the writer leaves it unfinished for longer
+ * than LINE_HOLD_US.
+ *
+ * @param keep		Bytes of the transmit buffer to leave free
+ */
+static void uart_merge_task_rings(int keep)
+{
+	/* Ring whose current line is partly in the transmit buffer */
+	static int owner = -1;
+	uint32_t key = irq_lock();
+	char chunk[32];
+
+	while (1) {
+		struct uart_task_ring *r;
+		int avail, n, want, room, copied;
+		int32_t held;
+		char *nl;
+
+		if (owner < 0) {
+			owner = task_ring_oldest(-1);
+			if (owner < 0)
+				break;
+		}
+		r = task_rings + owner;
+
+		if (r->head != r->tail && !r->in_line) {
+			r->tail = task_ring_copy_out(r, r->tail, &r->line_start,
+						     sizeof(r->line_start));
+			r->in_line = 1;
+		}
+
+		/* Copy the rest of the line, as far as the producer got */
+		avail = RING_DIFF(r->head, r->tail);
+		n = MIN(avail, sizeof(chunk));
+		task_ring_copy_out(r, r->tail, chunk, n);
+		nl = memchr(chunk, '\n', n);
+		want = nl ? nl - chunk + 1 : n;
+		room = TX_BUF_DIFF(tx_buf_tail - 1, tx_buf_head) - keep;
+		copied = tx_buf_write(chunk, MIN(want, MAX(room, 0)));
+		r->tail = (r->tail + copied) & RING_MASK;
+
+		if (copied < want)
+			break;  /* Transmit buffer full */
+		if (nl) {
+			r->in_line = 0;
+			owner = -1;
+			continue;
+		}
+		if (n < avail)
+			continue;
+
+		/*
+		 * The producer is still writing this line.  Hold the transmit
+		 * buffer for it a little while, then let other rings go.
+		 */
+		held = get_time().le.lo - r->line_start;
+		if (held < LINE_HOLD_US) {
+			if (task_ring_oldest(owner) >= 0)
+				hook_call_deferred(&uart_kick_output_data,
+						   LINE_HOLD_US);
+			break;
+		}
+		owner = -1;
+	}
+
+	irq_unlock(key);
+}
+
+int uart_tx_char_raw(void *context, int c)
+{
+	char ch = c;
+
+	return task_ring_put(&ch, 1);
+}
+
+int uart_tx_str_raw(void *context, const char *str, int len)
+{
+	return task_ring_put(str, len);
+}
+
+#else /* !CONFIG_UART_TX_TASK_RINGS */
+
+static inline void uart_merge_task_rings(int keep)
+{
+}
+
+static inline int task_rings_empty(void)
+{
+	return 1;
+}
+
 int uart_tx_char_raw(void *context, int c)
 {
 	int tx_buf_next, tx_buf_new_tail;
@@ -114,6 +443,37 @@ int uart_tx_char_raw(void *context, int c)
 	return 0;
 }
 
+int uart_tx_str_raw(void *context, const char *str, int len)
+{
+#if defined CONFIG_POLLING_UART
+	while (len--)
+		uart_write_char(*str++);
+	return 0;
+#else
+	uint32_t key;
+	int n;
+
+	/*
+	 * A task and an interrupt may both print.  Copying a character at a
+	 * time left only a few instructions between reading and publishing
+	 * tx_buf_head; a run takes longer, so copy it in short chunks with
+	 * interrupts locked around each one.
+	 */
+	while (len > 0) {
+		key = irq_lock();
+		n = tx_buf_write(str, MIN(len, TX_STR_CHUNK));
+		irq_unlock(key);
+		if (!n)
+			return 1;
+		str += n;
+		len -= n;
+	}
+	return 0;
+#endif
+}
+
+#endif /* !CONFIG_UART_TX_TASK_RINGS */
+
 #ifdef CONFIG_UART_TX_DMA
 
 /**
@@ -123,12 +483,7 @@ void uart_process_output(void)
 {
 	/* Size of current DMA transfer */
 	static int tx_dma_in_progress;
-
-	/*
-	 * Get head pointer now, to avoid math problems if some other task
-	 * or interrupt adds output during this call.
-	 */
-	int head = tx_buf_head;
+	int head;
 
 	/* If DMA is still busy, nothing to do. */
 	if (!uart_tx_dma_ready())
@@ -144,6 +499,14 @@ void uart_process_output(void)
 			tx_checksum = uart_buffer_calc_checksum();
 	}
 
+	uart_merge_task_rings(0);
+
+	/*
+	 * Get head pointer now, to avoid math problems if some other task
+	 * or interrupt adds output during this call.
+	 */
+	head = tx_buf_head;
+
 	/* Disable DMA-done interrupt if nothing to send */
 	if (head == tx_buf_tail) {
 		uart_tx_stop();
@@ -164,8 +527,17 @@ void uart_process_output(void)
 
 void uart_process_output(void)
 {
+	/* Top up the transmit buffer from the task rings while it has room */
+	uart_merge_task_rings(0);
+
 	/* Copy output from buffer until TX fifo full or output buffer empty */
-	while (uart_tx_ready() && (tx_buf_head != tx_buf_tail)) {
+	while (uart_tx_ready()) {
+		if (tx_buf_head == tx_buf_tail) {
+			/* Task rings may hold more than fit the first time */
+			uart_merge_task_rings(0);
+			if (tx_buf_head == tx_buf_tail)
+				break;
+		}
 		uart_write_char(tx_buf[tx_buf_tail]);
 		tx_buf_tail = TX_BUF_NEXT(tx_buf_tail);
 
@@ -260,7 +632,7 @@ void uart_flush_output(void)
 		return;
 
 	/* Loop until buffer is empty */
-	while (tx_buf_head != tx_buf_tail) {
+	while (!uart_buffer_empty()) {
 		if (in_interrupt_context() || !is_interrupt_enabled()) {
 			/*
 			 * Explicitly process UART output, since the UART
@@ -302,12 +674,19 @@ int uart_getc(void)
 
 int uart_buffer_empty(void)
 {
-	return tx_buf_head == tx_buf_tail;
+	return tx_buf_head == tx_buf_tail && task_rings_empty();
 }
 
 int uart_buffer_full(void)
 {
+#ifdef CONFIG_UART_TX_TASK_RINGS
+	struct uart_task_ring *r = task_rings + task_ring_index();
+
+	/* Only the caller's own ring matters; the merge drains it */
+	return RING_DIFF(r->tail - 1, r->head) <= sizeof(uint32_t);
+#else
 	return TX_BUF_NEXT(tx_buf_head) == tx_buf_tail;
+#endif
 }
 
 #ifdef CONFIG_UART_RX_DMA
@@ -321,6 +700,9 @@ DECLARE_HOOK(HOOK_INIT, uart_rx_dma_init, HOOK_PRIO_DEFAULT);
 
 enum ec_status uart_console_read_buffer_init(void)
 {
+	/* Pick up whatever the tasks have finished writing */
+	uart_merge_task_rings(0);
+
 	/* Assume the whole circular buffer is full */
 	tx_snapshot_head = tx_buf_head;
 	tx_snapshot_tail = TX_BUF_NEXT(tx_snapshot_head);
@@ -8,6 +8,7 @@
 #include "common.h"
 #include "printf.h"
 #include "uart.h"
+#include "util.h"
 
 static int __tx_char(void *context, int c)
 {
@@ -19,6 +20,29 @@ static int __tx_char(void *context, int c)
 	return uart_tx_char_raw(context, c);
 }
 
+static int __tx_str(void *context, const char *str, int len)
+{
+	while (len > 0) {
+		int run = 0;
+
+		while (run < len && str[run] != '\n')
+			run++;
+		if (run && uart_tx_str_raw(context, str, run))
+			return 1;
+		if (run == len)
+			break;
+
+		/*
+		 * Translate '\n' to '\r\n'.
+		 */
+		if (uart_tx_str_raw(context, "\r\n", 2))
+			return 1;
+		str += run + 1;
+		len -= run + 1;
+	}
+	return 0;
+}
+
 int uart_putc(int c)
 {
 	int rv = __tx_char(NULL, c);
@@ -30,54 +54,50 @@ int uart_putc(int c)
 
 int uart_puts(const char *outstr)
 {
-	/* Put all characters in the output buffer */
-	while (*outstr) {
-		if (__tx_char(NULL, *outstr++) != 0)
-			break;
-	}
-
-	uart_tx_start();
-
-	/* Successful if we consumed all output */
-	return *outstr ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	return uart_put(outstr, strlen(outstr));
 }
 
 int uart_put(const char *out, int len)
 {
 	/* Put all characters in the output buffer */
-	while (len--) {
-		if (__tx_char(NULL, *out++) != 0)
-			break;
-	}
+	int rv = __tx_str(NULL, out, len);
 
 	uart_tx_start();
 
 	/* Successful if we consumed all output */
-	return len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	return rv ? EC_ERROR_OVERFLOW : EC_SUCCESS;
 }
 
 int uart_put_raw(const char *out, int len)
 {
 	/* Put all characters in the output buffer */
-	while (len--) {
-		if (uart_tx_char_raw(NULL, *out++) != 0)
-			break;
-	}
+	int rv = uart_tx_str_raw(NULL, out, len);
 
 	uart_tx_start();
 
 	/* Successful if we consumed all output */
-	return len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	return rv ? EC_ERROR_OVERFLOW : EC_SUCCESS;
 }
 
 int uart_vprintf(const char *format, va_list args)
 {
-	int rv = vfnprintf(__tx_char, NULL, format, args);
+	int rv = vfnprintf_span(__tx_char, __tx_str, NULL, format, args);
+
+	uart_tx_start();
+
+	return rv;
+}
+
+#ifdef CONFIG_CONSOLE_TOKENIZED
+int uart_vtokenize(int flags, const char *format, va_list args)
+{
+	int rv = vfntokenize(__tx_char, NULL, flags, format, args);
 
 	uart_tx_start();
 
 	return rv;
 }
+#endif
 
 int uart_printf(const char *format, ...)
 {
@@ -10,8 +10,10 @@
 #include "limits.h"
 #include "math_util.h"
 #include "system.h"
+#include "task.h"
 #include "usb_pd_timer.h"
 #include "usb_tc_sm.h"
+#include "util.h"
 
 #define MAX_PD_PORTS	CONFIG_USB_PD_PORT_MAX_COUNT
 #define MAX_PD_TIMERS	PD_TIMER_COUNT
@@ -58,6 +60,19 @@ static uint64_t timer_expires[MAX_PD_PORTS][MAX_PD_TIMERS];
 BUILD_ASSERT(sizeof(timer_active[0]) * CHAR_BIT >= PD_TIMER_COUNT);
 BUILD_ASSERT(sizeof(timer_disabled[0]) * CHAR_BIT >= PD_TIMER_COUNT);
 
+/*
+ * Active timers are also kept in a per-port binary min-heap ordered by
+ * expiration time, so the next timer to expire is always timer_heap[port][0].
+ * timer_heap_pos holds the heap slot of each active timer plus one, so
+ * zero means the timer is not queued.  Like the bit fields above, the heap
+ * may be reached from other tasks than the port's PD task, so it is only read
+ * or changed with interrupts locked.
+ */
+static uint8_t timer_heap[MAX_PD_PORTS][MAX_PD_TIMERS];
+static uint8_t timer_heap_pos[MAX_PD_PORTS][MAX_PD_TIMERS];
+static uint8_t timer_heap_count[MAX_PD_PORTS];
+BUILD_ASSERT(MAX_PD_TIMERS < UINT8_MAX);
+
 /*
  * CONFIG_CMD_PD_TIMER debug variables
  */
@@ -155,12 +170,103 @@ test_mockable_static void pd_timer_atomic_op(
 	}
 }
 
+static void timer_heap_set(int port, int pos, uint8_t timer)
+{
+	timer_heap[port][pos] = timer;
+	timer_heap_pos[port][timer] = pos + 1;
+}
+
+static void timer_heap_sift_up(int port, int pos)
+{
+	uint8_t timer = timer_heap[port][pos];
+	uint64_t expires = timer_expires[port][timer];
+
+	while (pos > 0) {
+		int parent = (pos - 1) / 2;
+		uint8_t p_timer = timer_heap[port][parent];
+
+		if (timer_expires[port][p_timer] <= expires)
+			break;
+		timer_heap_set(port, pos, p_timer);
+		pos = parent;
+	}
+	timer_heap_set(port, pos, timer);
+}
+
+static void timer_heap_sift_down(int port, int pos)
+{
+	int n = timer_heap_count[port];
+	uint8_t timer = timer_heap[port][pos];
+	uint64_t expires = timer_expires[port][timer];
+
+	for (;;) {
+		int child = 2 * pos + 1;
+		uint8_t c_timer;
+
+		if (child >= n)
+			break;
+		if (child + 1 < n &&
+		    timer_expires[port][timer_heap[port][child + 1]] <
+		    timer_expires[port][timer_heap[port][child]])
+			child++;
+		c_timer = timer_heap[port][child];
+		if (expires <= timer_expires[port][c_timer])
+			break;
+		timer_heap_set(port, pos, c_timer);
+		pos = child;
+	}
+	timer_heap_set(port, pos, timer);
+}
+
+/*
+ * Set a timer's expiry, and insert it into the heap or reposition it there
+ */
+static void timer_heap_update(int port, enum pd_task_timer timer,
+			      uint64_t expires)
+{
+	uint32_t key = irq_lock();
+	int pos = timer_heap_pos[port][timer] - 1;
+
+	timer_expires[port][timer] = expires;
+	if (pos < 0) {
+		pos = timer_heap_count[port]++;
+		timer_heap_set(port, pos, timer);
+		timer_heap_sift_up(port, pos);
+	} else {
+		timer_heap_sift_up(port, pos);
+		timer_heap_sift_down(port, timer_heap_pos[port][timer] - 1);
+	}
+	irq_unlock(key);
+}
+
+static void timer_heap_remove(int port, enum pd_task_timer timer)
+{
+	uint32_t key = irq_lock();
+	int pos = timer_heap_pos[port][timer] - 1;
+	uint8_t moved;
+
+	if (pos < 0)
+		goto unlock;
+
+	timer_heap_pos[port][timer] = 0;
+	moved = timer_heap[port][--timer_heap_count[port]];
+	if (moved == timer)
+		goto unlock;
+
+	timer_heap_set(port, pos, moved);
+	timer_heap_sift_up(port, pos);
+	timer_heap_sift_down(port, timer_heap_pos[port][moved] - 1);
+unlock:
+	irq_unlock(key);
+}
+
 static void pd_timer_inactive(int port, enum pd_task_timer timer)
 {
 	uint64_t mask = bitmask_uint64(timer);
 
 	if (PD_CHK_ACTIVE(port, mask)) {
 		PD_CLR_ACTIVE(port, mask);
+		timer_heap_remove(port, timer);
 
 		if (IS_ENABLED(CONFIG_CMD_PD_TIMER))
 			count[port]--;
@@ -187,9 +293,16 @@ static bool pd_timer_is_inactive(int port, enum pd_task_timer timer)
  */
 void pd_timer_init(int port)
 {
+	uint32_t key;
+
 	if (IS_ENABLED(CONFIG_CMD_PD_TIMER))
 		count[port] = 0;
 
+	key = irq_lock();
+	timer_heap_count[port] = 0;
+	memset(timer_heap_pos[port], 0, sizeof(timer_heap_pos[port]));
+	irq_unlock(key);
+
 	PD_CLR_ACTIVE(port, PD_TIMERS_ALL_MASK);
 	PD_SET_DISABLED(port, PD_TIMERS_ALL_MASK);
 }
@@ -208,7 +321,7 @@ void pd_timer_enable(int port, enum pd_task_timer timer, uint32_t expires_us)
 		}
 	}
 	PD_CLR_DISABLED(port, mask);
-	timer_expires[port][timer] = get_time().val + expires_us;
+	timer_heap_update(port, timer, get_time().val + expires_us);
 }
 
 void pd_timer_disable(int port, enum pd_task_timer timer)
@@ -217,6 +330,7 @@ void pd_timer_disable(int port, enum pd_task_timer timer)
 
 	if (PD_CHK_ACTIVE(port, mask)) {
 		PD_CLR_ACTIVE(port, mask);
+		timer_heap_remove(port, timer);
 
 		if (IS_ENABLED(CONFIG_CMD_PD_TIMER))
 			count[port]--;
@@ -271,42 +385,41 @@ bool pd_timer_is_expired(int port, enum pd_task_timer timer)
 
 void pd_timer_manage_expired(int port)
 {
-	int timer;
+	uint64_t now;
+	uint32_t key;
+
+	if (!timer_heap_count[port])
+		return;
 
-	if (timer_active[port])
-		for (timer = 0; timer < MAX_PD_TIMERS; ++timer)
-			if (pd_timer_is_active(port, timer) &&
-			    pd_timer_is_expired(port, timer))
-				pd_timer_inactive(port, timer);
+	/* Only the expired timers at the top of the heap need to be visited */
+	now = get_time().val;
+	key = irq_lock();
+	while (timer_heap_count[port] &&
+	       timer_expires[port][timer_heap[port][0]] <= now)
+		pd_timer_inactive(port, timer_heap[port][0]);
+	irq_unlock(key);
 }
 
 int pd_timer_next_expiration(int port)
 {
-	int timer;
-	int ret_value = MAX_EXPIRE;
-	uint64_t now = get_time().val;
-
-	for (timer = 0; timer < MAX_PD_TIMERS; ++timer) {
-		/* Only use active timers for the next expired value */
-		if (pd_timer_is_active(port, timer)) {
-			int delta;
-			uint64_t t_value = timer_expires[port][timer];
-
-			if (t_value <= now) {
-				ret_value = EXPIRE_NOW;
-				break;
-			}
-
-			delta = t_value - now;
-			if (ret_value > delta)
-				ret_value = delta;
-		}
+	uint64_t now;
+	uint64_t t_value;
+	uint32_t key;
+
+	/* Only active timers are in the heap; the earliest one is on top */
+	key = irq_lock();
+	if (!timer_heap_count[port]) {
+		irq_unlock(key);
+		return NO_TIMEOUT;
 	}
+	t_value = timer_expires[port][timer_heap[port][0]];
+	irq_unlock(key);
 
-	if (ret_value == MAX_EXPIRE)
-		ret_value = NO_TIMEOUT;
+	now = get_time().val;
+	if (t_value <= now)
+		return EXPIRE_NOW;
 
-	return ret_value;
+	return MIN(t_value - now, (uint64_t)MAX_EXPIRE);
 }
 
 #ifdef CONFIG_CMD_PD_TIMER
@@ -37,12 +37,30 @@ struct vboot_hash_tag {
 /* Check that CHUNK_SIZE fits in shared memory. */
 SHARED_MEM_CHECK_SIZE(CHUNK_SIZE);
 
+#if defined(CONFIG_FLASH_READ_ASYNC) && !defined(CONFIG_MAPPED_STORAGE)
+/*
+ * Flash reads run in the background into one half of the CHUNK_SIZE buffer
+ * while the other half is hashed. Each deferred call hashes PIPELINE_CHUNKS
+ * half-chunks so the cost of filling the pipeline is amortized.
+ */
+#define VBOOT_HASH_PIPELINED
+#define PIPELINE_CHUNK_SIZE (CHUNK_SIZE / 2)
+#define PIPELINE_CHUNKS 8
+#endif
+
+/* Completed RW hash is carried across sysjump to skip rehashing */
+#define VBOOT_HASH_SYSJUMP_TAG 0x5648 /* "VH" */
+#define VBOOT_HASH_HOOK_VERSION 1
+
 static uint32_t data_offset;
 static uint32_t data_size;
 static uint32_t curr_pos;
 static const uint8_t *hash;   /* Hash, or NULL if not valid */
 static int want_abort;
 static int in_progress;
+static int hash_has_nonce;
+/* Storage for a hash restored after sysjump */
+static uint8_t restored_hash[SHA256_DIGEST_SIZE];
 #define VBOOT_HASH_DEFERRED	true
 #define VBOOT_HASH_BLOCKING	false
 
@@ -105,6 +123,61 @@ static int read_and_hash_chunk(int offset, int size)
 	return rv;
 }
 
+#ifdef VBOOT_HASH_PIPELINED
+/**
+ * Hash up to <max_chunks> half-chunks, reading each from flash while the
+ * previous one is being hashed. Advances curr_pos past the hashed data.
+ *
+ * @return EC_SUCCESS, EC_ERROR_BUSY if the buffers are not available right
+ *	   now, or another error if the read failed.
+ */
+static int read_and_hash_pipelined(int max_chunks)
+{
+	char *buf;
+	int cur = 0;
+	int size, next_size;
+	int rv;
+
+	if (curr_pos >= data_size)
+		return EC_SUCCESS;
+
+	rv = shared_mem_acquire(CHUNK_SIZE, &buf);
+	if (rv != EC_SUCCESS)
+		return rv;
+
+	size = MIN(PIPELINE_CHUNK_SIZE, data_size - curr_pos);
+	rv = crec_flash_physical_read_async(data_offset + curr_pos, size, buf);
+
+	while (rv == EC_SUCCESS) {
+		rv = crec_flash_physical_read_wait();
+		if (rv != EC_SUCCESS)
+			break;
+		curr_pos += size;
+
+		/* Start fetching the next chunk before hashing this one */
+		next_size = 0;
+		if (--max_chunks > 0 && !want_abort)
+			next_size = MIN(PIPELINE_CHUNK_SIZE,
+					data_size - curr_pos);
+		if (next_size)
+			rv = crec_flash_physical_read_async(
+				data_offset + curr_pos, next_size,
+				buf + (cur ^ 1) * PIPELINE_CHUNK_SIZE);
+
+		SHA256_update(&ctx, (const uint8_t *)buf +
+				    cur * PIPELINE_CHUNK_SIZE, size);
+
+		if (!next_size)
+			break;
+		cur ^= 1;
+		size = next_size;
+	}
+
+	shared_mem_release(buf);
+	return rv;
+}
+#endif /* VBOOT_HASH_PIPELINED */
+
 #endif
 
 #ifdef CONFIG_CONSOLE_VERBOSE
@@ -129,11 +202,21 @@ static void hash_next_chunk(size_t size)
 
 static void vboot_hash_all_chunks(void)
 {
+#ifdef VBOOT_HASH_PIPELINED
+	/* There are never more chunks left than bytes */
+	if (read_and_hash_pipelined(data_size) != EC_SUCCESS) {
+		in_progress = 0;
+		clock_enable_module(MODULE_FAST_CPU, 0);
+		vboot_hash_abort();
+		return;
+	}
+#else
 	do {
 		size_t size = MIN(CHUNK_SIZE, data_size - curr_pos);
 		hash_next_chunk(size);
 		curr_pos += size;
 	} while (curr_pos < data_size);
+#endif
 
 	hash = SHA256_final(&ctx);
 	CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
@@ -148,7 +231,11 @@ static void vboot_hash_all_chunks(void)
  */
 static void vboot_hash_next_chunk(void)
 {
+#ifdef VBOOT_HASH_PIPELINED
+	int rv;
+#else
 	int size;
+#endif
 
 	/* Handle abort */
 	if (want_abort) {
@@ -158,11 +245,27 @@ static void vboot_hash_next_chunk(void)
 		return;
 	}
 
+#ifdef VBOOT_HASH_PIPELINED
+	/* Compute the next few chunks of hash */
+	rv = read_and_hash_pipelined(PIPELINE_CHUNKS);
+	if (rv == EC_ERROR_BUSY) {
+		/* Couldn't update hash right now; try again later */
+		hook_call_deferred(&vboot_hash_next_chunk_data,
+				   WORK_INTERVAL_US);
+		return;
+	} else if (rv != EC_SUCCESS) {
+		/* Come back to handle the abort */
+		vboot_hash_abort();
+		hook_call_deferred(&vboot_hash_next_chunk_data, 0);
+		return;
+	}
+#else
 	/* Compute the next chunk of hash */
 	size = MIN(CHUNK_SIZE, data_size - curr_pos);
 	hash_next_chunk(size);
 
 	curr_pos += size;
+#endif
 	if (curr_pos >= data_size) {
 		/* Store the final hash */
 		hash = SHA256_final(&ctx);
@@ -222,6 +325,7 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 	data_size = size;
 	curr_pos = 0;
 	hash = NULL;
+	hash_has_nonce = nonce_size > 0;
 	want_abort = 0;
 	in_progress = 1;
 
@@ -280,8 +384,70 @@ static uint32_t get_rw_size(void)
 #endif
 }
 
+/**
+ * Restore the hash of <size> bytes at <offset> saved by the previous image
+ * before it jumped to this one.
+ *
+ * @return 1 if a matching hash was restored, 0 if it must be recomputed.
+ */
+static int vboot_hash_restore_state(uint32_t offset, uint32_t size)
+{
+	const struct vboot_hash_tag *prev;
+	int version, tag_size;
+
+	/*
+	 * RO must not take a hash on trust from whatever image jumped to it:
+	 * a compromised RW could leave a forged hash of itself behind, which
+	 * RO would then report during software sync.  RW only picks up what
+	 * RO (or another RW, which it can't be less trusted than) computed.
+	 */
+	if (!system_is_in_rw())
+		return 0;
+
+	prev = (const struct vboot_hash_tag *)
+		system_get_jump_tag(VBOOT_HASH_SYSJUMP_TAG, &version,
+				    &tag_size);
+	if (!prev || version != VBOOT_HASH_HOOK_VERSION ||
+	    tag_size != sizeof(*prev) ||
+	    prev->offset != offset || prev->size != size)
+		return 0;
+
+	memcpy(restored_hash, prev->hash, sizeof(restored_hash));
+	data_offset = offset;
+	data_size = size;
+	hash_has_nonce = 0;
+	hash = restored_hash;
+	CPRINTS("hash restored %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
+	return 1;
+}
+
+static void vboot_hash_preserve_state(void)
+{
+	struct vboot_hash_tag tag;
+
+	/* Only a complete hash of plain flash contents is worth keeping */
+	if (!hash || in_progress || want_abort || hash_has_nonce)
+		return;
+
+	memcpy(tag.hash, hash, sizeof(tag.hash));
+	tag.offset = data_offset;
+	tag.size = data_size;
+	system_add_jump_tag(VBOOT_HASH_SYSJUMP_TAG, VBOOT_HASH_HOOK_VERSION,
+			    sizeof(tag), &tag);
+}
+DECLARE_HOOK(HOOK_SYSJUMP, vboot_hash_preserve_state, HOOK_PRIO_DEFAULT);
+
 static void vboot_hash_init(void)
 {
+	/*
+	 * Flash can't change across sysjump, so RW reuses the hash computed
+	 * before the jump.  RO always recomputes.
+	 */
+	if (vboot_hash_restore_state(
+		    flash_get_rw_offset(system_get_active_copy()),
+		    get_rw_size()))
+		return;
+
 #ifdef CONFIG_HOSTCMD_EVENTS
 	/*
 	 * Don't auto-start hash computation if we've asked the host to enter
@@ -306,6 +472,8 @@ int vboot_get_rw_hash(const uint8_t **dst)
 	int rv = vboot_hash_start(flash_get_rw_offset(system_get_active_copy()),
 				  get_rw_size(), NULL, 0, VBOOT_HASH_BLOCKING);
 	*dst = hash;
+	if (rv == EC_SUCCESS && !hash)
+		return EC_ERROR_UNKNOWN;
 	return rv;
 }
 
@@ -12,6 +12,7 @@
 #include "link_defs.h"
 #include "panic.h"
 #include "task.h"
+#include "task_mutex.h"
 #include "timer.h"
 #include "util.h"
 
@@ -25,6 +26,8 @@ typedef union {
 		atomic_t events;   /* Bitmaps of received events */
 		uint64_t runtime;  /* Time spent in task */
 		uint32_t *stack;   /* Start of stack */
+		uint32_t mutex_waits;     /* Times a mutex was contended */
+		uint32_t mutex_wait_us;   /* Time spent waiting for mutexes */
 	};
 } task_;
 
@@ -212,6 +215,14 @@ static atomic_t tasks_enabled = BIT(TASK_ID_HOOKS) | BIT(TASK_ID_IDLE);
 
 static int start_called;  /* Has task swapping started */
 
+/*
+ * Tasks waiting for a mutex.  Each lends its priority to the owner of the
+ * mutex (see mutex_next_task()), so the owner can't be held up by tasks of
+ * intermediate priority.
+ */
+static uint32_t tasks_blocked_on_mutex;
+static struct mutex *tasks_blocked_on[TASK_ID_COUNT];
+
 static inline task_ *__task_id_to_ptr(task_id_t id)
 {
 	return tasks + id;
@@ -326,7 +337,9 @@ void svc_handler(int desched, task_id_t resched)
 	tasks_ready |= 1 << resched;
 
 	ASSERT(tasks_ready & tasks_enabled);
-	next = __task_id_to_ptr(__fls(tasks_ready & tasks_enabled));
+	next = __task_id_to_ptr(mutex_next_task(tasks_ready & tasks_enabled,
+						tasks_blocked_on_mutex,
+						tasks_blocked_on));
 
 #ifdef CONFIG_TASK_PROFILING
 	/* Track time in interrupts */
@@ -584,6 +597,11 @@ static uint32_t init_task_context(task_id_t id)
 static void do_task_reset(task_id_t id)
 {
 	interrupt_disable();
+	/* Stop waiting for a mutex, if we were */
+	if (tasks_blocked_on_mutex & BIT(id)) {
+		atomic_clear_bits(&tasks_blocked_on[id]->waiters, BIT(id));
+		tasks_blocked_on_mutex &= ~BIT(id);
+	}
 	init_task_context(id);
 	tasks_ready |= 1 << id;
 	/* TODO: Clear all pending events? */
@@ -878,8 +896,10 @@ static void __nvic_init_irqs(void)
 
 void mutex_lock(struct mutex *mtx)
 {
-	uint32_t value;
-	uint32_t id;
+	task_ *tsk = current_task;
+	task_id_t id;
+	uint32_t start;
+	bool irqs;
 
 	/*
 	 * mutex_lock() must not be used in interrupt context (because we wait
@@ -895,54 +915,63 @@ void mutex_lock(struct mutex *mtx)
 	if (!task_start_called())
 		return;
 
-	id = 1 << task_get_current();
+	id = task_get_current();
 
-	atomic_or(&mtx->waiters, id);
+	/*
+	 * The lock field holds the owner, so that waiters can lend it their
+	 * priority. Checking and taking it with interrupts off is enough on a
+	 * single core. Callers may already have interrupts off, so leave them
+	 * as we found them.
+	 */
+	irqs = is_interrupt_enabled();
+	interrupt_disable();
+	if (!mtx->lock) {
+		mtx->lock = MUTEX_OWNER(id);
+		if (irqs)
+			interrupt_enable();
+		return;
+	}
 
-	do {
-		/* Try to get the lock (set 1 into the lock field) */
-		__asm__ __volatile__("   ldrex   %0, [%1]\n"
-				     "   teq     %0, #0\n"
-				     "   it eq\n"
-				     "   strexeq %0, %2, [%1]\n"
-				     : "=&r" (value)
-				     : "r" (&mtx->lock), "r" (2) : "cc");
-		/*
-		 * "value" is equals to 1 if the store conditional failed,
-		 * 2 if somebody else owns the mutex, 0 else.
-		 */
-		if (value == 2)
-			/* Contention on the mutex */
-			task_wait_event_mask(TASK_EVENT_MUTEX, 0);
-	} while (value);
+	/* Contention on the mutex: lend our priority to the owner */
+	mtx->waiters |= BIT(id);
+	tasks_blocked_on[id] = mtx;
+	tasks_blocked_on_mutex |= BIT(id);
+	if (irqs)
+		interrupt_enable();
+
+	tsk->mutex_waits++;
+	start = get_time().le.lo;
+
+	/* mutex_unlock() hands the mutex over to us directly */
+	while (mtx->lock != MUTEX_OWNER(id))
+		task_wait_event_mask(TASK_EVENT_MUTEX, 0);
 
-	atomic_clear_bits(&mtx->waiters, id);
+	/* Ensure no event is remaining from mutex hand-over */
+	atomic_clear_bits(&tsk->events, TASK_EVENT_MUTEX);
+	tsk->mutex_wait_us += get_time().le.lo - start;
 }
 
 void mutex_unlock(struct mutex *mtx)
 {
-	uint32_t waiters;
-	task_ *tsk = current_task;
+	task_id_t id;
+	bool irqs;
 
 	/*
-	 * Add a critical section to keep the unlock and the snapshotting of
-	 * waiters atomic in case a task switching occurs between them.
+	 * Hand the mutex over to the highest priority waiter only, rather than
+	 * waking them all to race for it. It stops lending us its priority
+	 * (and the other waiters lend theirs to it instead) as soon as the
+	 * owner changes.
 	 */
+	irqs = is_interrupt_enabled();
 	interrupt_disable();
-	waiters = mtx->waiters;
-	mtx->lock = 0;
-	interrupt_enable();
+	id = mutex_hand_over(mtx);
+	if (id != TASK_ID_INVALID)
+		tasks_blocked_on_mutex &= ~BIT(id);
+	if (irqs)
+		interrupt_enable();
 
-	while (waiters) {
-		task_id_t id = __fls(waiters);
-		waiters &= ~BIT(id);
-
-		/* Somebody is waiting on the mutex */
+	if (id != TASK_ID_INVALID)
 		task_set_event(id, TASK_EVENT_MUTEX);
-	}
-
-	/* Ensure no event is remaining from mutex wake-up */
-	atomic_clear_bits(&tsk->events, TASK_EVENT_MUTEX);
 }
 
 void task_print_list(void)
@@ -971,9 +1000,9 @@ void task_print_list(void)
 
 static int command_task_info(int argc, char **argv)
 {
+	int i;
 #ifdef CONFIG_TASK_PROFILING
 	int total = 0;
-	int i;
 #endif
 
 	task_print_list();
@@ -996,6 +1025,15 @@ static int command_task_info(int argc, char **argv)
 	ccprintf("Time in exceptions:     %11.6lld s\n", exc_total_time);
 #endif
 
+	ccputs("Mutex contention:\n");
+	for (i = 0; i < TASK_ID_COUNT; i++) {
+		if (!tasks[i].mutex_waits)
+			continue;
+		ccprintf("%4d %-16s %8u waits %11u us\n", i, task_names[i],
+			 tasks[i].mutex_waits, tasks[i].mutex_wait_us);
+		cflush();
+	}
+
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(taskinfo, command_task_info,
@@ -20,6 +20,7 @@
 #include "host_task.h"
 #include "task.h"
 #include "task_id.h"
+#include "task_mutex.h"
 #include "test_util.h"
 #include "timer.h"
 
@@ -54,6 +55,14 @@ static int generator_sleeping;
 static timestamp_t generator_sleep_deadline;
 static int has_interrupt_generator = 1;
 
+/*
+ * Tasks waiting for a mutex, which lend their priority to its owner the same
+ * way as on target (see mutex_next_task()).
+ */
+static uint32_t tasks_blocked_on_mutex;
+static struct mutex *tasks_blocked_on[TASK_ID_COUNT];
+BUILD_ASSERT(TASK_ID_COUNT <= sizeof(tasks_blocked_on_mutex) * 8);
+
 /* thread local task id */
 static __thread task_id_t my_task_id = TASK_ID_INVALID;
 
@@ -126,6 +135,13 @@ bool in_interrupt_context(void)
 
 test_mockable void interrupt_disable(void)
 {
+	/*
+	 * The thread that triggered the ISR holds interrupt_lock until it
+	 * returns, so nothing else can run; irq_lock() from an ISR is a no-op.
+	 */
+	if (in_interrupt)
+		return;
+
 	pthread_mutex_lock(&interrupt_lock);
 	interrupt_disabled = 1;
 	pthread_mutex_unlock(&interrupt_lock);
@@ -133,6 +149,9 @@ test_mockable void interrupt_disable(void)
 
 test_mockable void interrupt_enable(void)
 {
+	if (in_interrupt)
+		return;
+
 	pthread_mutex_lock(&interrupt_lock);
 	interrupt_disabled = 0;
 	pthread_mutex_unlock(&interrupt_lock);
@@ -263,35 +282,33 @@ uint32_t task_wait_event_mask(uint32_t event_mask, int timeout_us)
 
 void mutex_lock(struct mutex *mtx)
 {
-	int value = 0;
-	int id = 1 << task_get_current();
+	task_id_t id = task_get_current();
 
-	mtx->waiters |= id;
+	if (!mtx->lock) {
+		mtx->lock = MUTEX_OWNER(id);
+		return;
+	}
 
-	do {
-		if (mtx->lock == 0) {
-			mtx->lock = 1;
-			value = 1;
-		}
+	mtx->waiters |= BIT(id);
+	tasks_blocked_on[id] = mtx;
+	tasks_blocked_on_mutex |= BIT(id);
 
-		if (!value)
-			task_wait_event_mask(TASK_EVENT_MUTEX, 0);
-	} while (!value);
+	/* mutex_unlock() hands the mutex over to us directly */
+	while (mtx->lock != MUTEX_OWNER(id))
+		task_wait_event_mask(TASK_EVENT_MUTEX, 0);
 
-	mtx->waiters &= ~id;
+	atomic_clear_bits(&tasks[id].event, TASK_EVENT_MUTEX);
 }
 
 void mutex_unlock(struct mutex *mtx)
 {
-	int v;
-	mtx->lock = 0;
+	task_id_t id = mutex_hand_over(mtx);
 
-	for (v = 31; v >= 0; --v)
-		if ((1ul << v) & mtx->waiters) {
-			mtx->waiters &= ~(1ul << v);
-			task_set_event(v, TASK_EVENT_MUTEX);
-			break;
-		}
+	if (id == TASK_ID_INVALID)
+		return;
+
+	tasks_blocked_on_mutex &= ~BIT(id);
+	task_set_event(id, TASK_EVENT_MUTEX);
 }
 
 task_id_t task_get_current(void)
@@ -419,26 +436,30 @@ int task_start_called(void)
 void task_scheduler(void)
 {
 	int i;
+	uint32_t runnable;
 	timestamp_t now;
 
 	task_started = 1;
 
 	while (1) {
 		now = get_time();
-		i = TASK_ID_COUNT - 1;
-		while (i >= 0) {
+		runnable = 0;
+		for (i = 0; i < TASK_ID_COUNT; i++) {
 			/*
 			 * Only tasks with spawned threads are valid to be
 			 * resumed.
 			 */
-			if (tasks[i].thread) {
-				if (tasks[i].event ||
-				    now.val >= tasks[i].wake_time.val)
-					break;
-			}
-			--i;
+			if (tasks[i].thread &&
+			    (tasks[i].event ||
+			     now.val >= tasks[i].wake_time.val))
+				runnable |= BIT(i);
 		}
-		if (i < 0)
+
+		i = runnable ? mutex_next_task(runnable,
+					       tasks_blocked_on_mutex,
+					       tasks_blocked_on) :
+			       TASK_ID_IDLE;
+		if (!(runnable & BIT(i)))
 			i = fast_forward();
 
 		now = get_time();
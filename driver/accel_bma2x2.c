@@ -172,10 +172,33 @@ static int get_offset(const struct motion_sensor_t *s, int16_t *offset,
 	return EC_SUCCESS;
 }
 
+/*
+ * Convert acceleration to a signed 16-bit number. Note, based on
+ * the order of the registers:
+ *
+ * acc[0] = X_AXIS_LSB -> bit 7~4 for value, bit 0 for new data bit
+ * acc[1] = X_AXIS_MSB
+ * acc[2] = Y_AXIS_LSB -> bit 7~4 for value, bit 0 for new data bit
+ * acc[3] = Y_AXIS_MSB
+ * acc[4] = Z_AXIS_LSB -> bit 7~4 for value, bit 0 for new data bit
+ * acc[5] = Z_AXIS_MSB
+ *
+ * FIFO frames use the same layout.
+ */
+static void convert(const struct motion_sensor_t *s, const uint8_t *acc,
+		    intv3_t v)
+{
+	int i;
+
+	for (i = X; i <= Z; i++)
+		v[i] = (((int8_t)acc[i * 2 + 1]) << 8) | (acc[i * 2] & 0xf0);
+	rotate(v, *s->rot_standard_ref, v);
+}
+
 static int read(const struct motion_sensor_t *s, intv3_t v)
 {
 	uint8_t acc[6];
-	int ret, i;
+	int ret;
 
 	/* Read 6 bytes starting at X_AXIS_LSB. */
 	mutex_lock(s->mutex);
@@ -186,23 +209,43 @@ static int read(const struct motion_sensor_t *s, intv3_t v)
 	if (ret != EC_SUCCESS)
 		return ret;
 
-	/*
-	 * Convert acceleration to a signed 16-bit number. Note, based on
-	 * the order of the registers:
-	 *
-	 * acc[0] = X_AXIS_LSB -> bit 7~4 for value, bit 0 for new data bit
-	 * acc[1] = X_AXIS_MSB
-	 * acc[2] = Y_AXIS_LSB -> bit 7~4 for value, bit 0 for new data bit
-	 * acc[3] = Y_AXIS_MSB
-	 * acc[4] = Z_AXIS_LSB -> bit 7~4 for value, bit 0 for new data bit
-	 * acc[5] = Z_AXIS_MSB
-	 */
-	for (i = X; i <= Z; i++)
-		v[i] = (((int8_t)acc[i * 2 + 1]) << 8) | (acc[i * 2] & 0xf0);
-	rotate(v, *s->rot_standard_ref, v);
+	convert(s, acc, v);
+
+	return EC_SUCCESS;
+}
+
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+static int read_fifo(const struct motion_sensor_t *s, intv3_t *v, int max,
+		     int *count)
+{
+	uint8_t acc[BMA2x2_FIFO_DEPTH * BMA2x2_FIFO_FRAME_SIZE];
+	int ret, status, i;
+
+	mutex_lock(s->mutex);
+	ret = raw_read8(s->port, s->i2c_spi_addr_flags,
+			BMA2x2_STAT_FIFO_ADDR, &status);
+	if (ret != EC_SUCCESS)
+		goto unlock;
+
+	*count = MIN(status & BMA2x2_FIFO_FRAME_COUNT_MSK,
+		     MIN(max, BMA2x2_FIFO_DEPTH));
+	/* FIFO_DATA doesn't auto-increment: all frames in one read */
+	if (*count)
+		ret = i2c_read_block(s->port, s->i2c_spi_addr_flags,
+				     BMA2x2_FIFO_DATA_OUTPUT_ADDR, acc,
+				     *count * BMA2x2_FIFO_FRAME_SIZE);
+unlock:
+	mutex_unlock(s->mutex);
+
+	if (ret != EC_SUCCESS)
+		return ret;
+
+	for (i = 0; i < *count; i++)
+		convert(s, acc + i * BMA2x2_FIFO_FRAME_SIZE, v[i]);
 
 	return EC_SUCCESS;
 }
+#endif
 
 static int perform_calib(struct motion_sensor_t *s, int enable)
 {
@@ -317,6 +360,16 @@ static int init(struct motion_sensor_t *s)
 		}
 		msleep(1);
 	} while (1);
+
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+	/* Let the FIFO collect samples between reads, newest kept */
+	ret = raw_write8(s->port, s->i2c_spi_addr_flags,
+			 BMA2x2_FIFO_MODE_ADDR, BMA2x2_FIFO_MODE_STREAM);
+	if (ret != EC_SUCCESS) {
+		mutex_unlock(s->mutex);
+		return ret;
+	}
+#endif
 	mutex_unlock(s->mutex);
 
 	return sensor_init_done(s);
@@ -325,6 +378,9 @@ static int init(struct motion_sensor_t *s)
 const struct accelgyro_drv bma2x2_accel_drv = {
 	.init = init,
 	.read = read,
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+	.read_fifo = read_fifo,
+#endif
 	.set_range = set_range,
 	.get_resolution = get_resolution,
 	.set_data_rate = set_data_rate,
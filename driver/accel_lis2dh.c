@@ -110,6 +110,75 @@ unlock_rate:
 	return ret;
 }
 
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+/*
+ * Read up to max samples from the FIFO in one transaction; with the FIFO on,
+ * the register address wraps from OUT_Z_H back to OUT_X_L.
+ */
+static int read_fifo_raw(const struct motion_sensor_t *s, uint8_t *raw,
+			 int max, int *count)
+{
+	int ret, src;
+
+	ret = st_raw_read8(s->port, s->i2c_spi_addr_flags,
+			   LIS2DH_FIFO_SRC_REG, &src);
+	if (ret != EC_SUCCESS)
+		return ret;
+
+	/* FSS stops at 31; overrun means all 32 slots are full */
+	*count = (src & LIS2DH_FIFO_OVRN) ? LIS2DH_FIFO_DEPTH :
+		 (src & LIS2DH_FIFO_FSS_MASK);
+	*count = MIN(*count, max);
+	if (*count == 0)
+		return EC_SUCCESS;
+
+	ret = st_raw_read_n(s->port, s->i2c_spi_addr_flags,
+			    LIS2DH_OUT_X_L_ADDR, raw, *count * OUT_XYZ_SIZE);
+	if (ret != EC_SUCCESS)
+		CPRINTS("%s type:0x%X RD FIFO Error", s->name, s->type);
+
+	return ret;
+}
+
+static int read_fifo(const struct motion_sensor_t *s, intv3_t *v, int max,
+		     int *count)
+{
+	uint8_t raw[LIS2DH_FIFO_DEPTH * OUT_XYZ_SIZE];
+	int ret, i;
+
+	ret = read_fifo_raw(s, raw, MIN(max, LIS2DH_FIFO_DEPTH), count);
+	if (ret != EC_SUCCESS)
+		return ret;
+
+	/* Transform from LSB to real data with rotation and gain */
+	for (i = 0; i < *count; i++)
+		st_normalize(s, v[i], raw + i * OUT_XYZ_SIZE);
+
+	return EC_SUCCESS;
+}
+
+/* With the FIFO on, the output registers hold the oldest sample: skip ahead */
+static int read(const struct motion_sensor_t *s, intv3_t v)
+{
+	uint8_t raw[LIS2DH_FIFO_DEPTH * OUT_XYZ_SIZE];
+	int ret, count;
+
+	ret = read_fifo_raw(s, raw, LIS2DH_FIFO_DEPTH, &count);
+	if (ret != EC_SUCCESS)
+		return ret;
+
+	/* Nothing new: return the previous data */
+	if (count == 0) {
+		if (v != s->raw_xyz)
+			memcpy(v, s->raw_xyz, sizeof(s->raw_xyz));
+		return EC_SUCCESS;
+	}
+
+	st_normalize(s, v, raw + (count - 1) * OUT_XYZ_SIZE);
+
+	return EC_SUCCESS;
+}
+#else
 static int is_data_ready(const struct motion_sensor_t *s, int *ready)
 {
 	int ret, tmp;
@@ -159,6 +228,7 @@ static int read(const struct motion_sensor_t *s, intv3_t v)
 
 	return EC_SUCCESS;
 }
+#endif /* CONFIG_ACCEL_HW_FIFO_BATCH */
 
 static int init(struct motion_sensor_t *s)
 {
@@ -216,8 +286,19 @@ static int init(struct motion_sensor_t *s)
 	if (ret != EC_SUCCESS)
 		goto err_unlock;
 
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+	/* Let the FIFO collect samples between reads, newest kept */
+	ret = st_raw_write8(s->port, s->i2c_spi_addr_flags,
+			    LIS2DH_FIFO_CTRL_REG, LIS2DH_FIFO_MODE_STREAM);
+	if (ret != EC_SUCCESS)
+		goto err_unlock;
+
+	ret = st_raw_write8(s->port, s->i2c_spi_addr_flags,
+			    LIS2DH_CTRL5_ADDR, LIS2DH_CTRL5_FIFO_EN);
+#else
 	ret = st_raw_write8(s->port, s->i2c_spi_addr_flags,
 			    LIS2DH_CTRL5_ADDR, LIS2DH_CTRL5_RESET_VAL);
+#endif
 	if (ret != EC_SUCCESS)
 		goto err_unlock;
 
@@ -243,6 +324,9 @@ err_unlock:
 const struct accelgyro_drv lis2dh_drv = {
 	.init = init,
 	.read = read,
+#ifdef CONFIG_ACCEL_HW_FIFO_BATCH
+	.read_fifo = read_fifo,
+#endif
 	.set_range = set_range,
 	.get_resolution = st_get_resolution,
 	.set_data_rate = set_data_rate,
@@ -56,6 +56,7 @@
 
 #define LIS2DH_CTRL5_ADDR	0x24
 #define LIS2DH_CTRL5_RESET_VAL	0x00
+#define LIS2DH_CTRL5_FIFO_EN	0x40
 
 #define LIS2DH_CTRL6_ADDR	0x25
 #define LIS2DH_CTRL6_RESET_VAL	0x00
@@ -68,6 +69,17 @@
 #define LIS2DH_FS_8G_VAL         0x02
 #define LIS2DH_FS_16G_VAL        0x03
 
+/* FIFO registers */
+#define LIS2DH_FIFO_CTRL_REG	0x2e
+#define LIS2DH_FIFO_MODE_STREAM	0x80
+
+#define LIS2DH_FIFO_SRC_REG	0x2f
+#define LIS2DH_FIFO_OVRN	0x40
+#define LIS2DH_FIFO_FSS_MASK	0x1f
+
+/* Samples held by the FIFO */
+#define LIS2DH_FIFO_DEPTH	32
+
 /* Interrupt source status register */
 #define LIS2DH_INT1_SRC_REG	0x31
 
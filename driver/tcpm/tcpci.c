@@ -689,12 +689,6 @@ static int tcpm_alert_status(int port, int *alert)
 	return tcpc_read16(port, TCPC_REG_ALERT, alert);
 }
 
-static int tcpm_alert_ext_status(int port, int *alert_ext)
-{
-	/* Read TCPC Extended Alert register */
-	return tcpc_read(port, TCPC_REG_ALERT_EXT, alert_ext);
-}
-
 static int tcpm_ext_status(int port, int *ext_status)
 {
 	/* Read TCPC Extended Status register */
@@ -1048,26 +1042,19 @@ int tcpci_tcpm_transmit(int port, enum tcpci_msg_type type,
  */
 static int register_mask_reset(int port)
 {
-	int mask;
+	/* ALERT_MASK and POWER_STATUS_MASK are consecutive */
+	uint8_t mask[3] = { 0 };
 
-	mask = 0;
-	tcpc_read16(port, TCPC_REG_ALERT_MASK, &mask);
-	if (mask == TCPC_REG_ALERT_MASK_ALL)
+	tcpc_read_block(port, TCPC_REG_ALERT_MASK, mask, sizeof(mask));
+	if (UINT16_FROM_BYTE_ARRAY_LE(mask, 0) == TCPC_REG_ALERT_MASK_ALL)
 		return 1;
 
-	mask = 0;
-	tcpc_read(port, TCPC_REG_POWER_STATUS_MASK, &mask);
-	if (mask == TCPC_REG_POWER_STATUS_MASK_ALL)
+	if (mask[2] == TCPC_REG_POWER_STATUS_MASK_ALL)
 		return 1;
 
 	return 0;
 }
 
-static int tcpci_get_fault(int port, int *fault)
-{
-	return tcpc_read(port, TCPC_REG_FAULT_STATUS, fault);
-}
-
 static int tcpci_handle_fault(int port, int fault)
 {
 	int rv = EC_SUCCESS;
@@ -1116,39 +1103,45 @@ enum ec_error_list tcpci_set_bist_test_mode(const int port,
 	return rv;
 }
 
-static int tcpci_clear_fault(int port, int fault)
+static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
 {
-	int rv;
-
-	rv = tcpc_write(port, TCPC_REG_FAULT_STATUS, fault);
-	if (rv)
-		return rv;
+	int ext_status = 0;
+	int pwr_status = 0;
 
-	return tcpc_write16(port, TCPC_REG_ALERT, TCPC_REG_ALERT_FAULT);
-}
+	/* TCPCI Rev2 includes Safe0V detection */
+	if (!TCPC_FLAGS_VSAFE0V(tcpc_config[port].flags))
+		alert &= ~TCPC_REG_ALERT_EXT_STATUS;
 
-static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
-{
 	/*
-	 * Check for VBus change
+	 * POWER_STATUS, FAULT_STATUS and EXT_STATUS are consecutive, so read
+	 * them in one go when both status registers are needed.
 	 */
-	/* TCPCI Rev2 includes Safe0V detection */
-	if (TCPC_FLAGS_VSAFE0V(tcpc_config[port].flags) &&
+	if ((alert & TCPC_REG_ALERT_POWER_STATUS) &&
 	    (alert & TCPC_REG_ALERT_EXT_STATUS)) {
-		int ext_status = 0;
+		uint8_t status[3] = { 0 };
 
-		/* Determine if Safe0V was detected */
+		tcpc_read_block(port, TCPC_REG_POWER_STATUS, status,
+				sizeof(status));
+		pwr_status = status[0];
+		ext_status = status[2];
+	} else if (alert & TCPC_REG_ALERT_POWER_STATUS) {
+		tcpci_tcpm_get_power_status(port, &pwr_status);
+	} else if (alert & TCPC_REG_ALERT_EXT_STATUS) {
 		tcpm_ext_status(port, &ext_status);
+	}
+
+	/*
+	 * Check for VBus change
+	 */
+	if (alert & TCPC_REG_ALERT_EXT_STATUS) {
+		/* Determine if Safe0V was detected */
 		if (ext_status & TCPC_REG_EXT_STATUS_SAFE0V)
 			/* Safe0V=1 and Present=0 */
 			tcpc_vbus[port] = BIT(VBUS_SAFE0V);
 	}
 
 	if (alert & TCPC_REG_ALERT_POWER_STATUS) {
-		int pwr_status = 0;
-
 		/* Determine reason for power status change */
-		tcpci_tcpm_get_power_status(port, &pwr_status);
 		if (pwr_status & TCPC_REG_POWER_STATUS_VBUS_PRES)
 			/* Safe0V=0 and Present=1 */
 			tcpc_vbus[port] = BIT(VBUS_PRESENT);
@@ -1183,33 +1176,110 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
  */
 #define MAX_ALLOW_FAILED_RX_READS 10
 
-void tcpci_tcpc_alert(int port)
+/* Offset of a register in the block read by tcpci_read_alert_regs() */
+#define ALERT_REG(reg) ((reg) - TCPC_REG_ALERT)
+#define ALERT_REGS_SIZE (ALERT_REG(TCPC_REG_ALERT_EXT) + 1)
+
+/*
+ * Read ALERT, going on through FAULT_STATUS and ALERT_EXT in the same
+ * transaction if ALERT says they are needed.
+ */
+static int tcpci_read_alert_regs(int port, uint8_t *regs)
 {
-	int alert = 0;
+	int rv, alert, size;
+	int reg = TCPC_REG_ALERT;
+
+	/* Waking the TCPC needs the bus, so do it before taking the lock */
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC_LOW_POWER))
+		pd_wait_exit_low_power(port);
+
+	tcpc_lock(port, 1);
+	rv = tcpc_xfer_unlocked(port, (uint8_t *)&reg, 1, regs,
+				ALERT_REG(TCPC_REG_ALERT_MASK), I2C_XFER_START);
+	if (rv)
+		goto unlock;
+
+	/* The transaction has to end with a read, so take ALERT_MASK at least */
+	alert = UINT16_FROM_BYTE_ARRAY_LE(regs, ALERT_REG(TCPC_REG_ALERT));
+	if (alert & TCPC_REG_ALERT_ALERT_EXT)
+		size = TCPC_REG_ALERT_EXT - TCPC_REG_ALERT_MASK + 1;
+	else if (alert & TCPC_REG_ALERT_FAULT)
+		size = TCPC_REG_FAULT_STATUS - TCPC_REG_ALERT_MASK + 1;
+	else
+		size = TCPC_REG_POWER_STATUS_MASK - TCPC_REG_ALERT_MASK;
+
+	rv = tcpc_xfer_unlocked(port, NULL, 0,
+				regs + ALERT_REG(TCPC_REG_ALERT_MASK),
+				size, I2C_XFER_STOP);
+unlock:
+	tcpc_lock(port, 0);
+	return rv;
+}
+
+/*
+ * Write back the alert clears while holding the bus once.  FAULT_STATUS and
+ * ALERT_EXT go first because they hold up the matching bits of ALERT.
+ */
+static int tcpci_clear_alerts(int port, int fault, int alert_ext, int alert)
+{
+	uint8_t buf[3];
+	int rv = EC_SUCCESS;
+
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC_LOW_POWER))
+		pd_wait_exit_low_power(port);
+
+	tcpc_lock(port, 1);
+	if (fault) {
+		buf[0] = TCPC_REG_FAULT_STATUS;
+		buf[1] = fault;
+		rv |= tcpc_xfer_unlocked(port, buf, 2, NULL, 0,
+					 I2C_XFER_SINGLE);
+	}
+	if (alert_ext) {
+		buf[0] = TCPC_REG_ALERT_EXT;
+		buf[1] = alert_ext;
+		rv |= tcpc_xfer_unlocked(port, buf, 2, NULL, 0,
+					 I2C_XFER_SINGLE);
+	}
+	if (alert) {
+		buf[0] = TCPC_REG_ALERT;
+		buf[1] = alert & 0xff;
+		buf[2] = alert >> 8;
+		rv |= tcpc_xfer_unlocked(port, buf, 3, NULL, 0,
+					 I2C_XFER_SINGLE);
+	}
+	tcpc_lock(port, 0);
+
+	return rv;
+}
+
+static void tcpci_handle_alert(int port)
+{
+	uint8_t regs[ALERT_REGS_SIZE] = { 0 };
+	int alert;
 	int alert_ext = 0;
+	int fault = 0;
+	int fault_handled = 0;
 	int failed_attempts;
 	uint32_t pd_event = 0;
 	int retval = 0;
 
-	/* Read the Alert register from the TCPC */
-	if (tcpm_alert_status(port, &alert)) {
+	/* Read the Alert register and its neighbours from the TCPC */
+	if (tcpci_read_alert_regs(port, regs)) {
 		CPRINTS("C%d: Failed to read alert register", port);
 		return;
 	}
+	alert = UINT16_FROM_BYTE_ARRAY_LE(regs, ALERT_REG(TCPC_REG_ALERT));
 
-	/* Get Extended Alert register if needed */
+	/* Extended Alert register is only read if needed */
 	if (alert & TCPC_REG_ALERT_ALERT_EXT)
-		tcpm_alert_ext_status(port, &alert_ext);
+		alert_ext = regs[ALERT_REG(TCPC_REG_ALERT_EXT)];
 
-	/* Clear any pending faults */
+	/* Handle any pending faults, they are cleared with the alerts */
 	if (alert & TCPC_REG_ALERT_FAULT) {
-		int fault;
-
-		if (tcpci_get_fault(port, &fault) == EC_SUCCESS &&
-		    fault != 0 &&
-		    tcpci_handle_fault(port, fault) == EC_SUCCESS &&
-		    tcpci_clear_fault(port, fault) == EC_SUCCESS)
-			CPRINTS("C%d FAULT 0x%02X handled", port, fault);
+		fault = regs[ALERT_REG(TCPC_REG_FAULT_STATUS)];
+		fault_handled = fault != 0 &&
+				tcpci_handle_fault(port, fault) == EC_SUCCESS;
 	}
 
 	/*
@@ -1259,13 +1329,13 @@ void tcpci_tcpc_alert(int port)
 	}
 
 	/*
-	 * Clear all pending alert bits. Ext first because ALERT.AlertExtended
-	 * is set if any bit of ALERT_EXTENDED is set.
+	 * Clear the handled fault and all pending alert bits. Ext before ALERT
+	 * because ALERT.AlertExtended is set if any bit of ALERT_EXTENDED is
+	 * set.
 	 */
-	if (alert_ext)
-		tcpc_write(port, TCPC_REG_ALERT_EXT, alert_ext);
-	if (alert)
-		tcpc_write16(port, TCPC_REG_ALERT, alert);
+	if (tcpci_clear_alerts(port, fault_handled ? fault : 0, alert_ext,
+			       alert) == EC_SUCCESS && fault_handled)
+		CPRINTS("C%d FAULT 0x%02X handled", port, fault);
 
 	if (alert & TCPC_REG_ALERT_CC_STATUS) {
 		if (IS_ENABLED(CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE)) {
@@ -1315,7 +1385,8 @@ void tcpci_tcpc_alert(int port)
 
 	/*
 	 * Check registers to see if we can tell that the TCPC has reset. If
-	 * so, perform a tcpc_init.
+	 * so, perform a tcpc_init.  Read them now rather than with ALERT, so a
+	 * reset while the alert was handled is seen too.
 	 */
 	if (register_mask_reset(port))
 		pd_event |= PD_EVENT_TCPC_RESET;
@@ -1331,6 +1402,71 @@ void tcpci_tcpc_alert(int port)
 		task_set_event(PD_PORT_TO_TASK_ID(port), pd_event);
 }
 
+#ifdef CONFIG_USB_PD_TCPC_ALERT_STATS
+/* I2C transactions used to handle alerts, per port */
+static struct {
+	uint32_t alerts;
+	uint32_t xfers;
+	uint16_t max;
+	uint16_t last;
+} alert_stats[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+static void record_alert_stats(int port, uint32_t xfers)
+{
+	alert_stats[port].alerts++;
+	alert_stats[port].xfers += xfers;
+	alert_stats[port].last = xfers;
+	if (xfers > alert_stats[port].max)
+		alert_stats[port].max = xfers;
+}
+
+int tcpci_get_last_alert_xfers(int port)
+{
+	return alert_stats[port].last;
+}
+
+static int command_tcpc_alerts(int argc, char **argv)
+{
+	int port;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(alert_stats, 0, sizeof(alert_stats));
+		return EC_SUCCESS;
+	}
+
+	ccprintf("Port     Alerts      Xfers  Avg  Max  Last\n");
+	for (port = 0; port < board_get_usb_pd_port_count(); port++)
+		ccprintf("C%d %12u %10u %4u %4u %5u\n", port,
+			 alert_stats[port].alerts, alert_stats[port].xfers,
+			 alert_stats[port].alerts ? alert_stats[port].xfers /
+				alert_stats[port].alerts : 0,
+			 alert_stats[port].max, alert_stats[port].last);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(tcpcalerts, command_tcpc_alerts, "[clear]",
+			"Print or clear I2C transactions per TCPC alert");
+#else
+static inline void record_alert_stats(int port, uint32_t xfers)
+{
+}
+#endif /* CONFIG_USB_PD_TCPC_ALERT_STATS */
+
+void tcpci_tcpc_alert(int port)
+{
+	uint32_t xfers = 0;
+
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC_ALERT_STATS))
+		xfers = i2c_task_xfer_count();
+
+	tcpci_handle_alert(port);
+
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC_ALERT_STATS))
+		record_alert_stats(port, i2c_task_xfer_count() - xfers);
+}
+
 /*
  * This call will wake up the TCPC if it is in low power mode upon accessing the
  * i2c bus (but the pd state machine should put it back into low power mode).
@@ -37,6 +37,19 @@ struct accelgyro_drv {
 	 */
 	int (*read)(const struct motion_sensor_t *s, intv3_t v);
 
+	/**
+	 * Read the samples queued in the sensor's hardware FIFO, oldest
+	 * first, in one bus transaction. Only used with
+	 * CONFIG_ACCEL_HW_FIFO_BATCH; can be NULL.
+	 * @s Pointer to sensor data.
+	 * @v Array to store the samples (in units of counts).
+	 * @max Number of vectors in v.
+	 * @count Number of samples stored in v.
+	 * @return EC_SUCCESS if successful, non-zero if error.
+	 */
+	int (*read_fifo)(const struct motion_sensor_t *s, intv3_t *v, int max,
+			 int *count);
+
 	/**
 	 * Read the sensor's current internal temperature.
 	 *
@@ -68,6 +68,15 @@
  */
 #undef CONFIG_ACCEL_FORCE_MODE_MASK
 
+/*
+ * Forced mode sensors whose driver implements read_fifo() keep their
+ * hardware FIFO on, and the motion sense task lets up to this many samples
+ * collect there (within the latency the AP asked for) before draining them in
+ * one bus transaction.  Keep it at most half the hardware FIFO depth so
+ * scheduling jitter doesn't overrun the FIFO.  Requires CONFIG_ACCEL_FIFO.
+ */
+#undef CONFIG_ACCEL_HW_FIFO_BATCH
+
 /* Enable accelerometer interrupts. */
 #undef CONFIG_ACCEL_INTERRUPTS
 
@@ -1561,6 +1570,7 @@
 #undef  CONFIG_CMD_CLOCKGATES
 #undef  CONFIG_CMD_COMXTEST
 #define CONFIG_CMD_CRASH
+#undef  CONFIG_CMD_DEFERRED
 #define CONFIG_CMD_DEVICE_EVENT
 #undef  CONFIG_CMD_DLOG
 #undef  CONFIG_CMD_ECTEMP
@@ -1777,6 +1787,14 @@
 /* Enable verbose output to UART console and extra timestamp print precision. */
 #define CONFIG_CONSOLE_VERBOSE
 
+/*
+ * Send cprints() output to the UART as tokens (format string address plus
+ * raw arguments) instead of formatted text.  Much cheaper per line, but the
+ * console log must be decoded on the host with util/ec_detokenize.py and
+ * the EC's ELF files.  See vfntokenize() in printf.h.
+ */
+#undef CONFIG_CONSOLE_TOKENIZED
+
 /*****************************************************************************/
 /* Support for EC-EC communication */
 
@@ -1992,6 +2010,13 @@
 #undef CONFIG_FLASH_ERASE_SIZE
 /* Allow deferred (async) flash erase */
 #undef CONFIG_FLASH_DEFERRED_ERASE
+/*
+ * Chip can read flash in the background with
+ * crec_flash_physical_read_async(). Used to overlap flash reads with hashing
+ * when storage is not memory mapped.  MEC172x boards may define it to read
+ * with QMSPI RX DMA, once validated on their hardware.
+ */
+#undef CONFIG_FLASH_READ_ASYNC
 /* Flash must be selected for write/erase operations to succeed. */
 #undef CONFIG_FLASH_SELECT_REQUIRED
 
@@ -2378,6 +2403,45 @@
  */
 #undef CONFIG_HOSTCMD_SECTION_SORTED
 
+/*
+ * Look up host command handlers through a direct-index table built once from
+ * the .rodata.hcmds section at init, so dispatch is O(1) whether or not the
+ * section is sorted.  Automatically enabled for LPC/eSPI hosts below.
+ *
+ * CONFIG_HOSTCMD_DISPATCH_TABLE_SIZE is the number of one-byte slots in the
+ * table.  Each 256-command page with handlers uses one slot per command from
+ * its lowest to its highest handler; pages which don't fit are searched.
+ */
+#undef CONFIG_HOSTCMD_DISPATCH_TABLE
+#define CONFIG_HOSTCMD_DISPATCH_TABLE_SIZE 512
+
+/*
+ * Support EC_CMD_BATCH, which runs several host commands from a single
+ * request packet.  Automatically enabled for LPC/eSPI hosts below.
+ */
+#undef CONFIG_HOSTCMD_BATCH
+
+/*
+ * Support EC_CMD_FLASH_BLOCK_HASH, which returns a digest per flash block so
+ * the host can rewrite only the blocks that changed.  Each command hashes up
+ * to 128 KiB of flash on the host command task.
+ */
+#undef CONFIG_HOSTCMD_FLASH_BLOCK_HASH
+
+/*
+ * Support EC_CMD_FLASH_READ_BULK, which copies flash into a host-visible
+ * window so the host can read large regions without a host command per
+ * packet.  The chip overrides lpc_get_bulk_window() to provide the window;
+ * without one the command returns EC_RES_UNAVAILABLE.  On Microchip chips
+ * the window follows the memory-mapped data in EMI0 and costs
+ * CONFIG_HOSTCMD_FLASH_READ_BULK_SIZE bytes of RAM, so boards that have
+ * the room define this themselves.
+ */
+#undef CONFIG_HOSTCMD_FLASH_READ_BULK
+
+/* Size of the bulk window in bytes, if CONFIG_HOSTCMD_FLASH_READ_BULK */
+#define CONFIG_HOSTCMD_FLASH_READ_BULK_SIZE 4096
+
 /*
  * Host command parameters and response are 32-bit aligned.  This generates
  * much more efficient code on ARM.
@@ -2510,6 +2574,14 @@
 /* Enable the software routine for CRC computation */
 #undef CONFIG_SW_CRC
 
+/*
+ * Fold 4 or 8 bytes per iteration in the software CRC-32 routine using
+ * slicing tables. Costs 3 KiB (slice-by-4) or 7 KiB (slice-by-8) of extra
+ * read-only data on top of the 1 KiB byte table.
+ */
+#undef CONFIG_SW_CRC32_SLICE_BY_4
+#undef CONFIG_SW_CRC32_SLICE_BY_8
+
 /*****************************************************************************/
 
 /* Enable system hibernate */
@@ -2585,6 +2657,16 @@
 #undef CONFIG_I2C
 #undef CONFIG_I2C_DEBUG
 #undef CONFIG_I2C_DEBUG_PASSTHRU
+
+/*
+ * Record traced I2C transfers in a binary ring instead of printing them, so
+ * tracing doesn't change the bus timing.  The ring is drained with
+ * EC_CMD_I2C_TRACE ("ectool i2ctrace").  Requires CONFIG_I2C_DEBUG.
+ */
+#undef CONFIG_I2C_TRACE_BINARY
+
+/* Size of the binary I2C trace ring in bytes; must be a power of two */
+#define CONFIG_I2C_TRACE_BUFFER_SIZE 1024
 #undef CONFIG_I2C_PASSTHRU_RESTRICTED
 #undef CONFIG_I2C_VIRTUAL_BATTERY
 
@@ -2617,6 +2699,18 @@
  */
 #undef CONFIG_I2C_XFER_BOARD_CALLBACK
 
+/*
+ * Enable i2c_submit(), which queues batches of I2C transfers to run on the
+ * hook task and signals completion with a callback or task event.
+ */
+#undef CONFIG_I2C_XFER_QUEUE
+
+/*
+ * Count the I2C transactions started by each task, see
+ * i2c_task_xfer_count().
+ */
+#undef CONFIG_I2C_XFER_TASK_COUNT
+
 /*
  * EC uses an I2C controller interface.
  * Note: if this is defined, i2c_init() will be called
@@ -2889,6 +2983,13 @@
 /* Compile code for 8042 keyboard protocol */
 #undef CONFIG_KEYBOARD_PROTOCOL_8042
 
+/*
+ * Time each scanned keypress on its way to the host through the 8042
+ * interface, and report per-stage percentiles via EC_CMD_KEYBOARD_LATENCY and
+ * the kblatency console command.  Needs CONFIG_KEYBOARD_PROTOCOL_8042.
+ */
+#undef CONFIG_KEYBOARD_LATENCY_STATS
+
 /*
  * Enable code for chromeos vivaldi keyboard (standard for new chromeos devices)
  * This config only takes effect if CONFIG_KEYBOARD_PROTOCOL_8042 is selected. A
@@ -2928,6 +3029,13 @@
 /*  Print keyboard scan time intervals. */
 #undef CONFIG_KEYBOARD_PRINT_SCAN_TIMES
 
+/*
+ * Sleep on the system timer while each column settles during a scan, instead
+ * of spinning in udelay().  Lets other tasks run for most of each scan, at
+ * the cost of a context switch per column.
+ */
+#undef CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE
+
 /*
  * Support for extra runtime key combinations (e.g. alt+volup+h/r for hibernate
  * and warm reboot, respectively).
@@ -3311,6 +3419,15 @@
 #undef CONFIG_MCHP_I2C2_SLAVE_ADDRS
 #undef CONFIG_MCHP_I2C3_SLAVE_ADDRS
 
+/*
+ * Microchip I2C controller transfers (START to STOP) of at least this many
+ * bytes are moved by DMA through the controller network layer, with the task
+ * sleeping until done instead of polling every byte. MEC152x and MEC172x
+ * only; boards define it (e.g. to 8) once DMA transfers are validated on
+ * their hardware.
+ */
+#undef CONFIG_MCHP_I2C_DMA_THRESHOLD
+
 /* Microchip EC SRAM start address */
 #undef CONFIG_MEC_SRAM_BASE_START
 
@@ -3537,6 +3654,17 @@
  */
 #undef CONFIG_POWER_SIGNAL_INTERRUPT_STORM_DETECT_THRESHOLD
 
+/*
+ * Record every power signal edge and power state change, with its hardware
+ * timer time, in a ring read with EC_CMD_POWER_TIMELINE or the
+ * "powertimeline" console command.  Shows where the EC spends its time in
+ * suspend and resume.
+ */
+#undef CONFIG_POWER_TIMELINE
+
+/* Entries in the power timeline ring; must be a power of two. */
+#define CONFIG_POWER_TIMELINE_SIZE 64
+
 /* Use part of the EC's data EEPROM to hold persistent storage for the AP. */
 #undef CONFIG_PSTORE
 
@@ -3754,6 +3882,22 @@
 /* Unroll some loops in SHA256_transform for better performance. */
 #undef CONFIG_SHA256_UNROLLED
 
+/*
+ * Serve shared_mem_acquire() from fixed size block pools first, so common
+ * requests take O(1) time and don't wait for one another.  Requests larger
+ * than any block, or finding every fitting pool full, fall back to the shared
+ * memory buffer (or the CONFIG_MALLOC heap).
+ */
+#undef CONFIG_SHMEM_POOLS
+
+/*
+ * Pools used with CONFIG_SHMEM_POOLS, smallest blocks first, as a list of
+ * SHMEM_POOL(block_size, blocks) entries.  Block sizes must be multiples of 8,
+ * and a pool has at most 32 blocks.  The default suits host command buffers
+ * and flash chunks; boards add a pool for, e.g., fingerprint frames.
+ */
+#undef CONFIG_SHMEM_POOL_LIST
+
 /* Emulate the CLZ (Count Leading Zeros) in software for CPU lacking support */
 #undef CONFIG_SOFTWARE_CLZ
 
@@ -4250,6 +4394,22 @@
  */
 #define CONFIG_UART_TX_BUF_SIZE 512
 
+/*
+ * Give each task (plus one shared ring for interrupts and pre-scheduler code)
+ * its own small console ring, so that tasks never contend on the transmit
+ * buffer and a chatty task only overflows its own ring.  Whole lines are
+ * merged into the transmit buffer in the order they were started, when the
+ * UART drains, when the host reads the console, and when a ring fills up
+ * (leaving a ring's worth of the transmit buffer to the other tasks).
+ */
+#undef CONFIG_UART_TX_TASK_RINGS
+
+/*
+ * Size of each per-task console ring in bytes, including a 4-byte timestamp
+ * per line.  Must be a power of 2.
+ */
+#define CONFIG_UART_TX_TASK_RING_SIZE 128
+
 /* Use DMA for UART output */
 #undef CONFIG_UART_TX_DMA
 
@@ -4554,6 +4714,12 @@
 /* Enable TCPC to enter low power mode */
 #undef CONFIG_USB_PD_TCPC_LOW_POWER
 
+/*
+ * Keep per-port statistics of the I2C transactions used to handle each TCPCI
+ * alert, shown by the tcpcalerts console command.
+ */
+#undef CONFIG_USB_PD_TCPC_ALERT_STATS
+
 /*
  * Default debounce when exiting low-power mode before checking CC status.
  * Some TCPCs need additional time following a VBUS change to internally
@@ -5706,6 +5872,15 @@
 #error Must select only one type of host communication bus.
 #endif
 
+/*
+ * x86 hosts poll the EC heavily, so give them O(1) host command dispatch and
+ * batched commands.
+ */
+#ifdef CONFIG_HOSTCMD_X86
+#define CONFIG_HOSTCMD_DISPATCH_TABLE
+#define CONFIG_HOSTCMD_BATCH
+#endif
+
 #if defined(CONFIG_HOSTCMD_X86) && \
 	!defined(CONFIG_HOST_INTERFACE_LPC) && \
 	!defined(CONFIG_HOST_INTERFACE_ESPI)
@@ -5784,6 +5959,10 @@
 #endif
 #endif /* !CONFIG_SHAREDMEM_MINIMUM_SIZE */
 
+#if defined(CONFIG_SHMEM_POOLS) && !defined(CONFIG_SHMEM_POOL_LIST)
+#define CONFIG_SHMEM_POOL_LIST SHMEM_POOL(256, 4) SHMEM_POOL(1024, 2)
+#endif
+
 
 /******************************************************************************/
 /*
@@ -6346,6 +6525,11 @@
 #include "fuzz_config.h"
 #include "test_config.h"
 
+/* TCPCI alert statistics are counted in I2C transactions */
+#ifdef CONFIG_USB_PD_TCPC_ALERT_STATS
+#define CONFIG_I2C_XFER_TASK_COUNT
+#endif
+
 /*
  * Validity checks to make sure some of the configs above make sense.
  */
@@ -6627,6 +6811,10 @@
 #define CONFIG_ACCEL_FIFO_SIZE 0
 #endif
 
+#if defined(CONFIG_ACCEL_HW_FIFO_BATCH) && !defined(CONFIG_ACCEL_FIFO)
+#error "CONFIG_ACCEL_HW_FIFO_BATCH requires CONFIG_ACCEL_FIFO"
+#endif
+
 #ifndef CONFIG_GESTURE_DETECTION
 #define CONFIG_GESTURE_DETECTION_MASK 0
 #endif /* CONFIG_GESTURE_DETECTION */
@@ -35,6 +35,8 @@
 #define BMA2x2_STAT_TAP_SLOPE_ADDR		0x0B
 #define BMA2x2_STAT_ORIENT_HIGH_ADDR		0x0C
 #define BMA2x2_STAT_FIFO_ADDR			0x0E
+#define BMA2x2_FIFO_OVERRUN			0x80
+#define BMA2x2_FIFO_FRAME_COUNT_MSK		0x7F
 #define BMA2x2_RANGE_SELECT_ADDR		0x0F
 #define BMA2x2_RANGE_SELECT_MSK			0x0F
 #define BMA2x2_RANGE_2G				3
@@ -148,6 +150,11 @@
 #define BMA2x2_FIFO_MODE_ADDR			0x3E
 #define BMA2x2_FIFO_DATA_OUTPUT_ADDR		0x3F
 #define BMA2x2_FIFO_WML_TRIG			0x30
+/* Stream mode, X, Y and Z in each frame */
+#define BMA2x2_FIFO_MODE_STREAM			0x80
+/* Frames held by the FIFO, 6 bytes each */
+#define BMA2x2_FIFO_DEPTH			32
+#define BMA2x2_FIFO_FRAME_SIZE			6
 
 /* Sensor resolution in number of bits. This sensor has fixed resolution. */
 #define BMA2x2_RESOLUTION			12
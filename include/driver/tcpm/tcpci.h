@@ -283,6 +283,10 @@ void tcpci_set_cached_pull(int port, enum tcpc_cc_pull pull);
 enum tcpc_cc_pull tcpci_get_cached_pull(int port);
 
 void tcpci_tcpc_alert(int port);
+#ifdef CONFIG_USB_PD_TCPC_ALERT_STATS
+/* I2C transactions used to handle the last alert on the port */
+int tcpci_get_last_alert_xfers(int port);
+#endif
 int tcpci_tcpm_init(int port);
 int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
 	enum tcpc_cc_voltage_status *cc2);
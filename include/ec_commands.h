@@ -7046,6 +7046,267 @@ struct ec_response_i2c_control {
 	} cmd_response;
 } __ec_align_size1;
 
+/*****************************************************************************/
+/*
+ * Batched host commands.
+ *
+ * Run several host commands from one request packet and return all of their
+ * responses in one response packet, saving a bus round trip per command.
+ *
+ * The request is a struct ec_params_batch followed by num_commands records,
+ * each a struct ec_batch_request followed by its params.  The response is a
+ * struct ec_response_batch followed by one record per command that was run,
+ * each a struct ec_batch_response followed by its response data.  Every
+ * record is padded to EC_BATCH_RECORD_SIZE() so headers and data stay 32-bit
+ * aligned.
+ *
+ * Commands are run in order.  The EC stops early once the next response
+ * header would not fit in the response packet; num_commands in the response
+ * is the number of commands actually run.  Batches may not be nested.
+ */
+#define EC_CMD_BATCH 0x013A
+
+#define EC_BATCH_RECORD_SIZE(data_size) (4 + (((data_size) + 3) & ~3))
+
+struct ec_params_batch {
+	uint8_t num_commands;
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_batch_request {
+	uint16_t command;
+	uint8_t command_version;
+	uint8_t params_size;
+	/* Followed by params_size bytes of params, padded to 4 bytes */
+} __ec_align4;
+
+struct ec_response_batch {
+	uint8_t num_commands;
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_batch_response {
+	uint16_t result;		/* enum ec_status */
+	uint16_t response_size;
+	/* Followed by response_size bytes of data, padded to 4 bytes */
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Hash flash blocks.
+ *
+ * Compute a digest of each of num_blocks consecutive blocks of block_size
+ * bytes, starting at offset (relative to the start of the flash region, as
+ * for EC_CMD_FLASH_READ).  This lets the host find which erase blocks differ
+ * from an image without reading them back.
+ *
+ * The response holds as many digests as fit in the response packet, for at
+ * most 128 KiB of flash; num_blocks in the response is the number of blocks
+ * actually hashed.  EC_RES_OVERFLOW is returned if a single block is larger
+ * than that, and EC_RES_BUSY while the EC is computing its own vboot hash.
+ */
+#define EC_CMD_FLASH_BLOCK_HASH 0x013B
+
+enum ec_flash_block_hash_type {
+	EC_FLASH_BLOCK_HASH_SHA256 = 0,
+	EC_FLASH_BLOCK_HASH_CRC32 = 1,
+};
+
+struct ec_params_flash_block_hash {
+	uint32_t offset;
+	uint32_t block_size;
+	uint16_t num_blocks;
+	uint8_t hash_type;	/* enum ec_flash_block_hash_type */
+	uint8_t reserved;
+} __ec_align4;
+
+struct ec_response_flash_block_hash {
+	uint16_t num_blocks;
+	uint8_t digest_size;
+	uint8_t reserved;
+	uint8_t digest[];	/* num_blocks * digest_size bytes */
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Bulk flash read.
+ *
+ * Copy up to size bytes of flash, starting at offset (relative to the start
+ * of the flash region, as for EC_CMD_FLASH_READ), to the start of the EC's
+ * host-visible bulk window.  The host then reads the data directly through
+ * the memory-mapped interface instead of one host packet at a time.
+ *
+ * The response gives the number of bytes actually copied, which is limited
+ * by the size of the window.  The window contents are valid until the next
+ * EC_CMD_FLASH_READ_BULK.  Only supported on interfaces which expose the
+ * window (e.g. MEC EMI over LPC/eSPI).
+ */
+#define EC_CMD_FLASH_READ_BULK 0x013C
+
+struct ec_params_flash_read_bulk {
+	uint32_t offset;
+	uint32_t size;
+} __ec_align4;
+
+struct ec_response_flash_read_bulk {
+	uint32_t size;		/* Bytes placed in the bulk window */
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Keypress latency statistics.
+ *
+ * Each scancode byte the EC sends through the 8042 interface because of a
+ * scanned key event is timed at each stage on its way to the host:
+ *
+ *   SCAN:  start of the matrix scan that first saw the key change -> key
+ *          reported (includes the debounce time with strict debouncing)
+ *   QUEUE: key reported -> byte written to the host data port
+ *   HOST:  byte written -> host read it
+ *   TOTAL: start of the scan -> host read the byte
+ *
+ * The percentiles come from a histogram with four buckets per power of two,
+ * so they are rounded up by at most 25%.  max_us is exact.
+ */
+#define EC_CMD_KEYBOARD_LATENCY 0x013D
+
+enum ec_keyboard_latency_stage {
+	EC_KEYBOARD_LATENCY_SCAN = 0,
+	EC_KEYBOARD_LATENCY_QUEUE,
+	EC_KEYBOARD_LATENCY_HOST,
+	EC_KEYBOARD_LATENCY_TOTAL,
+	EC_KEYBOARD_LATENCY_STAGE_COUNT,
+};
+
+/* Clear the statistics after reading them */
+#define EC_KEYBOARD_LATENCY_CLEAR BIT(0)
+
+struct ec_params_keyboard_latency {
+	uint8_t flags;		/* EC_KEYBOARD_LATENCY_* */
+} __ec_align1;
+
+struct ec_keyboard_latency_stats {
+	uint32_t count;
+	uint32_t p50_us;
+	uint32_t p99_us;
+	uint32_t max_us;
+} __ec_align4;
+
+struct ec_response_keyboard_latency {
+	struct ec_keyboard_latency_stats stage[EC_KEYBOARD_LATENCY_STAGE_COUNT];
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Read (and delete) as many entries of the PD event log as fit in the
+ * response.
+ *
+ * entries[] holds "count" struct ec_response_pd_log, each followed by its
+ * payload padded to a multiple of 4 bytes.  count is 0 once the log (and the
+ * logs of connected accessories) is empty.  "dropped" is the number of events
+ * lost because the log was full since the last read of this command.
+ */
+#define EC_CMD_PD_GET_LOG_ENTRIES 0x013E
+
+struct ec_response_pd_log_entries {
+	uint16_t count;
+	uint16_t dropped;
+	uint8_t entries[];
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Binary I2C trace.
+ *
+ * With CONFIG_I2C_TRACE_BINARY, transfers to the traced addresses are copied
+ * into a ring instead of being printed on the console.  EC_I2C_TRACE_READ
+ * removes as many whole records from the ring as fit in the response.  Each
+ * record is a struct ec_i2c_trace_record followed by out_size bytes written
+ * and in_size bytes read; records are byte aligned.
+ *
+ * EC_I2C_TRACE_ENABLE traces a range of addresses on a port, like the
+ * "i2ctrace enable" console command, and switches tracing to the ring.
+ * EC_I2C_TRACE_DISABLE stops tracing all addresses.
+ */
+#define EC_CMD_I2C_TRACE 0x013F
+
+enum ec_i2c_trace_subcmd {
+	EC_I2C_TRACE_READ = 0,
+	EC_I2C_TRACE_ENABLE = 1,
+	EC_I2C_TRACE_DISABLE = 2,
+};
+
+struct ec_params_i2c_trace {
+	uint8_t subcmd;		/* enum ec_i2c_trace_subcmd */
+	uint8_t port;		/* ENABLE only */
+	uint8_t addr_lo;	/* ENABLE only, 7-bit address, inclusive */
+	uint8_t addr_hi;	/* ENABLE only, inclusive */
+} __ec_align1;
+
+/* Only the first bytes of a longer transfer were recorded */
+#define EC_I2C_TRACE_TRUNCATED BIT(0)
+
+struct ec_i2c_trace_record {
+	uint32_t timestamp;	/* Low 32 bits of the EC time in us */
+	uint16_t addr_flags;
+	uint8_t port;
+	uint8_t flags;		/* EC_I2C_TRACE_* */
+	uint8_t out_size;	/* Bytes written (as recorded) */
+	uint8_t in_size;	/* Bytes read (as recorded) */
+	uint8_t data[];
+} __ec_align1;
+
+struct ec_response_i2c_trace {
+	uint16_t dropped;	/* Records lost since the last read */
+	uint16_t size;		/* Bytes of records */
+	uint8_t records[];
+} __ec_align4;
+
+/*
+ * Read the power timeline: power signal edges and power state changes, with
+ * the EC hardware timer time (us) each was seen at, oldest first.  The
+ * timeline keeps the latest CONFIG_POWER_TIMELINE_SIZE entries.
+ *
+ * Entries are numbered from boot.  A read returns as many entries as fit,
+ * starting from number seq or the oldest one kept if that is later; read
+ * again from seq + count until count is 0.  Entries aren't removed by
+ * reading, except that EC_POWER_TIMELINE_CLEAR empties the timeline once
+ * read.
+ */
+#define EC_CMD_POWER_TIMELINE 0x0140
+
+/* Empty the timeline once read */
+#define EC_POWER_TIMELINE_CLEAR BIT(0)
+
+struct ec_params_power_timeline {
+	uint32_t seq;		/* Number of the first entry wanted */
+	uint8_t flags;		/* EC_POWER_TIMELINE_* */
+	uint8_t reserved[3];
+} __ec_align4;
+
+enum ec_power_timeline_type {
+	/* A power signal changed; id is its index in the board signal list */
+	EC_POWER_TIMELINE_EDGE = 0,
+	/* The power state changed; id is the new enum power_state */
+	EC_POWER_TIMELINE_STATE = 1,
+};
+
+struct ec_power_timeline_entry {
+	uint32_t timestamp;	/* EC hardware timer, us */
+	uint32_t signals;	/* Power signals asserted after the change */
+	uint8_t type;		/* enum ec_power_timeline_type */
+	uint8_t id;
+	uint8_t level;		/* EDGE only: new level of the signal */
+	uint8_t reserved;
+} __ec_align4;
+
+struct ec_response_power_timeline {
+	uint32_t seq;		/* Number of entries[0] */
+	uint16_t count;
+	uint16_t dropped;	/* Entries overwritten since the last clear */
+	struct ec_power_timeline_entry entries[];
+} __ec_align4;
+
 /*****************************************************************************/
 /* The command range 0x200-0x2FF is reserved for Rotor. */
 
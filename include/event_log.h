@@ -22,7 +22,12 @@ struct event_log_entry {
 /* Returned in the "type" field, when there is no entry available */
 #define EVENT_LOG_NO_ENTRY 0xff
 
-/* Add an entry to the event log. */
+/*
+ * Add an entry to the event log.
+ *
+ * Never blocks; the event is dropped if its type is disabled or if the log is
+ * full.  Safe to call from any task or interrupt.
+ */
 void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 		   void *payload, uint32_t timestamp);
 
@@ -32,4 +37,26 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data,
  */
 int log_dequeue_event(struct event_log_entry *r);
 
+/*
+ * Remove as many entries from the event log as fit in a buffer.
+ *
+ * Each entry is a struct event_log_entry followed by its payload, padded to a
+ * multiple of 4 bytes with zeroes.  Only one task may dequeue events.
+ *
+ * @param buf		Destination buffer
+ * @param size		Size of buf in bytes
+ * @param count		Number of entries written to buf
+ * @return number of bytes written to buf.
+ */
+int log_dequeue_events(void *buf, int size, int *count);
+
+/* Return the number of events dropped because the log was full, and reset it */
+int log_get_dropped(void);
+
+/* Enable or disable logging of one event type.  All types start enabled. */
+void log_enable_event_type(uint8_t type, int enable);
+
+/* Return non-zero if events of this type are logged */
+int log_event_type_enabled(uint8_t type);
+
 #endif /* __CROS_EC_EVENT_LOG_H */
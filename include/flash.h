@@ -132,6 +132,26 @@ enum flash_region {
  */
 int crec_flash_physical_read(int offset, int size, char *data);
 
+/**
+ * Start reading from physical flash in the background.
+ *
+ * The read completes when crec_flash_physical_read_wait() returns; the
+ * caller must not touch <data> or issue other flash operations until then.
+ *
+ * @param offset	Flash offset to read.
+ * @param size		Number of bytes to read.
+ * @param data		Destination buffer for data.
+ * @return EC_SUCCESS, or nonzero if the read could not be started.
+ */
+int crec_flash_physical_read_async(int offset, int size, char *data);
+
+/**
+ * Wait for a read started by crec_flash_physical_read_async() to finish.
+ *
+ * @return EC_SUCCESS, or nonzero if the read failed.
+ */
+int crec_flash_physical_read_wait(void);
+
 /**
  * Write to physical flash.
  *
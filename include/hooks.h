@@ -267,6 +267,14 @@ struct hook_data {
 	int priority;
 };
 
+/* Run time stats for a single hook routine (CONFIG_HOOK_DEBUG) */
+struct hook_stats {
+	/* Longest run time, in us */
+	uint32_t max_run_time;
+	/* Moving average run time, in us */
+	uint32_t avg_run_time;
+};
+
 /**
  * Call all the hook routines of a specified type.
  *
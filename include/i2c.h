@@ -12,6 +12,7 @@
 #include "gpio.h"
 #include "host_command.h"
 #include "stddef.h"
+#include "task_id.h"
 
 /*
  * I2C Peripheral Address encoding
@@ -197,6 +198,66 @@ int i2c_xfer_unlocked(const int port,
 		      const uint8_t *out, int out_size,
 		      uint8_t *in, int in_size, int flags);
 
+/* One transfer of a batch, see i2c_xfer_batch() */
+struct i2c_op {
+	int port;
+	uint16_t addr_flags;
+	const uint8_t *out;
+	int out_size;
+	uint8_t *in;
+	int in_size;
+	/* Result of the transfer, as returned by i2c_xfer() */
+	int rv;
+};
+
+/**
+ * Run a list of transfers, each as i2c_xfer() would.  Consecutive transfers
+ * on the same port (or controller, with CONFIG_I2C_MULTI_PORT_CONTROLLER)
+ * run back to back under a single acquisition of the port lock.  A failed
+ * transfer doesn't stop the ones after it.
+ *
+ * @param ops		Transfers to run, in order; each gets its rv filled in
+ * @param count		Number of transfers
+ * @return Number of transfers which failed.
+ */
+int i2c_xfer_batch(struct i2c_op *ops, int count);
+
+/* A batch of transfers for i2c_submit() */
+struct i2c_batch {
+	struct i2c_op *ops;
+	int count;
+	/* Called from the hook task once every transfer has run, or NULL */
+	void (*done)(struct i2c_batch *batch);
+	/* Task to send event when done, or TASK_ID_INVALID */
+	task_id_t task;
+	uint32_t event;
+	/* Number of transfers which failed, set before completion */
+	int errors;
+	/* Private to the I2C queue */
+	struct i2c_batch *next;
+	int queued;
+};
+
+/**
+ * Queue a batch of transfers to run with i2c_xfer_batch() on the hook task,
+ * and return without waiting.  Completion is signalled by batch->done and/or
+ * batch->event.  The batch and its buffers must stay valid until then; it
+ * may be submitted again from its done callback.  Safe to call from
+ * interrupts.  Requires CONFIG_I2C_XFER_QUEUE.
+ *
+ * @param batch		Batch to queue
+ * @return EC_SUCCESS, EC_ERROR_BUSY if the batch is already queued, or
+ *	   EC_ERROR_INVAL if it is empty.
+ */
+int i2c_submit(struct i2c_batch *batch);
+
+/**
+ * Return the number of I2C transactions the current task has started.  The
+ * count wraps, so callers should only look at the difference between two
+ * calls.  Needs CONFIG_I2C_XFER_TASK_COUNT.
+ */
+uint32_t i2c_task_xfer_count(void);
+
 #define I2C_LINE_SCL_HIGH BIT(0)
 #define I2C_LINE_SDA_HIGH BIT(1)
 #define I2C_LINE_IDLE (I2C_LINE_SCL_HIGH | I2C_LINE_SDA_HIGH)
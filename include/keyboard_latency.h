@@ -0,0 +1,60 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Keypress-to-host latency statistics */
+
+#ifndef __CROS_EC_KEYBOARD_LATENCY_H
+#define __CROS_EC_KEYBOARD_LATENCY_H
+
+#include "common.h"
+#include "ec_commands.h"
+
+#ifdef CONFIG_KEYBOARD_LATENCY_STATS
+
+/**
+ * Note the start of the scan which first saw the key event about to be
+ * reported.  With CONFIG_KEYBOARD_STRICT_DEBOUNCE that is earlier than the
+ * scan reporting it, so the scan stage includes the debounce time.
+ *
+ * Called by the keyboard scanner just before keyboard_state_changed(), so
+ * that key events injected by other means (console, host commands) aren't
+ * counted.
+ *
+ * @param scan_start	Time the scan started (low 32 bits of get_time())
+ */
+void keyboard_latency_scan(uint32_t scan_start);
+
+/**
+ * Claim the scan start noted by keyboard_latency_scan(), if any.
+ *
+ * @param scan_start	Filled in with the time the scan started
+ * @return 1 if the current key event came from a scan, else 0.
+ */
+int keyboard_latency_take_scan(uint32_t *scan_start);
+
+/**
+ * Add a sample ending now to a stage's histogram.
+ *
+ * @param stage		Stage (enum ec_keyboard_latency_stage)
+ * @param start		Time the stage started (low 32 bits of get_time())
+ */
+void keyboard_latency_record(enum ec_keyboard_latency_stage stage,
+			     uint32_t start);
+
+#else
+
+static inline void keyboard_latency_scan(uint32_t scan_start) {}
+
+static inline int keyboard_latency_take_scan(uint32_t *scan_start)
+{
+	return 0;
+}
+
+static inline void keyboard_latency_record(
+	enum ec_keyboard_latency_stage stage, uint32_t start) {}
+
+#endif
+
+#endif  /* __CROS_EC_KEYBOARD_LATENCY_H */
@@ -83,11 +83,21 @@ extern const struct hook_data __hooks_usb_pd_disconnect_end[];
 extern const struct hook_data __hooks_usb_pd_connect[];
 extern const struct hook_data __hooks_usb_pd_connect_end[];
 
+/* Priority order of each hook type, and run time stats for each hook */
+extern uint16_t __hooks_order[];
+extern uint16_t __hooks_order_end[];
+extern struct hook_stats __hook_stats[];
+extern struct hook_stats __hook_stats_end[];
+
 /* Deferrable functions and firing times*/
 extern const struct deferred_data __deferred_funcs[];
 extern const struct deferred_data __deferred_funcs_end[];
 extern uint64_t __deferred_until[];
 extern uint64_t __deferred_until_end[];
+extern uint16_t __deferred_heap[];
+extern uint16_t __deferred_heap_end[];
+extern uint16_t __deferred_heap_pos[];
+extern uint16_t __deferred_heap_pos_end[];
 
 /* I2C fake devices for unit testing */
 extern const struct test_i2c_xfer __test_i2c_xfer[];
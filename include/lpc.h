@@ -18,6 +18,17 @@
  */
 uint8_t *lpc_get_memmap_range(void);
 
+/**
+ * Return a pointer to the bulk data window.
+ *
+ * The host can read this window at any time; it backs EC_CMD_FLASH_READ_BULK.
+ * Chips with a window override the default, which returns NULL.
+ *
+ * @param size		Destination for the window size in bytes
+ * @return Pointer to the window, or NULL if the chip has none.
+ */
+__override_proto uint8_t *lpc_get_bulk_window(int *size);
+
 /**
  * Return true if keyboard data is waiting for the host to read (TOH is still
  * set).
@@ -84,6 +84,57 @@
 __stdlib_compat int vfnprintf(int (*addchar)(void *context, int c),
 			      void *context, const char *format, va_list args);
 
+/**
+ * Print formatted output like vfnprintf(), but hand literal text and each
+ * converted field to addstr() as one run instead of a character at a time.
+ *
+ * @param addchar	As for vfnprintf(); still used for padding
+ * @param addstr	Function to be called with each run of len characters.
+ *			Should return 0 if all were accepted or non-zero if
+ *			any were dropped due to overflow.
+ * @param context	Context pointer to pass to addchar() and addstr()
+ * @param format	Format string (see above for acceptable formats)
+ * @param args		Parameters
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the output was truncated.
+ */
+int vfnprintf_span(int (*addchar)(void *context, int c),
+		   int (*addstr)(void *context, const char *str, int len),
+		   void *context, const char *format, va_list args);
+
+/*
+ * Tokenized output (CONFIG_CONSOLE_TOKENIZED).
+ *
+ * vfntokenize() emits one line per call: TOKENIZE_MARKER, then base64 of
+ *   - a flags byte (TOKENIZE_*)
+ *   - the address of the format string, 32 bits little-endian
+ *   - the current time in us, if TOKENIZE_TIMESTAMP
+ *   - each argument in format order: integers, widths and %pT/%pP as
+ *     LEB128 varints (zigzag for signed), strings and %ph as a varint length
+ *     then the bytes, %pb as varint count + 1 (0 if NULL) then the value
+ * and a newline.  util/ec_detokenize.py looks the format string up in the
+ * EC image and prints what vfnprintf() would have.
+ */
+#define TOKENIZE_MARKER		'$'
+#define TOKENIZE_TIMESTAMP	BIT(0)	/* Wrap as cprints() does */
+#define TOKENIZE_RW		BIT(1)	/* Format string is in the RW image */
+#define TOKENIZE_LEGACY_LI	BIT(2)	/* CONFIG_PRINTF_LEGACY_LI_FORMAT */
+#define TOKENIZE_VERBOSE_TIME	BIT(3)	/* CONFIG_CONSOLE_VERBOSE */
+
+/**
+ * Print tokenized output to a function (see above).
+ *
+ * @param addchar	Function to be called for each character added, as for
+ *			vfnprintf()
+ * @param context	Context pointer to pass to addchar()
+ * @param flags		TOKENIZE_TIMESTAMP or 0
+ * @param format	Format string; must live in the EC image
+ * @param args		Parameters
+ * @return EC_SUCCESS, EC_ERROR_OVERFLOW if the output was truncated, or
+ *         EC_ERROR_INVAL for an unknown %p format.
+ */
+int vfntokenize(int (*addchar)(void *context, int c), void *context,
+		int flags, const char *format, va_list args);
+
 #ifndef CONFIG_ZEPHYR
 #define snprintf crec_snprintf
 #define vsnprintf crec_vsnprintf
@@ -57,6 +57,30 @@ int shared_mem_acquire(int size, char **dest_ptr);
  */
 void shared_mem_release(void *ptr);
 
+/*
+ * Fixed size block pools (CONFIG_SHMEM_POOLS), only for use by
+ * shared_mem_acquire() and shared_mem_release().
+ */
+
+/**
+ * Take a block from the smallest pool which has one big enough.
+ *
+ * @return EC_SUCCESS, or EC_ERROR_BUSY if no pool can serve the request.
+ */
+int shmem_pool_acquire(int size, char **dest_ptr);
+
+/**
+ * Give back a block if ptr is one.
+ *
+ * @return 1 if ptr was a pool block, 0 if it belongs to someone else.
+ */
+int shmem_pool_release(void *ptr);
+
+/**
+ * Print pool usage, for the shmem console command.
+ */
+void shmem_pool_print_stats(void);
+
 /*
  * This structure is allocated at the base of the free memory chunk and every
  * allocated buffer.
@@ -403,6 +403,8 @@ typedef struct mutex mutex_t;
  *
  * This tries to lock the mutex mtx.  If the mutex is already locked by another
  * task, de-schedules the current task until the mutex is again unlocked.
+ * On Cortex-M cores, the owner runs at the priority of its highest priority
+ * waiter meanwhile, and unlocking hands the mutex to that waiter directly.
  *
  * Must not be used in interrupt context!
  */
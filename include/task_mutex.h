@@ -0,0 +1,84 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Mutex ownership and priority inheritance, shared by the task cores so that
+ * the emulator schedules mutex waiters the same way as the target does.
+ */
+
+#ifndef __CROS_EC_TASK_MUTEX_H
+#define __CROS_EC_TASK_MUTEX_H
+
+#include "common.h"
+#include "task.h"
+
+/* Owner of a locked mutex, as stored in its lock field */
+#define MUTEX_OWNER(id) ((id) + 1)
+
+/**
+ * Pick the task to run: the highest priority one that is runnable, except that
+ * a task waiting for a mutex is stood in for by the mutex owner (following the
+ * chain if the owner itself waits for another mutex).
+ *
+ * @param runnable	Tasks ready to run; must not be 0
+ * @param blocked	Tasks waiting for a mutex
+ * @param blocked_on	Mutex each task of blocked waits for, by task ID
+ * @return The task to run, or TASK_ID_IDLE if no runnable task can go.
+ */
+static inline task_id_t mutex_next_task(uint32_t runnable, uint32_t blocked,
+					struct mutex * const *blocked_on)
+{
+	uint32_t candidates = runnable | blocked;
+	int id, owner, depth;
+
+	/* Nobody waiting for a mutex: plain priority order */
+	if (!blocked)
+		return __fls(runnable);
+
+	while (candidates) {
+		id = __fls(candidates);
+		owner = id;
+		for (depth = 0; depth < TASK_ID_COUNT &&
+		     (blocked & BIT(owner)); depth++) {
+			if (!blocked_on[owner]->lock)
+				break;
+			owner = blocked_on[owner]->lock - 1;
+		}
+
+		if ((runnable & BIT(owner)) && !(blocked & BIT(owner)))
+			return owner;
+
+		/* The owner is waiting for something else; try the next one */
+		candidates &= ~BIT(id);
+	}
+
+	return TASK_ID_IDLE;
+}
+
+/**
+ * Hand a mutex over to its highest priority waiter, or free it if nobody
+ * waits.  The caller must keep other tasks out meanwhile, and wake the new
+ * owner with TASK_EVENT_MUTEX.
+ *
+ * @param mtx		Mutex to unlock
+ * @return The new owner, or TASK_ID_INVALID if the mutex is now free.
+ */
+static inline task_id_t mutex_hand_over(struct mutex *mtx)
+{
+	task_id_t id;
+
+	if (!mtx->waiters) {
+		mtx->lock = 0;
+		return TASK_ID_INVALID;
+	}
+
+	id = __fls(mtx->waiters);
+	mtx->waiters &= ~BIT(id);
+	mtx->lock = MUTEX_OWNER(id);
+
+	return id;
+}
+
+#endif /* __CROS_EC_TASK_MUTEX_H */
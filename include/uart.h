@@ -84,6 +84,15 @@ int uart_printf(const char *format, ...);
  */
 int uart_vprintf(const char *format, va_list args);
 
+/**
+ * Put tokenized output to the UART, like vfntokenize().
+ *
+ * See printf.h for the record format.
+ *
+ * @return EC_SUCCESS, or non-zero if output was truncated.
+ */
+int uart_vtokenize(int flags, const char *format, va_list args);
+
 /**
  * Put a single character into the transmit buffer.
  *
@@ -100,6 +109,19 @@ int uart_vprintf(const char *format, va_list args);
  */
 int uart_tx_char_raw(void *context, int c);
 
+/**
+ * Put a run of characters into the transmit buffer.
+ *
+ * Like uart_tx_char_raw(), but copies the whole run at once and updates the
+ * buffer bookkeeping once.  Copies as much as fits.
+ *
+ * @param context	Context; ignored.
+ * @param str		Characters to write.
+ * @param len		Number of characters.
+ * @return 0 if all characters were transmitted, 1 if any were dropped.
+ */
+int uart_tx_str_raw(void *context, const char *str, int len);
+
 /**
  * Flush output.  Blocks until UART has transmitted all output.
  */
@@ -16,6 +16,7 @@
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
+#include "hwtimer.h"
 #include "lpc.h"
 #include "power.h"
 #include "power/intel_x86.h"
@@ -238,6 +239,141 @@ int power_wait_mask_signals_timeout(uint32_t want, uint32_t mask, int timeout)
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_POWER_TIMELINE
+BUILD_ASSERT(POWER_OF_TWO(CONFIG_POWER_TIMELINE_SIZE));
+
+static struct ec_power_timeline_entry timeline[CONFIG_POWER_TIMELINE_SIZE];
+/* Number of the next entry, and of the first one since the last clear */
+static uint32_t timeline_head;
+static uint32_t timeline_start;
+
+/**
+ * Add an entry to the power timeline. Safe to call from interrupts.
+ */
+static void timeline_add(uint32_t time, enum ec_power_timeline_type type,
+			 int id, int level)
+{
+	struct ec_power_timeline_entry *e;
+	uint32_t key;
+
+	key = irq_lock();
+	e = &timeline[timeline_head++ & (CONFIG_POWER_TIMELINE_SIZE - 1)];
+	e->timestamp = time;
+	e->signals = in_signals;
+	e->type = type;
+	e->id = id;
+	e->level = level;
+	e->reserved = 0;
+	irq_unlock(key);
+}
+
+static void timeline_add_edge(uint32_t time, enum gpio_signal signal)
+{
+	int i;
+
+	for (i = 0; i < POWER_SIGNAL_COUNT; i++) {
+		if (power_signal_list[i].gpio == signal) {
+			timeline_add(time, EC_POWER_TIMELINE_EDGE, i,
+				     power_signal_get_level(signal));
+			return;
+		}
+	}
+}
+
+/**
+ * Number of the oldest entry still in the ring.
+ *
+ * WARNING: This function MUST be called with interrupts locked.
+ */
+static uint32_t timeline_oldest(void)
+{
+	if (timeline_head - timeline_start > CONFIG_POWER_TIMELINE_SIZE)
+		return timeline_head - CONFIG_POWER_TIMELINE_SIZE;
+	return timeline_start;
+}
+
+static enum ec_status
+host_command_power_timeline(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_power_timeline *p = args->params;
+	struct ec_response_power_timeline *r = args->response;
+	int max = (args->response_max - sizeof(*r)) / sizeof(r->entries[0]);
+	uint32_t key, seq, oldest;
+	int i;
+
+	key = irq_lock();
+	oldest = timeline_oldest();
+	seq = p->seq;
+	if ((int32_t)(seq - oldest) < 0)
+		seq = oldest;
+	if ((int32_t)(timeline_head - seq) < 0)
+		seq = timeline_head;
+
+	r->seq = seq;
+	r->count = MIN(timeline_head - seq, max);
+	r->dropped = MIN(oldest - timeline_start, UINT16_MAX);
+	for (i = 0; i < r->count; i++)
+		r->entries[i] = timeline[(seq + i) &
+					 (CONFIG_POWER_TIMELINE_SIZE - 1)];
+
+	if (p->flags & EC_POWER_TIMELINE_CLEAR)
+		timeline_start = timeline_head;
+	irq_unlock(key);
+
+	args->response_size = sizeof(*r) + r->count * sizeof(r->entries[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_POWER_TIMELINE, host_command_power_timeline,
+		     EC_VER_MASK(0));
+
+static int command_powertimeline(int argc, char **argv)
+{
+	struct ec_power_timeline_entry e;
+	uint32_t key, seq, prev = 0;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		key = irq_lock();
+		timeline_start = timeline_head;
+		irq_unlock(key);
+		return EC_SUCCESS;
+	}
+
+	key = irq_lock();
+	seq = timeline_oldest();
+	irq_unlock(key);
+
+	ccprintf("      time(us)     +us  in\n");
+	while (1) {
+		/* Entries may be added (or overwritten) as we print */
+		key = irq_lock();
+		if ((int32_t)(seq - timeline_oldest()) < 0)
+			seq = timeline_oldest();
+		if (seq == timeline_head) {
+			irq_unlock(key);
+			break;
+		}
+		e = timeline[seq++ & (CONFIG_POWER_TIMELINE_SIZE - 1)];
+		irq_unlock(key);
+
+		ccprintf("  %12u %7u  0x%04x  ", e.timestamp,
+			 prev ? e.timestamp - prev : 0, e.signals);
+		if (e.type == EC_POWER_TIMELINE_EDGE)
+			ccprintf("%s => %d\n", power_signal_list[e.id].name,
+				 e.level);
+		else
+			ccprintf("state %s\n", state_names[e.id]);
+		prev = e.timestamp;
+		cflush();
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(powertimeline, command_powertimeline, "[clear]",
+			"Show or clear power signal and state changes");
+#endif /* CONFIG_POWER_TIMELINE */
+
 void power_set_state(enum power_state new_state)
 {
 	/* Record the time we go into G3 */
@@ -249,6 +385,11 @@ void power_set_state(enum power_state new_state)
 
 	state = new_state;
 
+#ifdef CONFIG_POWER_TIMELINE
+	timeline_add(__hw_clock_source_read(), EC_POWER_TIMELINE_STATE,
+		     new_state, 0);
+#endif
+
 	/*
 	 * Reset want_g3_exit flag here to prevent the situation that if the
 	 * error handler in POWER_S5S4 decides to force shutdown the system and
@@ -865,6 +1006,10 @@ DECLARE_HOOK(HOOK_SECOND,
 
 void power_signal_interrupt(enum gpio_signal signal)
 {
+#ifdef CONFIG_POWER_TIMELINE
+	/* Before anything else, to stay close to the edge */
+	uint32_t time = __hw_clock_source_read();
+#endif
 #ifdef CONFIG_POWER_SIGNAL_INTERRUPT_STORM_DETECT_THRESHOLD
 	int i;
 
@@ -884,6 +1029,10 @@ void power_signal_interrupt(enum gpio_signal signal)
 	/* Shadow signals and compare with our desired signal state. */
 	power_update_signals();
 
+#ifdef CONFIG_POWER_TIMELINE
+	timeline_add_edge(time, signal);
+#endif
+
 	/* Wake up the task */
 	task_wake(TASK_ID_CHIPSET);
 }
@@ -4,7 +4,9 @@
 # found in the LICENSE file.
 
 # Device test binaries
-test-list-y ?= flash_write_protect pingpong timer_calib timer_dos timer_jump mutex utils utils_str
+# Only the cortex-m scheduler runs mutex owners at their waiters' priority
+test-list-cortex-m=mutex_inherit
+test-list-y ?= flash_write_protect pingpong timer_calib timer_dos timer_jump mutex $(test-list-$(CORE)) utils utils_str
 #disable: powerdemo
 
 # Emulator tests
@@ -29,6 +31,7 @@ test-list-host += compile_time_macros
 test-list-host += console_edit
 test-list-host += crc
 test-list-host += entropy
+test-list-host += event_log
 test-list-host += extpwr_gpio
 test-list-host += fan
 test-list-host += flash
@@ -40,7 +43,10 @@ test-list-host += fpsensor_state
 test-list-host += gyro_cal
 test-list-host += hooks
 test-list-host += host_command
+test-list-host += host_command_batch
 test-list-host += i2c_bitbang
+test-list-host += i2c_queue
+test-list-host += i2c_trace
 test-list-host += inductive_charging
 test-list-host += interrupt
 test-list-host += irq_locking
@@ -57,14 +63,17 @@ test-list-host += mag_cal
 test-list-host += math_util
 test-list-host += motion_angle
 test-list-host += motion_angle_tablet
+test-list-host += motion_hw_fifo
 test-list-host += motion_lid
 test-list-host += motion_sense_fifo
 test-list-host += mutex
+test-list-host += mutex_inherit
 test-list-host += newton_fit
 test-list-host += online_calibration
 test-list-host += online_calibration_spoof
 test-list-host += pingpong
 test-list-host += power_button
+test-list-host += power_timeline
 test-list-host += printf
 test-list-host += queue
 test-list-host += rsa
@@ -74,11 +83,13 @@ test-list-host += sbs_charging_v2
 test-list-host += sha256
 test-list-host += sha256_unrolled
 test-list-host += shmalloc
+test-list-host += shmem_pool
 test-list-host += static_if
 test-list-host += static_if_error
 test-list-host += system
 test-list-host += thermal
 test-list-host += timer_dos
+test-list-host += uart_task_rings
 test-list-host += uptime
 test-list-host += usb_common
 test-list-host += usb_pd_int
@@ -148,6 +159,7 @@ compile_time_macros-y=compile_time_macros.o
 console_edit-y=console_edit.o
 crc-y=crc.o
 entropy-y=entropy.o
+event_log-y=event_log.o
 extpwr_gpio-y=extpwr_gpio.o
 fan-y=fan.o
 flash-y=flash.o
@@ -160,7 +172,10 @@ fpsensor_state-y=fpsensor_state.o
 gyro_cal-y=gyro_cal.o gyro_cal_init_for_test.o
 hooks-y=hooks.o
 host_command-y=host_command.o
+host_command_batch-y=host_command_batch.o
 i2c_bitbang-y=i2c_bitbang.o
+i2c_queue-y=i2c_queue.o
+i2c_trace-y=i2c_trace.o
 inductive_charging-y=inductive_charging.o
 interrupt-y=interrupt.o
 irq_locking-y=irq_locking.o
@@ -175,6 +190,7 @@ mag_cal-y=mag_cal.o
 math_util-y=math_util.o
 motion_angle-y=motion_angle.o motion_angle_data_literals.o motion_common.o
 motion_angle_tablet-y=motion_angle_tablet.o motion_angle_data_literals_tablet.o motion_common.o
+motion_hw_fifo-y=motion_hw_fifo.o
 motion_lid-y=motion_lid.o
 motion_sense_fifo-y=motion_sense_fifo.o
 online_calibration-y=online_calibration.o
@@ -182,9 +198,11 @@ online_calibration_spoof-y=online_calibration_spoof.o gyro_cal_init_for_test.o
 kasa-y=kasa.o
 mpu-y=mpu.o
 mutex-y=mutex.o
+mutex_inherit-y=mutex_inherit.o
 newton_fit-y=newton_fit.o
 pingpong-y=pingpong.o
 power_button-y=power_button.o
+power_timeline-y=power_timeline.o
 powerdemo-y=powerdemo.o
 printf-y=printf.o
 queue-y=queue.o
@@ -199,6 +217,7 @@ sbs_charging_v2-y=sbs_charging_v2.o
 sha256-y=sha256.o
 sha256_unrolled-y=sha256.o
 shmalloc-y=shmalloc.o
+shmem_pool-y=shmem_pool.o
 static_if-y=static_if.o
 stm32f_rtc-y=stm32f_rtc.o
 stress-y=stress.o
@@ -206,6 +225,7 @@ system-y=system.o
 thermal-y=thermal.o
 timer_calib-y=timer_calib.o
 timer_dos-y=timer_dos.o
+uart_task_rings-y=uart_task_rings.o
 uptime-y=uptime.o
 usb_common-y=usb_common_test.o fake_battery.o
 usb_pd_int-y=usb_pd_int.o
@@ -0,0 +1,234 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the event log FIFO.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "event_log.h"
+#include "host_command.h"
+#include "test_util.h"
+#include "timer.h"
+#include "usb_pd.h"
+#include "util.h"
+
+#define UNIT_SIZE sizeof(struct event_log_entry)
+#define UNIT_COUNT (CONFIG_EVENT_LOG_SIZE / UNIT_SIZE)
+
+/* No accessories to fetch logs from */
+uint8_t board_get_usb_pd_port_count(void)
+{
+	return 0;
+}
+
+uint16_t pd_get_identity_vid(int port)
+{
+	return 0;
+}
+
+int pd_fetch_acc_log_entry(int port)
+{
+	return EC_RES_SUCCESS;
+}
+
+static void drain(void)
+{
+	struct {
+		struct event_log_entry r;
+		uint8_t payload[EVENT_LOG_SIZE_MASK];
+	} e;
+
+	do {
+		log_dequeue_event(&e.r);
+	} while (e.r.type != EVENT_LOG_NO_ENTRY);
+	log_get_dropped();
+}
+
+static int test_add_dequeue(void)
+{
+	struct {
+		struct event_log_entry r;
+		uint8_t payload[EVENT_LOG_SIZE_MASK];
+	} e;
+	uint8_t payload[5] = { 1, 2, 3, 4, 5 };
+	int i;
+
+	drain();
+	/* Enough entries to wrap around the FIFO a few times */
+	for (i = 0; i < 3 * UNIT_COUNT; i++) {
+		log_add_event(0x10, sizeof(payload), i, payload, 0);
+		payload[0] = i;
+
+		TEST_EQ(log_dequeue_event(&e.r), 2 * (int)UNIT_SIZE, "%d");
+		TEST_EQ(e.r.type, 0x10, "%d");
+		TEST_EQ(e.r.data, i, "%d");
+		TEST_EQ(EVENT_LOG_SIZE(e.r.size), 5, "%d");
+		TEST_ASSERT(e.r.payload[1] == 2 && e.r.payload[4] == 5);
+	}
+
+	log_dequeue_event(&e.r);
+	TEST_EQ(e.r.type, EVENT_LOG_NO_ENTRY, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_bulk(void)
+{
+	uint8_t buf[64];
+	uint8_t payload[3] = { 0xaa, 0xbb, 0xcc };
+	struct event_log_entry *r;
+	int count, used;
+
+	drain();
+	log_add_event(1, 0, 0x100, NULL, 0);
+	log_add_event(2, sizeof(payload), 0x200, payload, 0);
+	log_add_event(3, 0, 0x300, NULL, 0);
+
+	/* Only the first two fit: 8 + (8 + 4) bytes */
+	used = log_dequeue_events(buf, 27, &count);
+	TEST_EQ(count, 2, "%d");
+	TEST_EQ(used, 20, "%d");
+	r = (void *)buf;
+	TEST_EQ(r->type, 1, "%d");
+	r = (void *)(buf + 8);
+	TEST_EQ(r->type, 2, "%d");
+	TEST_EQ(r->data, 0x200, "%d");
+	TEST_ASSERT(r->payload[0] == 0xaa && r->payload[2] == 0xcc);
+	TEST_EQ(r->payload[3], 0, "%d");
+
+	used = log_dequeue_events(buf, sizeof(buf), &count);
+	TEST_EQ(count, 1, "%d");
+	TEST_EQ(used, 8, "%d");
+	TEST_EQ(((struct event_log_entry *)buf)->data, 0x300, "%d");
+
+	used = log_dequeue_events(buf, sizeof(buf), &count);
+	TEST_EQ(count, 0, "%d");
+	TEST_EQ(used, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_type_mask(void)
+{
+	struct event_log_entry r;
+
+	drain();
+	log_enable_event_type(0x42, 0);
+	TEST_ASSERT(!log_event_type_enabled(0x42));
+	TEST_ASSERT(log_event_type_enabled(0x43));
+
+	log_add_event(0x42, 0, 1, NULL, 0);
+	log_add_event(0x43, 0, 2, NULL, 0);
+	log_dequeue_event(&r);
+	TEST_EQ(r.type, 0x43, "%d");
+	log_dequeue_event(&r);
+	TEST_EQ(r.type, EVENT_LOG_NO_ENTRY, "%d");
+
+	log_enable_event_type(0x42, 1);
+	log_add_event(0x42, 0, 1, NULL, 0);
+	log_dequeue_event(&r);
+	TEST_EQ(r.type, 0x42, "%d");
+
+	/* A disabled type doesn't count as dropped */
+	TEST_EQ(log_get_dropped(), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_overflow(void)
+{
+	struct {
+		struct event_log_entry r;
+		uint8_t payload[EVENT_LOG_SIZE_MASK];
+	} e;
+	uint8_t payload[8] = { 0 };
+	int i;
+
+	drain();
+	/* Each entry takes 2 units; the extra ones are dropped */
+	for (i = 0; i < UNIT_COUNT / 2 + 3; i++)
+		log_add_event(7, sizeof(payload), i, payload, 0);
+	TEST_EQ(log_get_dropped(), 3, "%d");
+	TEST_EQ(log_get_dropped(), 0, "%d");
+
+	/* The oldest entries were kept */
+	for (i = 0; i < UNIT_COUNT / 2; i++) {
+		log_dequeue_event(&e.r);
+		TEST_EQ(e.r.data, i, "%d");
+	}
+	log_dequeue_event(&e.r);
+	TEST_EQ(e.r.type, EVENT_LOG_NO_ENTRY, "%d");
+
+	/* All the room is back */
+	for (i = 0; i < UNIT_COUNT / 2; i++)
+		log_add_event(7, sizeof(payload), i, payload, 0);
+	TEST_EQ(log_get_dropped(), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_timestamp(void)
+{
+	struct event_log_entry r;
+	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+
+	drain();
+	log_add_event(1, 0, 0, NULL, now - 20);
+	log_dequeue_event(&r);
+	/* Milliseconds in the past */
+	TEST_ASSERT(r.timestamp >= 20 && r.timestamp < 30);
+
+	return EC_SUCCESS;
+}
+
+static int test_host_command(void)
+{
+	struct {
+		struct ec_response_pd_log_entries r;
+		uint8_t entries[128];
+	} resp;
+	struct ec_response_pd_log *entry;
+	uint8_t payload[2] = { 0x12, 0x34 };
+	int i;
+
+	drain();
+	for (i = 0; i < 4; i++)
+		pd_log_event(PD_EVENT_MCU_BOARD_CUSTOM,
+			     PD_LOG_PORT_SIZE(1, sizeof(payload)), i, payload);
+
+	TEST_EQ(test_send_host_command(EC_CMD_PD_GET_LOG_ENTRIES, 0, NULL, 0,
+				       &resp, sizeof(resp)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 4, "%d");
+	TEST_EQ(resp.r.dropped, 0, "%d");
+	for (i = 0; i < 4; i++) {
+		entry = (void *)(resp.r.entries + 12 * i);
+		TEST_EQ(entry->type, PD_EVENT_MCU_BOARD_CUSTOM, "%d");
+		TEST_EQ(PD_LOG_PORT(entry->size_port), 1, "%d");
+		TEST_EQ(entry->data, i, "%d");
+		TEST_EQ(entry->payload[1], 0x34, "%d");
+	}
+
+	TEST_EQ(test_send_host_command(EC_CMD_PD_GET_LOG_ENTRIES, 0, NULL, 0,
+				       &resp, sizeof(resp)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_add_dequeue);
+	RUN_TEST(test_bulk);
+	RUN_TEST(test_type_mask);
+	RUN_TEST(test_overflow);
+	RUN_TEST(test_timestamp);
+	RUN_TEST(test_host_command);
+
+	test_print_result();
+}
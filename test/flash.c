@@ -6,11 +6,14 @@
 /* Console commands to trigger flash host commands */
 
 #include "console.h"
+#include "crc.h"
 #include "ec_commands.h"
 #include "flash.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
+#include "lpc.h"
+#include "sha256.h"
 #include "system.h"
 #include "task.h"
 #include "test_util.h"
@@ -359,6 +362,178 @@ static int test_flash_info(void)
 		   (resp.protect_block_size == CONFIG_FLASH_BANK_SIZE));
 }
 
+int host_command_block_hash(int offset, int block_size, int num_blocks,
+			    int hash_type,
+			    struct ec_response_flash_block_hash *resp,
+			    int resp_size)
+{
+	struct ec_params_flash_block_hash params;
+
+	params.offset = offset;
+	params.block_size = block_size;
+	params.num_blocks = num_blocks;
+	params.hash_type = hash_type;
+	params.reserved = 0;
+
+	return test_send_host_command(EC_CMD_FLASH_BLOCK_HASH, 0, &params,
+				      sizeof(params), resp, resp_size);
+}
+
+static int test_block_hash(void)
+{
+#ifdef EMU_BUILD
+	static uint8_t buf[sizeof(struct ec_response_flash_block_hash) +
+			   4 * SHA256_DIGEST_SIZE];
+	struct ec_response_flash_block_hash *resp = (void *)buf;
+	struct sha256_ctx ctx;
+	uint8_t *want_sha;
+	uint32_t crc[4];
+	int i;
+
+	for (i = 0; i < 1024; ++i)
+		__host_flash[i] = i * 7 + 3;
+
+	/* CRC-32 of each 256-byte block */
+	TEST_ASSERT(host_command_block_hash(0, 256, 4,
+					    EC_FLASH_BLOCK_HASH_CRC32,
+					    resp, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(resp->num_blocks, 4, "%d");
+	TEST_EQ(resp->digest_size, 4, "%d");
+	for (i = 0; i < 4; ++i) {
+		uint32_t want;
+
+		crc32_ctx_init(&want);
+		crc32_ctx_hash(&want, __host_flash + i * 256, 256);
+		want = crc32_ctx_result(&want);
+		memcpy(&crc[i], resp->digest + i * 4, 4);
+		TEST_EQ(crc[i], want, "0x%08x");
+	}
+
+	/* Changing one block only changes that block's digest */
+	__host_flash[2 * 256 + 17] ^= 0x5a;
+	TEST_ASSERT(host_command_block_hash(0, 256, 4,
+					    EC_FLASH_BLOCK_HASH_CRC32,
+					    resp, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+	for (i = 0; i < 4; ++i) {
+		if (i == 2)
+			TEST_ASSERT(memcmp(&crc[i], resp->digest + i * 4, 4));
+		else
+			TEST_ASSERT(!memcmp(&crc[i], resp->digest + i * 4, 4));
+	}
+
+	/* SHA-256 of each 512-byte block */
+	TEST_ASSERT(host_command_block_hash(0, 512, 2,
+					    EC_FLASH_BLOCK_HASH_SHA256,
+					    resp, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(resp->num_blocks, 2, "%d");
+	TEST_EQ(resp->digest_size, SHA256_DIGEST_SIZE, "%d");
+	for (i = 0; i < 2; ++i) {
+		SHA256_init(&ctx);
+		SHA256_update(&ctx, (const uint8_t *)__host_flash + i * 512,
+			      512);
+		want_sha = SHA256_final(&ctx);
+		TEST_ASSERT_ARRAY_EQ(resp->digest + i * SHA256_DIGEST_SIZE,
+				     want_sha, SHA256_DIGEST_SIZE);
+	}
+
+	/* Only as many digests as fit in the response are returned */
+	TEST_ASSERT(host_command_block_hash(0, 64, 16,
+					    EC_FLASH_BLOCK_HASH_SHA256,
+					    resp, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(resp->num_blocks, 4, "%d");
+
+	/* No more than 128 KiB of flash per command */
+	TEST_ASSERT(host_command_block_hash(0, 64 * 1024, 4,
+					    EC_FLASH_BLOCK_HASH_CRC32,
+					    resp, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(resp->num_blocks, 2, "%d");
+	TEST_ASSERT(host_command_block_hash(0, 128 * 1024 + 256, 1,
+					    EC_FLASH_BLOCK_HASH_CRC32,
+					    resp, sizeof(buf)) ==
+		    EC_RES_OVERFLOW);
+
+	/* Bad parameters */
+	TEST_ASSERT(host_command_block_hash(0, 0, 4,
+					    EC_FLASH_BLOCK_HASH_SHA256,
+					    resp, sizeof(buf)) ==
+		    EC_RES_INVALID_PARAM);
+	TEST_ASSERT(host_command_block_hash(0, 256, 4, 0xff,
+					    resp, sizeof(buf)) ==
+		    EC_RES_INVALID_PARAM);
+	TEST_ASSERT(host_command_block_hash(CONFIG_FLASH_SIZE_BYTES - 256,
+					    512, 1,
+					    EC_FLASH_BLOCK_HASH_SHA256,
+					    resp, sizeof(buf)) ==
+		    EC_RES_ERROR);
+#else
+	ccprintf("Skip. Emulator only test.\n");
+#endif
+
+	return EC_SUCCESS;
+}
+
+/* Stand-in for the chip's host-visible bulk window */
+static uint8_t bulk_window[128];
+
+__override uint8_t *lpc_get_bulk_window(int *size)
+{
+	*size = sizeof(bulk_window);
+	return bulk_window;
+}
+
+int host_command_read_bulk(int offset, int size, int *size_read)
+{
+	struct ec_params_flash_read_bulk params;
+	struct ec_response_flash_read_bulk resp;
+	int rv;
+
+	params.offset = offset;
+	params.size = size;
+
+	rv = test_send_host_command(EC_CMD_FLASH_READ_BULK, 0, &params,
+				    sizeof(params), &resp, sizeof(resp));
+	*size_read = resp.size;
+	return rv;
+}
+
+static int test_read_bulk(void)
+{
+#ifdef EMU_BUILD
+	int size_read;
+	int i;
+
+	for (i = 0; i < 1024; ++i)
+		__host_flash[i] = i * 5 + 1;
+
+	/* Fits in the window */
+	memset(bulk_window, 0, sizeof(bulk_window));
+	TEST_ASSERT(host_command_read_bulk(16, 100, &size_read) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(size_read, 100, "%d");
+	TEST_ASSERT_ARRAY_EQ(bulk_window, (uint8_t *)__host_flash + 16, 100);
+
+	/* Clamped to the window size */
+	TEST_ASSERT(host_command_read_bulk(300, 1000, &size_read) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(size_read, (int)sizeof(bulk_window), "%d");
+	TEST_ASSERT_ARRAY_EQ(bulk_window, (uint8_t *)__host_flash + 300,
+			     sizeof(bulk_window));
+
+	/* Out of range */
+	TEST_ASSERT(host_command_read_bulk(CONFIG_FLASH_SIZE_BYTES - 16, 64,
+					   &size_read) == EC_RES_ERROR);
+#else
+	ccprintf("Skip. Emulator only test.\n");
+#endif
+
+	return EC_SUCCESS;
+}
+
 static int test_region_info(void)
 {
 	VERIFY_REGION_INFO(EC_FLASH_REGION_RO,
@@ -456,6 +631,8 @@ static void run_test_step1(void)
 	RUN_TEST(test_op_failure);
 	RUN_TEST(test_flash_info);
 	RUN_TEST(test_region_info);
+	RUN_TEST(test_block_hash);
+	RUN_TEST(test_read_bulk);
 	RUN_TEST(test_write_protect);
 
 	if (test_get_error_count())
@@ -27,6 +27,28 @@ static void init_hook(void)
 }
 DECLARE_HOOK(HOOK_INIT, init_hook, HOOK_PRIO_DEFAULT);
 
+/* Declared out of priority order; must run in priority order */
+static int init_order[3];
+static int init_order_count;
+
+static void init_last_hook(void)
+{
+	init_order[init_order_count++] = HOOK_PRIO_LAST;
+}
+DECLARE_HOOK(HOOK_INIT, init_last_hook, HOOK_PRIO_LAST);
+
+static void init_first_hook(void)
+{
+	init_order[init_order_count++] = HOOK_PRIO_FIRST;
+}
+DECLARE_HOOK(HOOK_INIT, init_first_hook, HOOK_PRIO_FIRST);
+
+static void init_late_hook(void)
+{
+	init_order[init_order_count++] = HOOK_PRIO_DEFAULT + 1;
+}
+DECLARE_HOOK(HOOK_INIT, init_late_hook, HOOK_PRIO_DEFAULT + 1);
+
 static void tick_hook(void)
 {
 	tick_hook_count++;
@@ -105,6 +127,16 @@ static int test_priority(void)
 	return EC_SUCCESS;
 }
 
+static int test_init_priority(void)
+{
+	TEST_EQ(init_order_count, 3, "%d");
+	TEST_EQ(init_order[0], HOOK_PRIO_FIRST, "%d");
+	TEST_EQ(init_order[1], HOOK_PRIO_DEFAULT + 1, "%d");
+	TEST_EQ(init_order[2], HOOK_PRIO_LAST, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int test_deferred(void)
 {
 	deferred_call_count = 0;
@@ -134,6 +166,53 @@ static int test_deferred(void)
 	return EC_SUCCESS;
 }
 
+static int deferred_order[3];
+static int deferred_order_count;
+
+static void deferred_a(void)
+{
+	deferred_order[deferred_order_count++] = 'a';
+}
+DECLARE_DEFERRED(deferred_a);
+
+static void deferred_b(void)
+{
+	deferred_order[deferred_order_count++] = 'b';
+}
+DECLARE_DEFERRED(deferred_b);
+
+static void deferred_c(void)
+{
+	deferred_order[deferred_order_count++] = 'c';
+}
+DECLARE_DEFERRED(deferred_c);
+
+static int test_deferred_order(void)
+{
+	deferred_order_count = 0;
+
+	/* Deferreds run in order of firing time, not declaration */
+	hook_call_deferred(&deferred_a_data, 30 * MSEC);
+	hook_call_deferred(&deferred_b_data, 10 * MSEC);
+	hook_call_deferred(&deferred_c_data, 20 * MSEC);
+
+	/* Moving one earlier and one later reorders them */
+	hook_call_deferred(&deferred_a_data, 5 * MSEC);
+	hook_call_deferred(&deferred_b_data, 40 * MSEC);
+
+	usleep(25 * MSEC);
+	TEST_EQ(deferred_order_count, 2, "%d");
+	TEST_EQ(deferred_order[0], 'a', "%c");
+	TEST_EQ(deferred_order[1], 'c', "%c");
+
+	/* Cancelling the last one leaves nothing to run */
+	hook_call_deferred(&deferred_b_data, -1);
+	usleep(50 * MSEC);
+	TEST_EQ(deferred_order_count, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int repeating_deferred_count;
 static void deferred_repeating_func(void);
 DECLARE_DEFERRED(deferred_repeating_func);
@@ -166,7 +245,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_init_hook);
 	RUN_TEST(test_ticks);
 	RUN_TEST(test_priority);
+	RUN_TEST(test_init_priority);
 	RUN_TEST(test_deferred);
+	RUN_TEST(test_deferred_order);
 	RUN_TEST(test_repeating_deferred);
 
 	test_print_result();
@@ -135,6 +135,147 @@ static int test_hostcmd_invalid_command(void)
 	return EC_SUCCESS;
 }
 
+static int test_hostcmd_invalid_command_in_page(void)
+{
+	hostcmd_fill_in_default();
+
+	/* Between two implemented commands in the standard page */
+	req->command = EC_CMD_HELLO + 0x80;
+	hostcmd_send();
+	TEST_ASSERT(resp->result == EC_RES_INVALID_COMMAND);
+
+	/* In a page with no handlers at all */
+	req->checksum = 0;
+	req->command = 0x2000;
+	hostcmd_send();
+	TEST_ASSERT(resp->result == EC_RES_INVALID_COMMAND);
+
+	/* At the end of the board specific range */
+	req->checksum = 0;
+	req->command = EC_CMD_BOARD_SPECIFIC_LAST;
+	hostcmd_send();
+	TEST_ASSERT(resp->result == EC_RES_INVALID_COMMAND);
+
+	return EC_SUCCESS;
+}
+
+static enum ec_status
+test_private_command(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_hello *p = args->params;
+	struct ec_response_hello *r = args->response;
+
+	r->out_data = p->in_data + 1;
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(0x0003, test_private_command, EC_VER_MASK(0));
+
+static int test_hostcmd_private_command(void)
+{
+	hostcmd_fill_in_default();
+
+	req->command = EC_PRIVATE_HOST_COMMAND_VALUE(0x0003);
+	hostcmd_send();
+	TEST_ASSERT(resp->result == EC_RES_SUCCESS);
+	TEST_ASSERT(r->out_data == 0x11223345);
+
+	/* Neighbor of a private command */
+	req->checksum = 0;
+	req->command = EC_PRIVATE_HOST_COMMAND_VALUE(0x0004);
+	hostcmd_send();
+	TEST_ASSERT(resp->result == EC_RES_INVALID_COMMAND);
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_batch(void)
+{
+	struct ec_params_batch *bp = (struct ec_params_batch *)p;
+	struct ec_batch_request *br;
+	struct ec_response_batch *bresp = (struct ec_response_batch *)r;
+	struct ec_batch_response *bres;
+	uint8_t *b;
+
+	hostcmd_fill_in_default();
+	req->command = EC_CMD_BATCH;
+
+	/* HELLO, an invalid command, a nested batch, then HELLO again */
+	bp->num_commands = 4;
+	b = (uint8_t *)(bp + 1);
+
+	br = (struct ec_batch_request *)b;
+	br->command = EC_CMD_HELLO;
+	br->command_version = 0;
+	br->params_size = sizeof(struct ec_params_hello);
+	((struct ec_params_hello *)(br + 1))->in_data = 0x11223344;
+	b += EC_BATCH_RECORD_SIZE(br->params_size);
+
+	br = (struct ec_batch_request *)b;
+	br->command = 0xff;
+	br->command_version = 0;
+	br->params_size = 0;
+	b += EC_BATCH_RECORD_SIZE(br->params_size);
+
+	br = (struct ec_batch_request *)b;
+	br->command = EC_CMD_BATCH;
+	br->command_version = 0;
+	br->params_size = 0;
+	b += EC_BATCH_RECORD_SIZE(br->params_size);
+
+	br = (struct ec_batch_request *)b;
+	br->command = EC_CMD_HELLO;
+	br->command_version = 0;
+	br->params_size = sizeof(struct ec_params_hello);
+	((struct ec_params_hello *)(br + 1))->in_data = 0x01020304;
+	b += EC_BATCH_RECORD_SIZE(br->params_size);
+
+	req->data_len = b - (uint8_t *)bp;
+	pkt.request_size = sizeof(*req) + req->data_len;
+	hostcmd_send();
+
+	TEST_EQ(calculate_checksum(resp_buf,
+				   sizeof(*resp) + resp->data_len), 0, "%d");
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(bresp->num_commands, 4, "%d");
+
+	b = (uint8_t *)(bresp + 1);
+	bres = (struct ec_batch_response *)b;
+	TEST_EQ(bres->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(bres->response_size, (int)sizeof(struct ec_response_hello),
+		"%d");
+	TEST_EQ(((struct ec_response_hello *)(bres + 1))->out_data,
+		0x12243648, "0x%x");
+	b += EC_BATCH_RECORD_SIZE(bres->response_size);
+
+	bres = (struct ec_batch_response *)b;
+	TEST_EQ(bres->result, EC_RES_INVALID_COMMAND, "%d");
+	TEST_EQ(bres->response_size, 0, "%d");
+	b += EC_BATCH_RECORD_SIZE(bres->response_size);
+
+	bres = (struct ec_batch_response *)b;
+	TEST_EQ(bres->result, EC_RES_INVALID_COMMAND, "%d");
+	b += EC_BATCH_RECORD_SIZE(bres->response_size);
+
+	bres = (struct ec_batch_response *)b;
+	TEST_EQ(bres->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(((struct ec_response_hello *)(bres + 1))->out_data,
+		0x02040608, "0x%x");
+	b += EC_BATCH_RECORD_SIZE(bres->response_size);
+
+	TEST_EQ(resp->data_len, (int)(b - (uint8_t *)bresp), "%d");
+
+	/* A record running past the end of the request is rejected */
+	req->checksum = 0;
+	req->data_len -= 4;
+	pkt.request_size -= 4;
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_REQUEST_TRUNCATED, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int test_hostcmd_wrong_command_version(void)
 {
 	hostcmd_fill_in_default();
@@ -310,6 +451,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_hostcmd_too_long);
 	RUN_TEST(test_hostcmd_driver_error);
 	RUN_TEST(test_hostcmd_invalid_command);
+	RUN_TEST(test_hostcmd_invalid_command_in_page);
+	RUN_TEST(test_hostcmd_private_command);
+	RUN_TEST(test_hostcmd_batch);
 	RUN_TEST(test_hostcmd_wrong_command_version);
 	RUN_TEST(test_hostcmd_wrong_struct_version);
 	RUN_TEST(test_hostcmd_invalid_checksum);
@@ -0,0 +1,192 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests how EC_CMD_BATCH lays out and limits its response, with requests
+ * built by hand the way a host packs them.
+ */
+
+#include "common.h"
+#include "host_command.h"
+#include "system.h"
+#include "test_util.h"
+#include "util.h"
+
+#define MAX_SIZE 256
+
+static uint8_t request[MAX_SIZE];
+static uint8_t response[MAX_SIZE];
+static int request_size;
+
+/* Start a batch request */
+static void batch_start(void)
+{
+	memset(request, 0, sizeof(request));
+	request_size = sizeof(struct ec_params_batch);
+}
+
+/* Append a command to the batch request */
+static void batch_add(int command, const void *params, int params_size)
+{
+	struct ec_params_batch *p = (struct ec_params_batch *)request;
+	struct ec_batch_request *req =
+		(struct ec_batch_request *)(request + request_size);
+
+	req->command = command;
+	req->command_version = 0;
+	req->params_size = params_size;
+	if (params_size)
+		memcpy(req + 1, params, params_size);
+
+	request_size += EC_BATCH_RECORD_SIZE(params_size);
+	p->num_commands++;
+}
+
+static void batch_add_hello(uint32_t in_data)
+{
+	struct ec_params_hello params = { .in_data = in_data };
+
+	batch_add(EC_CMD_HELLO, &params, sizeof(params));
+}
+
+/* Run the batch request, with room for response_max bytes of response */
+static int batch_run(int response_max, int *response_size)
+{
+	struct host_cmd_handler_args args = {
+		.command = EC_CMD_BATCH,
+		.version = 0,
+		.params = request,
+		.params_size = request_size,
+		.response = response,
+		.response_max = response_max,
+	};
+	int rv;
+
+	rv = host_command_process(&args);
+	*response_size = args.response_size;
+	return rv;
+}
+
+/* Response record at offset bytes into the response */
+static struct ec_batch_response *record_at(int offset)
+{
+	return (struct ec_batch_response *)(response + offset);
+}
+
+static int check_hello(int offset, uint32_t in_data)
+{
+	struct ec_batch_response *res = record_at(offset);
+
+	TEST_EQ(res->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(res->response_size, (int)sizeof(struct ec_response_hello),
+		"%d");
+	TEST_EQ(((struct ec_response_hello *)(res + 1))->out_data,
+		in_data + 0x01020304, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_stops_when_full(void)
+{
+	struct ec_response_batch *r = (struct ec_response_batch *)response;
+	int size;
+	int i;
+
+	batch_start();
+	for (i = 0; i < 4; i++)
+		batch_add_hello(0x10 * (i + 1));
+
+	/*
+	 * The batch header and three 8-byte HELLO records fill 28 bytes, so
+	 * the fourth HELLO is left for the host to send again.
+	 */
+	TEST_EQ(batch_run(28, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_commands, 3, "%d");
+	TEST_EQ(size, 28, "%d");
+	for (i = 0; i < 3; i++)
+		TEST_EQ(check_hello(sizeof(*r) + i * 8, 0x10 * (i + 1)),
+			EC_SUCCESS, "%d");
+
+	/* With room for all of them, all are run */
+	TEST_EQ(batch_run(MAX_SIZE, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_commands, 4, "%d");
+	TEST_EQ(size, 36, "%d");
+	TEST_EQ(check_hello(sizeof(*r) + 3 * 8, 0x40), EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_pads_records(void)
+{
+	struct ec_response_batch *r = (struct ec_response_batch *)response;
+	struct ec_batch_response *res;
+	int info_size = strlen(system_get_build_info()) + 1;
+	int size;
+
+	/* The build info string has no particular length... */
+	batch_start();
+	batch_add(EC_CMD_GET_BUILD_INFO, NULL, 0);
+	batch_add_hello(0x55);
+
+	TEST_EQ(batch_run(MAX_SIZE, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_commands, 2, "%d");
+	res = record_at(sizeof(*r));
+	TEST_EQ(res->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(res->response_size, info_size, "%d");
+	TEST_ASSERT_ARRAY_EQ((uint8_t *)(res + 1),
+			     (uint8_t *)system_get_build_info(), info_size);
+
+	/* ...but the next record starts on a 4-byte boundary */
+	TEST_EQ(check_hello(sizeof(*r) + EC_BATCH_RECORD_SIZE(info_size),
+			    0x55), EC_SUCCESS, "%d");
+	TEST_EQ(size, (int)sizeof(*r) + EC_BATCH_RECORD_SIZE(info_size) + 8,
+		"%d");
+
+	/* A response cut short by the packet still leaves room to pad it */
+	TEST_EQ(batch_run(sizeof(*r) + 4 + 10, &size), EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->num_commands, 1, "%d");
+	TEST_EQ(record_at(sizeof(*r))->response_size, 8, "%d");
+	TEST_EQ(size, (int)sizeof(*r) + 4 + 8, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_bad_requests(void)
+{
+	int size;
+
+	/* No batch header */
+	batch_start();
+	request_size = 0;
+	TEST_EQ(batch_run(MAX_SIZE, &size), EC_RES_INVALID_PARAM, "%d");
+
+	/* No room for the response header */
+	batch_start();
+	batch_add_hello(0);
+	TEST_EQ(batch_run(2, &size), EC_RES_INVALID_PARAM, "%d");
+
+	/* More commands than the request holds */
+	batch_start();
+	batch_add_hello(0);
+	((struct ec_params_batch *)request)->num_commands = 2;
+	TEST_EQ(batch_run(MAX_SIZE, &size), EC_RES_REQUEST_TRUNCATED, "%d");
+
+	/* A record cut short */
+	batch_start();
+	batch_add_hello(0);
+	request_size -= 2;
+	TEST_EQ(batch_run(MAX_SIZE, &size), EC_RES_REQUEST_TRUNCATED, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_batch_stops_when_full);
+	RUN_TEST(test_batch_pads_records);
+	RUN_TEST(test_batch_bad_requests);
+
+	test_print_result();
+}
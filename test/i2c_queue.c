@@ -0,0 +1,177 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for batched and queued I2C transfers.
+ */
+
+#include "common.h"
+#include "i2c.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define PORT 0
+#define GOOD_ADDR 0x10
+#define NACK_ADDR 0x20
+
+#define TEST_EVENT TASK_EVENT_CUSTOM_BIT(0)
+
+/* Addresses seen by the mock, in order */
+static uint16_t xfer_log[8];
+static int xfer_count;
+
+static int mock_xfer(const int port, const uint16_t addr_flags,
+		     const uint8_t *out, int out_size,
+		     uint8_t *in, int in_size, int flags)
+{
+	int i;
+
+	if (xfer_count < ARRAY_SIZE(xfer_log))
+		xfer_log[xfer_count] = addr_flags;
+	xfer_count++;
+
+	if (port != PORT || addr_flags == NACK_ADDR)
+		return EC_ERROR_UNKNOWN;
+	for (i = 0; i < in_size; i++)
+		in[i] = out_size ? out[0] + i : i;
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(mock_xfer);
+
+static const uint8_t reg_a = 0x40, reg_b = 0x80;
+static uint8_t in_a[2], in_b[2], in_c[1];
+
+static struct i2c_op ops[] = {
+	{ .port = PORT, .addr_flags = GOOD_ADDR,
+	  .out = &reg_a, .out_size = 1, .in = in_a, .in_size = 2 },
+	{ .port = PORT, .addr_flags = NACK_ADDR,
+	  .out = &reg_a, .out_size = 1, .in = in_c, .in_size = 1 },
+	{ .port = PORT, .addr_flags = GOOD_ADDR,
+	  .out = &reg_b, .out_size = 1, .in = in_b, .in_size = 2 },
+};
+
+static int done_calls;
+static int resubmit;
+
+static void batch_done(struct i2c_batch *batch)
+{
+	done_calls++;
+	if (resubmit) {
+		resubmit = 0;
+		i2c_submit(batch);
+	}
+}
+
+static struct i2c_batch batch = {
+	.ops = ops,
+	.count = ARRAY_SIZE(ops),
+	.done = batch_done,
+	.task = TASK_ID_INVALID,
+};
+
+static void reset_state(void)
+{
+	int i;
+
+	xfer_count = 0;
+	done_calls = 0;
+	for (i = 0; i < ARRAY_SIZE(ops); i++)
+		ops[i].rv = -1;
+	memset(in_a, 0, sizeof(in_a));
+	memset(in_b, 0, sizeof(in_b));
+}
+
+static int check_ops(int start)
+{
+	TEST_EQ(xfer_log[start], GOOD_ADDR, "%d");
+	TEST_EQ(xfer_log[start + 1], NACK_ADDR, "%d");
+	TEST_EQ(xfer_log[start + 2], GOOD_ADDR, "%d");
+
+	/* A failed transfer doesn't stop the rest */
+	TEST_EQ(ops[0].rv, EC_SUCCESS, "%d");
+	TEST_EQ(ops[1].rv, EC_ERROR_UNKNOWN, "%d");
+	TEST_EQ(ops[2].rv, EC_SUCCESS, "%d");
+	TEST_ASSERT(in_a[0] == 0x40 && in_a[1] == 0x41);
+	TEST_ASSERT(in_b[0] == 0x80 && in_b[1] == 0x81);
+
+	return EC_SUCCESS;
+}
+
+static int test_batch(void)
+{
+	reset_state();
+
+	TEST_EQ(i2c_xfer_batch(ops, ARRAY_SIZE(ops)), 1, "%d");
+	TEST_EQ(xfer_count, 3, "%d");
+	TEST_EQ(check_ops(0), EC_SUCCESS, "%d");
+
+	/* The port is unlocked again */
+	TEST_EQ(i2c_xfer(PORT, GOOD_ADDR, &reg_a, 1, in_c, 1), EC_SUCCESS,
+		"%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_submit(void)
+{
+	uint32_t event;
+
+	reset_state();
+	batch.task = task_get_current();
+	batch.event = TEST_EVENT;
+
+	TEST_EQ(i2c_submit(&batch), EC_SUCCESS, "%d");
+	/* Already queued */
+	TEST_EQ(i2c_submit(&batch), EC_ERROR_BUSY, "%d");
+
+	event = task_wait_event_mask(TEST_EVENT, SECOND);
+	TEST_ASSERT(event & TEST_EVENT);
+	TEST_EQ(done_calls, 1, "%d");
+	TEST_EQ(batch.errors, 1, "%d");
+	TEST_EQ(xfer_count, 3, "%d");
+	TEST_EQ(check_ops(0), EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_resubmit_from_done(void)
+{
+	reset_state();
+	batch.task = task_get_current();
+	batch.event = TEST_EVENT;
+	resubmit = 1;
+
+	TEST_EQ(i2c_submit(&batch), EC_SUCCESS, "%d");
+	TEST_ASSERT(task_wait_event_mask(TEST_EVENT, SECOND) & TEST_EVENT);
+	if (done_calls < 2)
+		task_wait_event_mask(TEST_EVENT, SECOND);
+
+	TEST_EQ(done_calls, 2, "%d");
+	TEST_EQ(xfer_count, 6, "%d");
+	TEST_EQ(check_ops(3), EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_submit_empty(void)
+{
+	struct i2c_batch empty = { .task = TASK_ID_INVALID };
+
+	TEST_EQ(i2c_submit(&empty), EC_ERROR_INVAL, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_batch);
+	RUN_TEST(test_submit);
+	RUN_TEST(test_resubmit_from_done);
+	RUN_TEST(test_submit_empty);
+
+	test_print_result();
+}
@@ -0,0 +1,160 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the binary I2C trace.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "i2c.h"
+#include "test_util.h"
+#include "util.h"
+
+#define PORT 0
+#define TRACED_ADDR 0x10
+#define OTHER_ADDR 0x20
+
+static int mock_xfer(const int port, const uint16_t addr_flags,
+		     const uint8_t *out, int out_size,
+		     uint8_t *in, int in_size, int flags)
+{
+	int i;
+
+	if (port != PORT)
+		return EC_ERROR_INVAL;
+	for (i = 0; i < in_size; i++)
+		in[i] = 0xa0 + i;
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(mock_xfer);
+
+static struct {
+	struct ec_response_i2c_trace r;
+	uint8_t records[256];
+} resp;
+
+static int trace_command(uint8_t subcmd, int addr_lo, int addr_hi)
+{
+	struct ec_params_i2c_trace p = {
+		.subcmd = subcmd,
+		.port = PORT,
+		.addr_lo = addr_lo,
+		.addr_hi = addr_hi,
+	};
+
+	return test_send_host_command(EC_CMD_I2C_TRACE, 0, &p, sizeof(p),
+				      &resp, sizeof(resp));
+}
+
+static int test_record(void)
+{
+	const uint8_t out[2] = { 0x01, 0x02 };
+	uint8_t in[3];
+	const struct ec_i2c_trace_record *rec;
+
+	TEST_EQ(trace_command(EC_I2C_TRACE_ENABLE, TRACED_ADDR, TRACED_ADDR),
+		EC_RES_SUCCESS, "%d");
+
+	TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, out, sizeof(out), in, sizeof(in)),
+		EC_SUCCESS, "%d");
+	/* Not traced */
+	TEST_EQ(i2c_xfer(PORT, OTHER_ADDR, out, sizeof(out), in, sizeof(in)),
+		EC_SUCCESS, "%d");
+	TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, out, 1, NULL, 0), EC_SUCCESS,
+		"%d");
+
+	TEST_EQ(trace_command(EC_I2C_TRACE_READ, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.dropped, 0, "%d");
+	TEST_EQ(resp.r.size, (int)(2 * sizeof(*rec) + 5 + 1), "%d");
+
+	rec = (void *)resp.r.records;
+	TEST_EQ(rec->port, PORT, "%d");
+	TEST_EQ(I2C_STRIP_FLAGS(rec->addr_flags), TRACED_ADDR, "%d");
+	TEST_EQ(rec->flags, 0, "%d");
+	TEST_EQ(rec->out_size, 2, "%d");
+	TEST_EQ(rec->in_size, 3, "%d");
+	TEST_ASSERT(rec->data[0] == 0x01 && rec->data[1] == 0x02);
+	TEST_ASSERT(rec->data[2] == 0xa0 && rec->data[4] == 0xa2);
+
+	rec = (void *)(resp.r.records + sizeof(*rec) + 5);
+	TEST_EQ(rec->out_size, 1, "%d");
+	TEST_EQ(rec->in_size, 0, "%d");
+
+	/* The ring is empty now */
+	TEST_EQ(trace_command(EC_I2C_TRACE_READ, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.size, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_truncated(void)
+{
+	uint8_t in[100];
+	const struct ec_i2c_trace_record *rec = (void *)resp.r.records;
+
+	TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, NULL, 0, in, sizeof(in)),
+		EC_SUCCESS, "%d");
+	TEST_EQ(trace_command(EC_I2C_TRACE_READ, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(rec->flags, EC_I2C_TRACE_TRUNCATED, "%d");
+	TEST_LT(rec->in_size, (int)sizeof(in), "%d");
+	TEST_EQ(resp.r.size, (int)sizeof(*rec) + rec->in_size, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_overflow(void)
+{
+	uint8_t in[8];
+	int size = sizeof(struct ec_i2c_trace_record) + sizeof(in);
+	int fit = CONFIG_I2C_TRACE_BUFFER_SIZE / size;
+	int i, total = 0;
+
+	for (i = 0; i < fit + 5; i++)
+		i2c_xfer(PORT, TRACED_ADDR, NULL, 0, in, sizeof(in));
+
+	/* Drain in several reads; only whole records come back */
+	do {
+		TEST_EQ(trace_command(EC_I2C_TRACE_READ, 0, 0),
+			EC_RES_SUCCESS, "%d");
+		TEST_EQ(resp.r.size % size, 0, "%d");
+		if (total == 0)
+			TEST_EQ(resp.r.dropped, 5, "%d");
+		else
+			TEST_EQ(resp.r.dropped, 0, "%d");
+		total += resp.r.size;
+	} while (resp.r.size);
+	TEST_EQ(total, fit * size, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_disable(void)
+{
+	uint8_t in[1];
+
+	TEST_EQ(trace_command(EC_I2C_TRACE_DISABLE, 0, 0), EC_RES_SUCCESS,
+		"%d");
+	i2c_xfer(PORT, TRACED_ADDR, NULL, 0, in, sizeof(in));
+	TEST_EQ(trace_command(EC_I2C_TRACE_READ, 0, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.size, 0, "%d");
+
+	/* Bad ranges are refused */
+	TEST_EQ(trace_command(EC_I2C_TRACE_ENABLE, 0x30, 0x20),
+		EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_record);
+	RUN_TEST(test_truncated);
+	RUN_TEST(test_overflow);
+	RUN_TEST(test_disable);
+
+	test_print_result();
+}
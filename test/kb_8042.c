@@ -11,6 +11,7 @@
 #include "gpio.h"
 #include "i8042_protocol.h"
 #include "keyboard_8042.h"
+#include "keyboard_latency.h"
 #include "keyboard_protocol.h"
 #include "keyboard_scan.h"
 #include "lpc.h"
@@ -138,6 +139,52 @@ static int test_single_key_press(void)
 	return EC_SUCCESS;
 }
 
+static int test_latency_stats(void)
+{
+	struct ec_params_keyboard_latency p = {
+		.flags = EC_KEYBOARD_LATENCY_CLEAR,
+	};
+	struct ec_response_keyboard_latency r;
+	int i;
+
+	TEST_ASSERT(test_send_host_command(EC_CMD_KEYBOARD_LATENCY, 0,
+					   &p, sizeof(p), &r, sizeof(r)) ==
+		    EC_RES_SUCCESS);
+
+	enable_keystroke(1);
+
+	/* Keys which didn't come from a scan aren't counted */
+	press_key(1, 1, 1);
+	VERIFY_LPC_CHAR("\x01");
+	press_key(1, 1, 0);
+	VERIFY_LPC_CHAR("\x81");
+
+	/* A scanned key is timed byte by byte */
+	keyboard_latency_scan(get_time().le.lo);
+	press_key(12, 6, 1);
+	VERIFY_LPC_CHAR("\xe0\x4d");
+	press_key(12, 6, 0);
+	VERIFY_LPC_CHAR("\xe0\xcd");
+
+	p.flags = 0;
+	TEST_ASSERT(test_send_host_command(EC_CMD_KEYBOARD_LATENCY, 0,
+					   &p, sizeof(p), &r, sizeof(r)) ==
+		    EC_RES_SUCCESS);
+
+	TEST_EQ(r.stage[EC_KEYBOARD_LATENCY_SCAN].count, 1, "%d");
+	TEST_EQ(r.stage[EC_KEYBOARD_LATENCY_QUEUE].count, 2, "%d");
+	TEST_EQ(r.stage[EC_KEYBOARD_LATENCY_HOST].count, 2, "%d");
+	TEST_EQ(r.stage[EC_KEYBOARD_LATENCY_TOTAL].count, 2, "%d");
+	for (i = 0; i < EC_KEYBOARD_LATENCY_STAGE_COUNT; i++) {
+		TEST_LE(r.stage[i].p50_us, r.stage[i].p99_us, "%d");
+		TEST_LE(r.stage[i].p99_us, r.stage[i].max_us, "%d");
+	}
+	TEST_LE(r.stage[EC_KEYBOARD_LATENCY_QUEUE].max_us,
+		r.stage[EC_KEYBOARD_LATENCY_TOTAL].max_us, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int test_disable_keystroke(void)
 {
 	enable_keystroke(0);
@@ -330,6 +377,7 @@ void run_test(int argc, char **argv)
 
 	if (system_get_image_copy() == EC_IMAGE_RO) {
 		RUN_TEST(test_single_key_press);
+		RUN_TEST(test_latency_stats);
 		RUN_TEST(test_disable_keystroke);
 		RUN_TEST(test_typematic);
 		RUN_TEST(test_scancode_set2);
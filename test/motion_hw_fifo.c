@@ -0,0 +1,216 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test batch reads of sensor hardware FIFOs by the motion sense task.
+ */
+
+#include "accelgyro.h"
+#include "common.h"
+#include "ec_commands.h"
+#include "hooks.h"
+#include "host_command.h"
+#include "hwtimer.h"
+#include "motion_sense.h"
+#include "motion_sense_fifo.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+/* 100 Hz, with the AP accepting 100 ms of latency */
+#define TEST_ODR 100000
+#define TEST_PERIOD (10 * MSEC)
+#define TEST_EC_RATE (100 * MSEC)
+
+/* Depth of the mock hardware FIFO */
+#define MOCK_FIFO_DEPTH 32
+
+/*****************************************************************************/
+/* Mock sensor with a hardware FIFO filled at the data rate */
+static int data_rate;
+static uint32_t fifo_filled_until;
+static int fifo_count;
+static int next_sample;
+static int read_fifo_calls;
+
+static int accel_init(struct motion_sensor_t *s)
+{
+	return sensor_init_done(s);
+}
+
+static int accel_read(const struct motion_sensor_t *s, intv3_t v)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+
+static int accel_read_fifo(const struct motion_sensor_t *s, intv3_t *v,
+			   int max, int *count)
+{
+	uint32_t now = __hw_clock_source_read();
+	int i, n;
+
+	n = (now - fifo_filled_until) / TEST_PERIOD;
+	fifo_filled_until += n * TEST_PERIOD;
+	fifo_count = MIN(fifo_count + n, MOCK_FIFO_DEPTH);
+
+	*count = MIN(fifo_count, max);
+	for (i = 0; i < *count; i++) {
+		v[i][X] = next_sample++;
+		v[i][Y] = 0;
+		v[i][Z] = 0;
+	}
+	fifo_count -= *count;
+	read_fifo_calls++;
+
+	return EC_SUCCESS;
+}
+
+static int accel_set_range(struct motion_sensor_t *s, int range, int rnd)
+{
+	s->current_range = range;
+	return EC_SUCCESS;
+}
+
+static int accel_get_resolution(const struct motion_sensor_t *s)
+{
+	return 16;
+}
+
+static int accel_set_data_rate(const struct motion_sensor_t *s, int rate,
+			       int rnd)
+{
+	data_rate = rate;
+	fifo_filled_until = __hw_clock_source_read();
+	fifo_count = 0;
+	return EC_SUCCESS;
+}
+
+static int accel_get_data_rate(const struct motion_sensor_t *s)
+{
+	return data_rate;
+}
+
+const struct accelgyro_drv test_hw_fifo_drv = {
+	.init = accel_init,
+	.read = accel_read,
+	.read_fifo = accel_read_fifo,
+	.set_range = accel_set_range,
+	.get_resolution = accel_get_resolution,
+	.set_data_rate = accel_set_data_rate,
+	.get_data_rate = accel_get_data_rate,
+};
+
+struct motion_sensor_t motion_sensors[] = {
+	[BASE] = {
+		.name = "base",
+		.active_mask = SENSOR_ACTIVE_S0,
+		.chip = MOTIONSENSE_CHIP_LIS2DH,
+		.type = MOTIONSENSE_TYPE_ACCEL,
+		.location = MOTIONSENSE_LOC_BASE,
+		.drv = &test_hw_fifo_drv,
+		.rot_standard_ref = NULL,
+		.default_range = 2,
+		.config = {
+			[SENSOR_CONFIG_EC_S0] = {
+				.odr = TEST_ODR,
+				.ec_rate = TEST_EC_RATE,
+			},
+		},
+	},
+};
+const unsigned int motion_sensor_count = ARRAY_SIZE(motion_sensors);
+
+/*****************************************************************************/
+/* Tests */
+
+/* Ask for the data as the AP does, with the latency it accepts */
+static int set_ap_rate(int odr, int ec_rate_ms)
+{
+	struct ec_params_motion_sense params;
+	struct ec_response_motion_sense resp;
+
+	params.cmd = MOTIONSENSE_CMD_EC_RATE;
+	params.ec_rate.sensor_num = BASE;
+	params.ec_rate.data = ec_rate_ms;
+	if (test_send_host_command(EC_CMD_MOTION_SENSE_CMD, 3, &params,
+				   sizeof(params), &resp, sizeof(resp)))
+		return EC_ERROR_UNKNOWN;
+
+	params.cmd = MOTIONSENSE_CMD_SENSOR_ODR;
+	params.sensor_odr.sensor_num = BASE;
+	params.sensor_odr.data = odr;
+	params.sensor_odr.roundup = 0;
+	if (test_send_host_command(EC_CMD_MOTION_SENSE_CMD, 3, &params,
+				   sizeof(params), &resp, sizeof(resp)))
+		return EC_ERROR_UNKNOWN;
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_drain(void)
+{
+	struct motion_sensor_t *s = &motion_sensors[BASE];
+	struct ec_response_motion_sensor_data data[64];
+	uint32_t timestamp = 0, last_timestamp = 0;
+	int expected_sample = -1;
+	int samples = 0;
+	int calls, read_count, i;
+	uint16_t data_bytes_read;
+
+	/* Go to S0 */
+	hook_notify(HOOK_CHIPSET_SUSPEND);
+	hook_notify(HOOK_CHIPSET_RESUME);
+	msleep(50);
+	TEST_EQ(set_ap_rate(TEST_ODR, TEST_EC_RATE / MSEC), EC_SUCCESS, "%d");
+	msleep(50);
+	TEST_EQ(data_rate, TEST_ODR, "%d");
+
+	/* 8 samples per read: the batch limit, under the 100 ms latency */
+	TEST_EQ(s->collection_rate, (uint32_t)TEST_PERIOD * 8, "%d");
+
+	calls = read_fifo_calls;
+	msleep(1000);
+	calls = read_fifo_calls - calls;
+	/* About 12 reads instead of 100 */
+	TEST_GE(calls, 10, "%d");
+	TEST_LE(calls, 14, "%d");
+
+	do {
+		read_count = motion_sense_fifo_read(sizeof(data),
+						    ARRAY_SIZE(data), data,
+						    &data_bytes_read);
+		for (i = 0; i < read_count; i++) {
+			if (data[i].flags & MOTIONSENSE_SENSOR_FLAG_TIMESTAMP) {
+				timestamp = data[i].timestamp;
+				continue;
+			}
+			if (data[i].flags)
+				continue;
+
+			/* No sample lost or repeated, a data period apart */
+			if (expected_sample >= 0) {
+				TEST_EQ(data[i].data[X], expected_sample,
+					"%d");
+				TEST_NEAR(timestamp - last_timestamp,
+					  (uint32_t)TEST_PERIOD, 100, "%d");
+			}
+			expected_sample = data[i].data[X] + 1;
+			last_timestamp = timestamp;
+			samples++;
+		}
+	} while (read_count);
+
+	/* One second of samples at 100 Hz, give or take a batch */
+	TEST_GE(samples, 90, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_batch_drain);
+
+	test_print_result();
+}
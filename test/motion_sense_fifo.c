@@ -348,6 +348,37 @@ static int test_commit_non_data_or_timestamp_entries(void)
 	return EC_SUCCESS;
 }
 
+static int test_read_wraps_around(void)
+{
+	int i, read_count;
+
+	/* Leave 150 entries spanning the end of the buffer */
+	for (i = 0; i < 200; i++)
+		motion_sense_fifo_add_timestamp(i);
+	read_count = motion_sense_fifo_read(150 * sizeof(data[0]),
+					    CONFIG_ACCEL_FIFO_SIZE, data,
+					    &data_bytes_read);
+	TEST_EQ(read_count, 150, "%d");
+	for (i = 200; i < 300; i++)
+		motion_sense_fifo_add_timestamp(i);
+
+	/* Capped by the buffer size */
+	read_count = motion_sense_fifo_read(
+		10 * sizeof(data[0]) + 1, CONFIG_ACCEL_FIFO_SIZE, data,
+		&data_bytes_read);
+	TEST_EQ(read_count, 10, "%d");
+	TEST_EQ(data[9].timestamp, 159, "%u");
+
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, 140, "%d");
+	TEST_EQ(data_bytes_read, (int)(140 * sizeof(data[0])), "%d");
+	for (i = 0; i < read_count; i++)
+		TEST_EQ(data[i].timestamp, 160 + i, "%u");
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	motion_sense_fifo_commit_data();
@@ -377,6 +408,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_spread_data_by_collection_rate);
 	RUN_TEST(test_spread_double_commit_same_timestamp);
 	RUN_TEST(test_commit_non_data_or_timestamp_entries);
+	RUN_TEST(test_read_wraps_around);
 
 	test_print_result();
 }
@@ -0,0 +1,198 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for mutex priority inheritance and hand-over.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "task.h"
+#include "task_mutex.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+static struct mutex mtx;
+
+/* Order in which the tasks got to run once the owner was released */
+static char order[8];
+static int order_len;
+/* Whether the low priority waiter still waited when the high one got in */
+static int waiter_still_waiting;
+
+static void record(char c)
+{
+	if (order_len < sizeof(order) - 1)
+		order[order_len++] = c;
+}
+
+/* Takes the mutex, then holds it until woken up again */
+int mutex_low_task(void *unused)
+{
+	while (1) {
+		task_wait_event(-1);
+		mutex_lock(&mtx);
+		task_wait_event(-1);
+		record('L');
+		mutex_unlock(&mtx);
+	}
+	return EC_SUCCESS;
+}
+
+/* Waits for the mutex at a priority below the medium task */
+int mutex_waiter_task(void *unused)
+{
+	while (1) {
+		task_wait_event(-1);
+		mutex_lock(&mtx);
+		record('W');
+		mutex_unlock(&mtx);
+	}
+	return EC_SUCCESS;
+}
+
+/* Doesn't touch the mutex, but may preempt its owner */
+int mutex_medium_task(void *unused)
+{
+	while (1) {
+		task_wait_event(-1);
+		record('M');
+	}
+	return EC_SUCCESS;
+}
+
+int mutex_high_task(void *unused)
+{
+	while (1) {
+		task_wait_event(-1);
+		mutex_lock(&mtx);
+		waiter_still_waiting = !!(mtx.waiters & BIT(TASK_ID_MTXW));
+		record('H');
+		mutex_unlock(&mtx);
+	}
+	return EC_SUCCESS;
+}
+
+test_static int test_next_task_plain(void)
+{
+	static struct mutex *blocked_on[TASK_ID_COUNT];
+
+	/* Nobody waits for a mutex: highest priority first */
+	TEST_EQ(mutex_next_task(BIT(TASK_ID_MTXL) | BIT(TASK_ID_MTXM), 0,
+				blocked_on), TASK_ID_MTXM, "%d");
+	return EC_SUCCESS;
+}
+
+test_static int test_next_task_inherit(void)
+{
+	static struct mutex *blocked_on[TASK_ID_COUNT];
+	struct mutex m = { .lock = MUTEX_OWNER(TASK_ID_MTXL) };
+	uint32_t runnable = BIT(TASK_ID_MTXL) | BIT(TASK_ID_MTXM);
+
+	/* A waiter below the medium task doesn't lift the owner past it */
+	blocked_on[TASK_ID_MTXW] = &m;
+	TEST_EQ(mutex_next_task(runnable, BIT(TASK_ID_MTXW), blocked_on),
+		TASK_ID_MTXM, "%d");
+
+	/* One above it does */
+	blocked_on[TASK_ID_MTXH] = &m;
+	TEST_EQ(mutex_next_task(runnable,
+				BIT(TASK_ID_MTXW) | BIT(TASK_ID_MTXH),
+				blocked_on), TASK_ID_MTXL, "%d");
+
+	/* Unless the owner can't run either */
+	TEST_EQ(mutex_next_task(BIT(TASK_ID_MTXM),
+				BIT(TASK_ID_MTXW) | BIT(TASK_ID_MTXH),
+				blocked_on), TASK_ID_MTXM, "%d");
+	TEST_EQ(mutex_next_task(BIT(TASK_ID_IDLE), BIT(TASK_ID_MTXH),
+				blocked_on), TASK_ID_IDLE, "%d");
+	return EC_SUCCESS;
+}
+
+test_static int test_next_task_chain(void)
+{
+	static struct mutex *blocked_on[TASK_ID_COUNT];
+	struct mutex a = { .lock = MUTEX_OWNER(TASK_ID_MTXW) };
+	struct mutex b = { .lock = MUTEX_OWNER(TASK_ID_MTXL) };
+	uint32_t runnable = BIT(TASK_ID_MTXL) | BIT(TASK_ID_MTXM);
+	uint32_t blocked = BIT(TASK_ID_MTXH) | BIT(TASK_ID_MTXW);
+
+	/* H waits for W, which itself waits for L: L runs for H */
+	blocked_on[TASK_ID_MTXH] = &a;
+	blocked_on[TASK_ID_MTXW] = &b;
+	TEST_EQ(mutex_next_task(runnable, blocked, blocked_on),
+		TASK_ID_MTXL, "%d");
+	return EC_SUCCESS;
+}
+
+test_static int test_hand_over(void)
+{
+	struct mutex m = { .lock = MUTEX_OWNER(TASK_ID_MTXL) };
+
+	m.waiters = BIT(TASK_ID_MTXW) | BIT(TASK_ID_MTXH);
+	TEST_EQ(mutex_hand_over(&m), TASK_ID_MTXH, "%d");
+	TEST_EQ(m.lock, MUTEX_OWNER(TASK_ID_MTXH), "%d");
+	TEST_EQ(mutex_hand_over(&m), TASK_ID_MTXW, "%d");
+	TEST_EQ(m.lock, MUTEX_OWNER(TASK_ID_MTXW), "%d");
+	TEST_EQ(mutex_hand_over(&m), TASK_ID_INVALID, "%d");
+	TEST_EQ(m.lock, 0, "%d");
+	return EC_SUCCESS;
+}
+
+test_static int test_inversion(void)
+{
+	/* The low priority task takes the mutex and keeps it */
+	task_wake(TASK_ID_MTXL);
+	msleep(1);
+	TEST_EQ(mtx.lock, MUTEX_OWNER(TASK_ID_MTXL), "%d");
+
+	/* Then a low and a high priority task wait for it */
+	task_wake(TASK_ID_MTXW);
+	msleep(1);
+	task_wake(TASK_ID_MTXH);
+	msleep(1);
+	TEST_EQ(mtx.waiters, BIT(TASK_ID_MTXW) | BIT(TASK_ID_MTXH), "%x");
+
+	/*
+	 * The owner and the medium priority task become ready together. The
+	 * owner runs at the high waiter's priority, then hands the mutex to it
+	 * directly; the low waiter only gets it after the medium task.
+	 */
+	order_len = 0;
+	task_wake(TASK_ID_MTXL);
+	task_wake(TASK_ID_MTXM);
+	msleep(1);
+
+	TEST_ASSERT_ARRAY_EQ(order, "LHMW", 4);
+	TEST_EQ(order_len, 4, "%d");
+	TEST_ASSERT(waiter_still_waiting);
+	TEST_EQ(mtx.lock, 0, "%d");
+	TEST_EQ(mtx.waiters, 0, "%x");
+	return EC_SUCCESS;
+}
+
+int mutex_inherit_main_task(void *unused)
+{
+	task_wait_event(-1);
+
+	test_reset();
+
+	RUN_TEST(test_next_task_plain);
+	RUN_TEST(test_next_task_inherit);
+	RUN_TEST(test_next_task_chain);
+	RUN_TEST(test_hand_over);
+	RUN_TEST(test_inversion);
+
+	test_print_result();
+
+	while (1)
+		task_wait_event(-1);
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	wait_for_task_started();
+	task_wake(TASK_ID_MTXMAIN);
+}
@@ -0,0 +1,219 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the power timeline and EC_CMD_POWER_TIMELINE.
+ */
+
+#include "chipset.h"
+#include "common.h"
+#include "ec_commands.h"
+#include "gpio.h"
+#include "host_command.h"
+#include "power.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define SIZE CONFIG_POWER_TIMELINE_SIZE
+
+const struct power_signal_info power_signal_list[] = {
+	[TEST_SIGNAL_A] = {
+		.gpio = GPIO_PCH_BKLTEN,
+		.flags = POWER_SIGNAL_ACTIVE_HIGH,
+		.name = "SIGNAL_A",
+	},
+	[TEST_SIGNAL_B] = {
+		.gpio = GPIO_ENABLE_BACKLIGHT,
+		.flags = POWER_SIGNAL_ACTIVE_HIGH,
+		.name = "SIGNAL_B",
+	},
+};
+BUILD_ASSERT(ARRAY_SIZE(power_signal_list) == POWER_SIGNAL_COUNT);
+
+/* A chipset that stays in whatever steady state the test sets */
+enum power_state power_chipset_init(void)
+{
+	return POWER_G3;
+}
+
+enum power_state power_handle_state(enum power_state state)
+{
+	return state;
+}
+
+static struct {
+	struct ec_response_power_timeline r;
+	struct ec_power_timeline_entry entries[SIZE];
+} resp;
+
+/* Read the timeline from seq, with room for at most max entries */
+static int read_timeline(uint32_t seq, int max, uint8_t flags)
+{
+	struct ec_params_power_timeline p = {
+		.seq = seq,
+		.flags = flags,
+	};
+
+	memset(&resp, 0, sizeof(resp));
+	return test_send_host_command(EC_CMD_POWER_TIMELINE, 0, &p, sizeof(p),
+				      &resp, sizeof(resp.r) +
+				      max * sizeof(resp.entries[0]));
+}
+
+/* Empty the timeline, returning the number of the next entry */
+static uint32_t clear_timeline(void)
+{
+	read_timeline(0, SIZE, EC_POWER_TIMELINE_CLEAR);
+	return resp.r.seq + resp.r.count;
+}
+
+static void edge(enum gpio_signal signal, int level)
+{
+	gpio_set_level(signal, level);
+	power_signal_interrupt(signal);
+}
+
+test_static int test_entries(void)
+{
+	uint32_t start = clear_timeline();
+	struct ec_power_timeline_entry *e = resp.entries;
+
+	edge(GPIO_PCH_BKLTEN, 1);
+	power_set_state(POWER_S3);
+	edge(GPIO_ENABLE_BACKLIGHT, 1);
+	edge(GPIO_PCH_BKLTEN, 0);
+
+	TEST_EQ(read_timeline(start, SIZE, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start, "%u");
+	TEST_EQ(resp.r.count, 4, "%d");
+	TEST_EQ(resp.r.dropped, 0, "%d");
+
+	TEST_EQ(e[0].type, EC_POWER_TIMELINE_EDGE, "%d");
+	TEST_EQ(e[0].id, TEST_SIGNAL_A, "%d");
+	TEST_EQ(e[0].level, 1, "%d");
+	TEST_EQ(e[0].signals, POWER_SIGNAL_MASK(TEST_SIGNAL_A), "%x");
+
+	TEST_EQ(e[1].type, EC_POWER_TIMELINE_STATE, "%d");
+	TEST_EQ(e[1].id, POWER_S3, "%d");
+
+	TEST_EQ(e[2].type, EC_POWER_TIMELINE_EDGE, "%d");
+	TEST_EQ(e[2].id, TEST_SIGNAL_B, "%d");
+	TEST_EQ(e[2].signals, POWER_SIGNAL_MASK(TEST_SIGNAL_A) |
+			      POWER_SIGNAL_MASK(TEST_SIGNAL_B), "%x");
+
+	TEST_EQ(e[3].id, TEST_SIGNAL_A, "%d");
+	TEST_EQ(e[3].level, 0, "%d");
+	TEST_EQ(e[3].signals, POWER_SIGNAL_MASK(TEST_SIGNAL_B), "%x");
+
+	/* Oldest first, in hardware timer order */
+	TEST_ASSERT((int32_t)(e[3].timestamp - e[0].timestamp) >= 0);
+
+	edge(GPIO_ENABLE_BACKLIGHT, 0);
+	power_set_state(POWER_G3);
+	return EC_SUCCESS;
+}
+
+test_static int test_paging(void)
+{
+	uint32_t start = clear_timeline();
+	int i;
+
+	for (i = 0; i < 5; i++)
+		edge(GPIO_PCH_BKLTEN, !(i & 1));
+
+	/* Pages of 3 entries, read from seq + count until count is 0 */
+	TEST_EQ(read_timeline(start, 3, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start, "%u");
+	TEST_EQ(resp.r.count, 3, "%d");
+	TEST_EQ(resp.entries[2].level, 1, "%d");
+
+	TEST_EQ(read_timeline(start + 3, 3, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start + 3, "%u");
+	TEST_EQ(resp.r.count, 2, "%d");
+	TEST_EQ(resp.entries[0].level, 0, "%d");
+	TEST_EQ(resp.entries[1].level, 1, "%d");
+
+	TEST_EQ(read_timeline(start + 5, 3, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start + 5, "%u");
+	TEST_EQ(resp.r.count, 0, "%d");
+
+	/* Reading doesn't remove anything */
+	TEST_EQ(read_timeline(start, SIZE, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 5, "%d");
+
+	edge(GPIO_PCH_BKLTEN, 0);
+	return EC_SUCCESS;
+}
+
+test_static int test_dropped(void)
+{
+	uint32_t start = clear_timeline();
+	int i;
+
+	/* Wrap the ring: the first 3 entries get overwritten */
+	for (i = 0; i < SIZE + 3; i++)
+		edge(GPIO_PCH_BKLTEN, !(i & 1));
+
+	/* Asking for dropped entries starts from the oldest one kept */
+	TEST_EQ(read_timeline(start, SIZE, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start + 3, "%u");
+	TEST_EQ(resp.r.count, SIZE, "%d");
+	TEST_EQ(resp.r.dropped, 3, "%d");
+	for (i = 0; i < SIZE; i++)
+		TEST_EQ(resp.entries[i].level, !((i + 3) & 1), "%d");
+
+	/* Past the newest entry there is nothing to read */
+	TEST_EQ(read_timeline(start + SIZE + 10, SIZE, 0), EC_RES_SUCCESS,
+		"%d");
+	TEST_EQ(resp.r.seq, start + SIZE + 3, "%u");
+	TEST_EQ(resp.r.count, 0, "%d");
+
+	edge(GPIO_PCH_BKLTEN, 0);
+	return EC_SUCCESS;
+}
+
+test_static int test_clear(void)
+{
+	uint32_t start;
+	int i;
+
+	for (i = 0; i < SIZE + 1; i++)
+		edge(GPIO_PCH_BKLTEN, !(i & 1));
+
+	/* Clearing still returns what was there */
+	TEST_EQ(read_timeline(0, SIZE, EC_POWER_TIMELINE_CLEAR),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, SIZE, "%d");
+	TEST_ASSERT(resp.r.dropped > 0);
+	start = resp.r.seq + resp.r.count;
+
+	/* ... then empties the timeline and resets dropped */
+	TEST_EQ(read_timeline(0, SIZE, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start, "%u");
+	TEST_EQ(resp.r.count, 0, "%d");
+	TEST_EQ(resp.r.dropped, 0, "%d");
+
+	power_set_state(POWER_S0);
+	TEST_EQ(read_timeline(0, SIZE, 0), EC_RES_SUCCESS, "%d");
+	TEST_EQ(resp.r.seq, start, "%u");
+	TEST_EQ(resp.r.count, 1, "%d");
+	TEST_EQ(resp.entries[0].type, EC_POWER_TIMELINE_STATE, "%d");
+	TEST_EQ(resp.entries[0].id, POWER_S0, "%d");
+
+	edge(GPIO_PCH_BKLTEN, 0);
+	power_set_state(POWER_G3);
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_entries);
+	RUN_TEST(test_paging);
+	RUN_TEST(test_dropped);
+	RUN_TEST(test_clear);
+
+	test_print_result();
+}
@@ -6,6 +6,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <time.h>
 
 #include "common.h"
 #include "printf.h"
@@ -293,6 +294,191 @@ test_static int test_vsnprintf_combined(void)
 	return EC_SUCCESS;
 }
 
+/* Sinks standing in for the UART ring in the benchmark below */
+static int sink_pos;
+
+static int sink_addchar(void *context, int c)
+{
+	output[sink_pos++ & (sizeof(output) - 1)] = c;
+	return 0;
+}
+
+static int sink_addstr(void *context, const char *str, int len)
+{
+	while (len--)
+		sink_addchar(context, *str++);
+	return 0;
+}
+
+static int sink_addstr_memcpy(void *context, const char *str, int len)
+{
+	int pos = sink_pos & (sizeof(output) - 1);
+	int first = MIN(len, (int)sizeof(output) - pos);
+
+	memcpy(output + pos, str, first);
+	memcpy(output, str + first, len - first);
+	sink_pos += len;
+	return 0;
+}
+
+static int bench_line(int (*addstr)(void *context, const char *str, int len),
+		      ...)
+{
+	va_list args;
+	int rv;
+
+	va_start(args, addstr);
+	if (addstr)
+		rv = vfnprintf_span(sink_addchar, addstr, NULL,
+				    "C%d: PE %s -> %s, RDO 0x%08x, %dmV %dmA\n",
+				    args);
+	else
+		rv = vfnprintf(sink_addchar, NULL,
+			       "C%d: PE %s -> %s, RDO 0x%08x, %dmV %dmA\n",
+			       args);
+	va_end(args);
+	return rv;
+}
+
+/* get_time() is simulated on the host, so use the host clock */
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+test_static int test_benchmark(void)
+{
+	int (*const addstr[])(void *, const char *, int) = {
+		NULL, sink_addstr, sink_addstr_memcpy,
+	};
+	static const char * const name[] = {
+		"per char", "spans", "spans+memcpy",
+	};
+	uint64_t t0, t1;
+	int i, j;
+
+	BUILD_ASSERT((sizeof(output) & (sizeof(output) - 1)) == 0);
+
+	for (j = 0; j < ARRAY_SIZE(addstr); j++) {
+		sink_pos = 0;
+		t0 = host_ns();
+		for (i = 0; i < 1000; i++)
+			bench_line(addstr[j], 1, "SNK_READY",
+				   "SNK_TRANSITION_SINK", 0x1304b12c, 20000,
+				   3250);
+		t1 = host_ns();
+		ccprintf("%-12s %d lines: %lld ns/line\n", name[j], 1000,
+			 (long long)(t1 - t0) / 1000);
+		TEST_EQ(sink_pos, 1000 * 72, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
+#ifdef CONFIG_CONSOLE_TOKENIZED
+static uint8_t tokens[64];
+static int tokens_len;
+static int output_len;
+
+static int tokenize_collect(void *context, int c)
+{
+	if (output_len >= sizeof(output))
+		return 1;
+	output[output_len++] = c;
+	return 0;
+}
+
+static int base64_value(int c)
+{
+	if (c >= 'A' && c <= 'Z')
+		return c - 'A';
+	if (c >= 'a' && c <= 'z')
+		return c - 'a' + 26;
+	if (c >= '0' && c <= '9')
+		return c - '0' + 52;
+	if (c == '+')
+		return 62;
+	if (c == '/')
+		return 63;
+	return -1;
+}
+
+/* Tokenize, check the line framing, and base64-decode into tokens[] */
+static int tokenize(const char *format, ...)
+{
+	va_list args;
+	int i, n = 0;
+	uint32_t group = 0;
+	int bits = 0;
+
+	output_len = 0;
+	va_start(args, format);
+	TEST_EQ(vfntokenize(tokenize_collect, NULL, 0, format, args),
+		EC_SUCCESS, "%d");
+	va_end(args);
+
+	TEST_EQ(output[0], TOKENIZE_MARKER, "%c");
+	TEST_EQ(output[output_len - 1], '\n', "%c");
+	TEST_EQ((output_len - 2) % 4, 0, "%d");
+
+	for (i = 1; i < output_len - 1 && output[i] != '='; i++) {
+		int v = base64_value(output[i]);
+
+		TEST_ASSERT(v >= 0);
+		group = (group << 6) | v;
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			TEST_ASSERT(n < sizeof(tokens));
+			tokens[n++] = group >> bits;
+		}
+	}
+	tokens_len = n;
+
+	/* Flags, then the format string address */
+	TEST_EQ(tokens[0] & TOKENIZE_TIMESTAMP, 0, "%d");
+	TEST_EQ(tokens[1] | tokens[2] << 8 | tokens[3] << 16 |
+		(uint32_t)tokens[4] << 24, (uint32_t)(uintptr_t)format,
+		"0x%08x");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_vfntokenize(void)
+{
+	const char bytes[] = {0x00, 0x5E};
+	const uint8_t want_int[] = {0x05, 0x81, 0x01, 0xf6, 0x01};
+	const uint8_t want_str[] = {0x02, 'a', 'b', 0x02, 'x', 'y'};
+	const uint8_t want_ptr[] = {0x02, 0x00, 0x5e, 0x06, 0x05, 0xc8, 0x01};
+	uint64_t ts = 200;
+
+	/* Zigzag for signed, plain LEB128 for unsigned */
+	T(tokenize("%d %x %c", -3, 0x81, '{'));
+	TEST_EQ(tokens_len, 5 + (int)sizeof(want_int), "%d");
+	TEST_ASSERT_ARRAY_EQ(tokens + 5, want_int, sizeof(want_int));
+
+	/* Strings carry their length; precision truncates them */
+	T(tokenize("%s%.2s%%", "ab", "xyz"));
+	TEST_EQ(tokens_len, 5 + (int)sizeof(want_str), "%d");
+	TEST_ASSERT_ARRAY_EQ(tokens + 5, want_str, sizeof(want_str));
+
+	/* %ph sends the bytes, %pb count + 1 then value, %pT the time */
+	T(tokenize("%ph %pb %pT", HEX_BUF(bytes, 2), BINARY_VALUE(5, 5),
+		   &ts));
+	TEST_EQ(tokens_len, 5 + (int)sizeof(want_ptr), "%d");
+	TEST_ASSERT_ARRAY_EQ(tokens + 5, want_ptr, sizeof(want_ptr));
+
+	/* No arguments after a bad specifier */
+	T(tokenize("%q %d", 1));
+	TEST_EQ(tokens_len, 5, "%d");
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_CONSOLE_TOKENIZED */
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -305,6 +491,10 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_vsnprintf_timestamps);
 	RUN_TEST(test_vsnprintf_hexdump);
 	RUN_TEST(test_vsnprintf_combined);
+	RUN_TEST(test_benchmark);
+#ifdef CONFIG_CONSOLE_TOKENIZED
+	RUN_TEST(test_vfntokenize);
+#endif
 
 	test_print_result();
 }
@@ -0,0 +1,102 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the shared memory block pools.
+ */
+
+#include "common.h"
+#include "link_defs.h"
+#include "shared_mem.h"
+#include "test_util.h"
+
+/* Pools are SHMEM_POOL(64, 2) SHMEM_POOL(128, 1), see test_config.h */
+
+static int in_shared_buf(char *p)
+{
+	return p >= __shared_mem_buf &&
+	       p < __shared_mem_buf + shared_mem_size();
+}
+
+static int test_small_requests_use_pools(void)
+{
+	char *a, *b, *c;
+
+	TEST_ASSERT(shared_mem_acquire(16, &a) == EC_SUCCESS);
+	TEST_ASSERT(shared_mem_acquire(64, &b) == EC_SUCCESS);
+	TEST_ASSERT(shared_mem_acquire(100, &c) == EC_SUCCESS);
+
+	/* Without the pools the second request would get EC_ERROR_BUSY */
+	TEST_ASSERT(!in_shared_buf(a));
+	TEST_ASSERT(!in_shared_buf(b));
+	TEST_ASSERT(!in_shared_buf(c));
+	TEST_ASSERT(a != b);
+	TEST_ASSERT((uintptr_t)a % 8 == 0);
+	TEST_ASSERT((uintptr_t)c % 8 == 0);
+
+	shared_mem_release(a);
+	shared_mem_release(b);
+	shared_mem_release(c);
+
+	return EC_SUCCESS;
+}
+
+static int test_full_pool_spills(void)
+{
+	char *a, *b, *c, *d, *e;
+
+	TEST_ASSERT(shared_mem_acquire(32, &a) == EC_SUCCESS);
+	TEST_ASSERT(shared_mem_acquire(32, &b) == EC_SUCCESS);
+
+	/* The 64 byte pool is full, so the 128 byte pool serves this... */
+	TEST_ASSERT(shared_mem_acquire(32, &c) == EC_SUCCESS);
+	TEST_ASSERT(!in_shared_buf(c));
+
+	/* ...and then only the shared buffer is left, for one user */
+	TEST_ASSERT(shared_mem_acquire(32, &d) == EC_SUCCESS);
+	TEST_ASSERT(in_shared_buf(d));
+	TEST_ASSERT(shared_mem_acquire(32, &e) == EC_ERROR_BUSY);
+
+	/* A released block can be taken again */
+	shared_mem_release(b);
+	TEST_ASSERT(shared_mem_acquire(32, &e) == EC_SUCCESS);
+	TEST_ASSERT(e == b);
+
+	shared_mem_release(a);
+	shared_mem_release(c);
+	shared_mem_release(d);
+	shared_mem_release(e);
+
+	return EC_SUCCESS;
+}
+
+static int test_large_requests_use_shared_buf(void)
+{
+	char *a, *b;
+
+	TEST_ASSERT(shared_mem_acquire(129, &a) == EC_SUCCESS);
+	TEST_ASSERT(in_shared_buf(a));
+
+	/* Pools keep serving while the shared buffer is taken */
+	TEST_ASSERT(shared_mem_acquire(128, &b) == EC_SUCCESS);
+	TEST_ASSERT(!in_shared_buf(b));
+
+	shared_mem_release(b);
+	shared_mem_release(a);
+
+	TEST_ASSERT(shared_mem_acquire(129, &a) == EC_SUCCESS);
+	shared_mem_release(a);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_small_requests_use_pools);
+	RUN_TEST(test_full_pool_spills);
+	RUN_TEST(test_large_requests_use_shared_buf);
+
+	test_print_result();
+}
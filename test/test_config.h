@@ -31,6 +31,19 @@
 #define CONFIG_BASE32
 #endif
 
+#ifdef TEST_HOOKS
+#define CONFIG_CMD_DEFERRED
+#endif
+
+#ifdef TEST_HOST_COMMAND
+#define CONFIG_HOSTCMD_BATCH
+#define CONFIG_HOSTCMD_DISPATCH_TABLE
+#endif
+
+#ifdef TEST_HOST_COMMAND_BATCH
+#define CONFIG_HOSTCMD_BATCH
+#endif
+
 #ifdef TEST_BKLIGHT_LID
 #define CONFIG_BACKLIGHT_LID
 #endif
@@ -44,6 +57,18 @@
 #define CONFIG_EEPROM_CBI_WP
 #endif
 
+#ifdef TEST_EVENT_LOG
+#define CONFIG_USB_PD_LOGGING
+#define CONFIG_CMD_DLOG
+#endif
+
+#ifdef TEST_FLASH
+#define CONFIG_HOSTCMD_FLASH_BLOCK_HASH
+#define CONFIG_HOSTCMD_FLASH_READ_BULK
+#define CONFIG_SHA256
+#define CONFIG_SW_CRC
+#endif
+
 #ifdef TEST_FLASH_LOG
 #define CONFIG_CRC8
 #define CONFIG_FLASH_ERASED_VALUE32 (-1U)
@@ -53,8 +78,26 @@
 #define CONFIG_MALLOC
 #endif
 
+#ifdef TEST_POWER_TIMELINE
+enum power_signal {
+	TEST_SIGNAL_A,
+	TEST_SIGNAL_B,
+	POWER_SIGNAL_COUNT,
+};
+
+#define CONFIG_POWER_COMMON
+#define CONFIG_POWER_TIMELINE
+#undef CONFIG_POWER_TIMELINE_SIZE
+#define CONFIG_POWER_TIMELINE_SIZE 8
+#endif
+
+#ifdef TEST_PRINTF
+#define CONFIG_CONSOLE_TOKENIZED
+#endif
+
 #ifdef TEST_KB_8042
 #define CONFIG_KEYBOARD_PROTOCOL_8042
+#define CONFIG_KEYBOARD_LATENCY_STATS
 #endif
 
 #ifdef TEST_KB_MKBP
@@ -69,6 +112,8 @@
 #define CONFIG_MKBP_USE_GPIO
 #ifdef TEST_KB_SCAN_STRICT
 #define CONFIG_KEYBOARD_STRICT_DEBOUNCE
+#else
+#define CONFIG_KEYBOARD_SCAN_SLEEP_SETTLE
 #endif
 #endif
 
@@ -106,6 +151,19 @@
 #define CONFIG_SHA256
 #endif
 
+#ifdef TEST_MOTION_HW_FIFO
+enum sensor_id {
+	BASE,
+	SENSOR_COUNT,
+};
+
+#define CONFIG_ACCEL_FIFO
+#define CONFIG_ACCEL_FIFO_SIZE 256
+#define CONFIG_ACCEL_FIFO_THRES 10
+#define CONFIG_ACCEL_FORCE_MODE_MASK BIT(BASE)
+#define CONFIG_ACCEL_HW_FIFO_BATCH 8
+#endif
+
 #ifdef TEST_MOTION_SENSE_FIFO
 #define CONFIG_ACCEL_FIFO
 #define CONFIG_ACCEL_FIFO_SIZE 256
@@ -238,6 +296,7 @@ enum sensor_id {
 #ifdef TEST_CRC
 #define CONFIG_CRC8
 #define CONFIG_SW_CRC
+#define CONFIG_SW_CRC32_SLICE_BY_8
 #endif
 
 #ifdef TEST_RSA
@@ -267,6 +326,11 @@ enum sensor_id {
 #define CONFIG_MALLOC
 #endif
 
+#ifdef TEST_SHMEM_POOL
+#define CONFIG_SHMEM_POOLS
+#define CONFIG_SHMEM_POOL_LIST SHMEM_POOL(64, 2) SHMEM_POOL(128, 1)
+#endif
+
 #ifdef TEST_SBS_CHARGING_V2
 #define CONFIG_BATTERY
 #define CONFIG_BATTERY_V2
@@ -335,6 +399,10 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_ALS_LIGHTBAR_DIMMING 0
 #endif
 
+#ifdef TEST_UART_TASK_RINGS
+#define CONFIG_UART_TX_TASK_RINGS
+#endif
+
 #ifdef TEST_USB_COMMON
 #define CONFIG_USB_POWER_DELIVERY
 #define CONFIG_USB_PD_TCPMV1
@@ -533,6 +601,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_PD_DEBUG_LEVEL 3
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
 #define CONFIG_USB_PD_DECODE_SOP
+#define CONFIG_USB_PD_TCPC_ALERT_STATS
 #define CONFIG_USB_PD_3A_PORTS 0 /* Host does not define a 3.0 A PDO */
 #endif
 
@@ -633,5 +702,18 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define I2C_BITBANG_PORT_COUNT 1
 #endif
 
+#ifdef TEST_I2C_QUEUE
+#define CONFIG_I2C
+#define CONFIG_I2C_CONTROLLER
+#define CONFIG_I2C_XFER_QUEUE
+#endif
+
+#ifdef TEST_I2C_TRACE
+#define CONFIG_I2C
+#define CONFIG_I2C_CONTROLLER
+#define CONFIG_I2C_DEBUG
+#define CONFIG_I2C_TRACE_BINARY
+#endif
+
 #endif  /* TEST_BUILD */
 #endif  /* __TEST_TEST_CONFIG_H */
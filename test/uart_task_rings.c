@@ -0,0 +1,186 @@
+/* Copyright 2022 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the per-task console rings.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "uart.h"
+#include "util.h"
+
+enum writer_step {
+	WRITE_SECOND,
+	WRITE_OLDER,
+	WRITE_DONE,
+	WRITE_FLOOD,
+};
+
+static enum writer_step step;
+static int flood_lines;
+static int flood_rv;
+static int writer_ready;
+
+int writer_task(void *unused)
+{
+	writer_ready = 1;
+
+	while (1) {
+		task_wait_event(-1);
+
+		switch (step) {
+		case WRITE_SECOND:
+			uart_puts("second\n");
+			break;
+		case WRITE_OLDER:
+			uart_puts("older ");
+			break;
+		case WRITE_DONE:
+			uart_puts("done\n");
+			break;
+		case WRITE_FLOOD:
+			/* Fill our ring without letting the merge drain it */
+			flood_lines = 0;
+			while (!(flood_rv = uart_tx_str_raw(NULL, "flood5678\n",
+							    10)))
+				flood_lines++;
+			break;
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
+/* Have the writer task run one step while we wait */
+static void run_writer(enum writer_step s)
+{
+	step = s;
+	task_wake(TASK_ID_WRITER);
+	msleep(1);
+}
+
+static int count(const char *haystack, const char *needle)
+{
+	int n = 0;
+
+	while ((haystack = strstr(haystack, needle))) {
+		haystack++;
+		n++;
+	}
+	return n;
+}
+
+static int test_no_interleave(void)
+{
+	test_capture_console(1);
+	uart_puts("first ");
+	run_writer(WRITE_SECOND);
+	uart_puts("line\n");
+	uart_flush_output();
+	test_capture_console(0);
+
+	TEST_ASSERT(strstr(test_get_captured_console(),
+			   "first line\r\nsecond\r\n"));
+
+	return EC_SUCCESS;
+}
+
+static int test_line_order(void)
+{
+	test_capture_console(1);
+	run_writer(WRITE_OLDER);
+	uart_puts("newer\n");
+	run_writer(WRITE_DONE);
+	uart_flush_output();
+	test_capture_console(0);
+
+	/* Lines go out in the order they were started */
+	TEST_ASSERT(strstr(test_get_captured_console(),
+			   "older done\r\nnewer\r\n"));
+
+	return EC_SUCCESS;
+}
+
+static void isr_line(void)
+{
+	uart_tx_str_raw(NULL, "isr\n", 4);
+}
+
+static int test_interrupt(void)
+{
+	test_capture_console(1);
+	uart_puts("task ");
+	task_trigger_test_interrupt(isr_line);
+	uart_puts("line\n");
+	uart_flush_output();
+	test_capture_console(0);
+
+	TEST_ASSERT(strstr(test_get_captured_console(),
+			   "task line\r\nisr\n"));
+
+	return EC_SUCCESS;
+}
+
+static int test_overflow_isolated(void)
+{
+	test_capture_console(1);
+	run_writer(WRITE_FLOOD);
+
+	/* The writer overflowed its own ring ... */
+	TEST_ASSERT(flood_rv == 1);
+	TEST_ASSERT(flood_lines > 0);
+	TEST_ASSERT(uart_buffer_full() == 0);
+
+	/* ... which costs the other tasks nothing */
+	TEST_ASSERT(uart_puts("survivor\n") == EC_SUCCESS);
+	uart_flush_output();
+	test_capture_console(0);
+
+	TEST_ASSERT(strstr(test_get_captured_console(), "survivor\r\n"));
+	TEST_ASSERT(count(test_get_captured_console(), "flood5678\n") ==
+		    flood_lines);
+
+	return EC_SUCCESS;
+}
+
+static int test_long_line(void)
+{
+	char line[3 * CONFIG_UART_TX_TASK_RING_SIZE];
+	int i;
+
+	/* One print, longer than the ring, with nothing draining meanwhile */
+	for (i = 0; i < sizeof(line) - 2; i++)
+		line[i] = 'a' + i % 26;
+	line[i++] = '\n';
+	line[i] = '\0';
+
+	test_capture_console(1);
+	TEST_ASSERT(uart_puts(line) == EC_SUCCESS);
+	uart_flush_output();
+	test_capture_console(0);
+
+	line[sizeof(line) - 2] = '\0';
+	TEST_ASSERT(strstr(test_get_captured_console(), line));
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	while (!writer_ready)
+		msleep(1);
+
+	RUN_TEST(test_no_interleave);
+	RUN_TEST(test_line_order);
+	RUN_TEST(test_interrupt);
+	RUN_TEST(test_overflow_isolated);
+	RUN_TEST(test_long_line);
+
+	test_print_result();
+}
@@ -159,10 +159,71 @@ int test_pd_timers(void)
 	return EC_SUCCESS;
 }
 
+/*
+ * Verify the next expiration tracks the earliest active timer as timers are
+ * enabled, re-enabled and disabled out of order, and that managing expired
+ * timers only retires the ones that are due.
+ */
+int test_pd_timers_next_expiration_order(void)
+{
+	int next;
+	const int port = 0;
+
+	pd_timer_init(port);
+	TEST_EQ(pd_timer_next_expiration(port), -1, "%d");
+
+	pd_timer_enable(port, TC_TIMER_TIMEOUT, 5000);
+	pd_timer_enable(port, PE_TIMER_TIMEOUT, 3000);
+	pd_timer_enable(port, PR_TIMER_SINK_TX, 4000);
+	pd_timer_enable(port, PE_TIMER_NO_RESPONSE, 40000);
+	pd_timer_enable(port, TC_TIMER_CC_DEBOUNCE, 2000);
+
+	next = pd_timer_next_expiration(port);
+	TEST_GE(next, 1900, "%d");
+	TEST_LE(next, 2000, "%d");
+
+	/* Disabling the earliest timer exposes the next one */
+	pd_timer_disable(port, TC_TIMER_CC_DEBOUNCE);
+	next = pd_timer_next_expiration(port);
+	TEST_GE(next, 2900, "%d");
+	TEST_LE(next, 3000, "%d");
+
+	/* Pushing the earliest timer out moves it down the order */
+	pd_timer_enable(port, PE_TIMER_TIMEOUT, 10000);
+	next = pd_timer_next_expiration(port);
+	TEST_GE(next, 3900, "%d");
+	TEST_LE(next, 4000, "%d");
+
+	/* Pulling a later timer in moves it to the front */
+	pd_timer_enable(port, PE_TIMER_NO_RESPONSE, 1000);
+	next = pd_timer_next_expiration(port);
+	TEST_GE(next, 900, "%d");
+	TEST_LE(next, 1000, "%d");
+
+	/* Only the timers that are due are retired */
+	msleep(6);
+	pd_timer_manage_expired(port);
+	TEST_ASSERT(pd_timer_is_expired(port, PE_TIMER_NO_RESPONSE));
+	TEST_ASSERT(pd_timer_is_expired(port, PR_TIMER_SINK_TX));
+	TEST_ASSERT(pd_timer_is_expired(port, TC_TIMER_TIMEOUT));
+	TEST_ASSERT(!pd_timer_is_expired(port, PE_TIMER_TIMEOUT));
+	TEST_ASSERT(!pd_timer_is_disabled(port, TC_TIMER_TIMEOUT));
+
+	next = pd_timer_next_expiration(port);
+	TEST_GE(next, 3000, "%d");
+	TEST_LE(next, 4000, "%d");
+
+	pd_timer_disable(port, PE_TIMER_TIMEOUT);
+	TEST_EQ(pd_timer_next_expiration(port), -1, "%d");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	RUN_TEST(test_pd_timers_bit_ops);
 	RUN_TEST(test_pd_timers);
+	RUN_TEST(test_pd_timers_next_expiration_order);
 
 	test_print_result();
 }
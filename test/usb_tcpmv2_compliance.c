@@ -58,6 +58,7 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_connect_as_nonpd_sink);
 	RUN_TEST(test_retry_count_sop);
 	RUN_TEST(test_retry_count_hard_reset);
+	RUN_TEST(test_alert_i2c_xfers);
 
 	test_print_result();
 }
@@ -105,3 +105,44 @@ int test_retry_count_hard_reset(void)
 
 	return EC_SUCCESS;
 }
+
+int test_alert_i2c_xfers(void)
+{
+	/* DRP auto-toggling with AP in S0, source enabled. */
+	TEST_EQ(tcpci_startup(), EC_SUCCESS, "%d");
+	task_wait_event(10 * SECOND);
+
+	/*
+	 * Handle the alerts here rather than in the interrupt task, and get
+	 * the TCPC out of low power mode first: the PD task handles any alert
+	 * pending when it wakes the TCPC.
+	 */
+	tcpci_tcpc_alert(PORT0);
+
+	/*
+	 * FAULT_STATUS comes with the ALERT read, and is cleared together
+	 * with ALERT; then the mask registers are read in one go.
+	 */
+	mock_tcpci_set_reg(TCPC_REG_FAULT_STATUS,
+			   TCPC_REG_FAULT_STATUS_I2C_INTERFACE_ERR);
+	mock_tcpci_set_reg_bits(TCPC_REG_ALERT, TCPC_REG_ALERT_FAULT);
+	tcpci_tcpc_alert(PORT0);
+	TEST_EQ(mock_tcpci_get_reg(TCPC_REG_ALERT), 0, "0x%x");
+	TEST_EQ(tcpci_get_last_alert_xfers(PORT0), 4, "%d");
+
+	/* ALERT_EXT is handled the same way */
+	mock_tcpci_set_reg(TCPC_REG_ALERT_EXT,
+			   TCPC_REG_ALERT_EXT_TIMER_EXPIRED);
+	mock_tcpci_set_reg_bits(TCPC_REG_ALERT, TCPC_REG_ALERT_ALERT_EXT);
+	tcpci_tcpc_alert(PORT0);
+	TEST_EQ(mock_tcpci_get_reg(TCPC_REG_ALERT), 0, "0x%x");
+	TEST_EQ(tcpci_get_last_alert_xfers(PORT0), 4, "%d");
+
+	/* Nothing to read past ALERT: the read, the clear and the masks */
+	mock_tcpci_set_reg_bits(TCPC_REG_ALERT, TCPC_REG_ALERT_V_ALARM_HI);
+	tcpci_tcpc_alert(PORT0);
+	TEST_EQ(mock_tcpci_get_reg(TCPC_REG_ALERT), 0, "0x%x");
+	TEST_EQ(tcpci_get_last_alert_xfers(PORT0), 3, "%d");
+
+	return EC_SUCCESS;
+}
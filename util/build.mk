@@ -33,7 +33,7 @@ comm-objs+=comm-lpc.o comm-mec_lpc.o comm-i2c.o misc_util.o
 iteflash-objs = iteflash.o usb_if.o
 ectool-objs=ectool.o ectool_keyscan.o ec_flash.o ec_panicinfo.o $(comm-objs)
 ectool-objs+=ectool_i2c.o
-ectool-objs+=../common/crc.o
+ectool-objs+=../common/crc.o ../common/sha256.o
 ectool_servo-objs=$(ectool-objs) comm-servo-spi.o
 ec_sb_firmware_update-objs=ec_sb_firmware_update.o $(comm-objs) misc_util.o
 ec_sb_firmware_update-objs+=powerd_lock.o
@@ -22,6 +22,8 @@ int (*ec_command_proto)(int command, int version,
 
 int (*ec_readmem)(int offset, int bytes, void *dest);
 
+int (*ec_readbulk)(int offset, int bytes, void *dest);
+
 int (*ec_pollevent)(unsigned long mask, void *buffer, size_t buf_size,
 		    int timeout);
 
@@ -83,12 +85,128 @@ int ec_command(int command, int version,
 				indata, insize);
 }
 
+/* Set once the EC has rejected EC_CMD_BATCH */
+static int batch_unsupported;
+
+static int ec_command_batch_serial(struct ec_batch_cmd *cmds, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		cmds[i].rv = ec_command(cmds[i].command, cmds[i].version,
+					cmds[i].outdata, cmds[i].outsize,
+					cmds[i].indata, cmds[i].insize);
+
+	return 0;
+}
+
+/**
+ * Send one EC_CMD_BATCH holding as many of cmds[] as fit in the request and
+ * response packets.
+ *
+ * Returns the number of commands run (at least 1), or negative on error.
+ */
+static int ec_command_batch_once(struct ec_batch_cmd *cmds, int count)
+{
+	struct ec_params_batch *p = ec_outbuf;
+	struct ec_response_batch *r = ec_inbuf;
+	uint8_t *out = (uint8_t *)(p + 1);
+	uint8_t *in = (uint8_t *)(r + 1);
+	int outsize = sizeof(*p);
+	int insize = sizeof(*r);
+	int n, rv;
+
+	for (n = 0; n < count && n < UINT8_MAX; n++) {
+		struct ec_batch_request *req = (struct ec_batch_request *)out;
+		int req_size = EC_BATCH_RECORD_SIZE(cmds[n].outsize);
+		int res_size = EC_BATCH_RECORD_SIZE(cmds[n].insize);
+
+		if (cmds[n].outsize > UINT8_MAX ||
+		    outsize + req_size > ec_max_outsize ||
+		    insize + res_size > ec_max_insize)
+			break;
+
+		memset(req, 0, req_size);
+		req->command = cmds[n].command;
+		req->command_version = cmds[n].version;
+		req->params_size = cmds[n].outsize;
+		if (cmds[n].outsize)
+			memcpy(req + 1, cmds[n].outdata, cmds[n].outsize);
+
+		out += req_size;
+		outsize += req_size;
+		insize += res_size;
+	}
+
+	/* Too big to batch; send it on its own */
+	if (!n) {
+		ec_command_batch_serial(cmds, 1);
+		return 1;
+	}
+
+	memset(p, 0, sizeof(*p));
+	p->num_commands = n;
+
+	rv = ec_command(EC_CMD_BATCH, 0, p, outsize, r, ec_max_insize);
+	if (rv < 0)
+		return rv;
+	if (rv < (int)sizeof(*r) || !r->num_commands || r->num_commands > n)
+		return -EC_RES_INVALID_RESPONSE;
+
+	for (n = 0; n < r->num_commands; n++) {
+		struct ec_batch_response *res = (struct ec_batch_response *)in;
+
+		if (in + sizeof(*res) > (uint8_t *)r + rv ||
+		    in + EC_BATCH_RECORD_SIZE(res->response_size) >
+		    (uint8_t *)r + rv)
+			return -EC_RES_INVALID_RESPONSE;
+
+		if (res->result != EC_RES_SUCCESS) {
+			cmds[n].rv = -EECRESULT - res->result;
+		} else {
+			cmds[n].rv = res->response_size < cmds[n].insize ?
+				res->response_size : cmds[n].insize;
+			if (cmds[n].rv)
+				memcpy(cmds[n].indata, res + 1, cmds[n].rv);
+		}
+
+		in += EC_BATCH_RECORD_SIZE(res->response_size);
+	}
+
+	return n;
+}
+
+int ec_command_batch(struct ec_batch_cmd *cmds, int count)
+{
+	int rv;
+
+	while (count > 0) {
+		if (batch_unsupported)
+			return ec_command_batch_serial(cmds, count);
+
+		rv = ec_command_batch_once(cmds, count);
+		if (rv == -EECRESULT - EC_RES_INVALID_COMMAND) {
+			batch_unsupported = 1;
+			continue;
+		}
+		if (rv < 0)
+			return rv;
+
+		cmds += rv;
+		count -= rv;
+	}
+
+	return 0;
+}
+
 int comm_init_alt(int interfaces, const char *device_name, int i2c_bus)
 {
 	bool dev_is_cros_ec;
 
 	/* Default memmap access */
 	ec_readmem = fake_readmem;
+	/* No bulk window unless the interface provides one */
+	ec_readbulk = NULL;
 
 	if ((interfaces & COMM_SERVO) && comm_init_servo_spi &&
 	    !comm_init_servo_spi(device_name))
@@ -66,6 +66,29 @@ int ec_command(int command, int version,
 	       const void *outdata, int outsize,   /* to the EC */
 	       void *indata, int insize);	   /* from the EC */
 
+/* One command for ec_command_batch() */
+struct ec_batch_cmd {
+	int command;
+	int version;
+	const void *outdata;	/* to the EC */
+	int outsize;
+	void *indata;		/* from the EC */
+	int insize;
+	/* Set by ec_command_batch(); same meaning as ec_command() return */
+	int rv;
+};
+
+/**
+ * Send several commands to the EC, packing as many as fit into each
+ * EC_CMD_BATCH round trip.  Falls back to one ec_command() per command if the
+ * EC does not support batching.  The result of each command is stored in its
+ * rv field.
+ *
+ * Returns 0 if every command was sent (check each rv for its result), or
+ * negative on a transport error.
+ */
+int ec_command_batch(struct ec_batch_cmd *cmds, int count);
+
 /**
  * Set the offset to be applied to the command number when ec_command() calls
  * ec_command_proto().
@@ -90,6 +113,13 @@ extern int (*ec_command_proto)(int command, int version,
  */
 extern int (*ec_readmem)(int offset, int bytes, void *dest);
 
+/**
+ * Read from the EC's bulk data window, which EC_CMD_FLASH_READ_BULK fills.
+ * NULL if the interface has no such window.  Returns the number of bytes
+ * read, or negative on error.
+ */
+extern int (*ec_readbulk)(int offset, int bytes, void *dest);
+
 /**
  * Wait for a MKBP event matching 'mask' for at most 'timeout' milliseconds.
  * Then read the incoming event content in 'buffer' (or at most
@@ -31,20 +31,34 @@ typedef enum _ec_xfer_direction { EC_MEC_WRITE, EC_MEC_READ } ec_xfer_direction;
 #define MEC_EC_DATA_REGISTER0         0x0804
 #define MEC_EC_DATA_REGISTER2         0x0806
 #define MEC_EC_MEMMAP_START            0x100
+#define MEC_EC_BULK_START              0x200
+
+/*
+ * EMI address the next 32-bit auto-increment access will hit, or -1 if the
+ * address register has to be programmed first.  Lets back-to-back transfers
+ * (e.g. response header then response data) share one burst.
+ */
+static int mec_long_address = -1;
+
+static void ec_mec_set_address(uint16_t address, int access)
+{
+	outw((address & 0xFFFC) | access, MEC_EC_ADDRESS_REGISTER0);
+	if (access == MEC_EC_LONG_ACCESS_AUTOINCREMENT)
+		mec_long_address = address & 0xFFFC;
+	else
+		mec_long_address = -1;
+}
 
 static int ec_mec_xfer(ec_xfer_direction direction, uint16_t address,
 		       char *data, uint16_t size)
 {
-	/*
-	 * There's a cleverer way to do this, but it's somewhat less clear what's happening.
-	 * I prefer clarity over cleverness. :)
-	 */
 	int pos = 0;
-	uint16_t temp[2];
+	uint32_t temp;
+
 	if (address % 4 > 0) {
-		outw((address & 0xFFFC) | MEC_EC_BYTE_ACCESS, MEC_EC_ADDRESS_REGISTER0);
+		ec_mec_set_address(address, MEC_EC_BYTE_ACCESS);
 		/* Unaligned start address */
-		for (int i = address % 4; i < 4; ++i) {
+		for (int i = address % 4; i < 4 && pos < size; ++i) {
 			char *storage = &data[pos++];
 			if (direction == EC_MEC_WRITE)
 				outb(*storage, MEC_EC_DATA_REGISTER0 + i);
@@ -55,32 +69,39 @@ static int ec_mec_xfer(ec_xfer_direction direction, uint16_t address,
 	}
 
 	if (size - pos >= 4) {
-		outw((address & 0xFFFC) | MEC_EC_LONG_ACCESS_AUTOINCREMENT, MEC_EC_ADDRESS_REGISTER0);
+		if (address != mec_long_address)
+			ec_mec_set_address(address,
+					   MEC_EC_LONG_ACCESS_AUTOINCREMENT);
 		while (size - pos >= 4) {
 			if (direction == EC_MEC_WRITE) {
-				memcpy(temp, &data[pos], sizeof(temp));
-				outw(temp[0], MEC_EC_DATA_REGISTER0);
-				outw(temp[1], MEC_EC_DATA_REGISTER2);
+				memcpy(&temp, &data[pos], sizeof(temp));
+				outl(temp, MEC_EC_DATA_REGISTER0);
 			} else if (direction == EC_MEC_READ) {
-				temp[0] = inw(MEC_EC_DATA_REGISTER0);
-				temp[1] = inw(MEC_EC_DATA_REGISTER2);
-				memcpy(&data[pos], temp, sizeof(temp));
+				temp = inl(MEC_EC_DATA_REGISTER0);
+				memcpy(&data[pos], &temp, sizeof(temp));
 			}
 
 			pos += 4;
 			address += 4;
 		}
+		mec_long_address = address;
 	}
 
-	if (size - pos > 0) {
-		outw((address & 0xFFFC) | MEC_EC_BYTE_ACCESS, MEC_EC_ADDRESS_REGISTER0);
-		for (int i = 0; i < (size - pos); ++i) {
-			char *storage = &data[pos + i];
-			if (direction == EC_MEC_WRITE)
-				outb(*storage, MEC_EC_DATA_REGISTER0 + i);
-			else if (direction == EC_MEC_READ)
-				*storage = inb(MEC_EC_DATA_REGISTER0 + i);
-		}
+	if (size - pos > 0 && direction == EC_MEC_READ) {
+		/*
+		 * Read the whole last dword. It starts below the (dword
+		 * aligned) EMI read limit, so this is always in range.
+		 */
+		if (address != mec_long_address)
+			ec_mec_set_address(address,
+					   MEC_EC_LONG_ACCESS_AUTOINCREMENT);
+		temp = inl(MEC_EC_DATA_REGISTER0);
+		memcpy(&data[pos], &temp, size - pos);
+		mec_long_address = address + 4;
+	} else if (size - pos > 0) {
+		ec_mec_set_address(address, MEC_EC_BYTE_ACCESS);
+		for (int i = 0; i < (size - pos); ++i)
+			outb(data[pos + i], MEC_EC_DATA_REGISTER0 + i);
 	}
 	return 0;
 }
@@ -98,6 +119,7 @@ static int ec_command_lpc_mec_3(int command, int version, const void *outdata,
 				int outsize, void *indata, int insize)
 {
 	uint8_t csum = 0;
+	int len;
 	int i;
 
 	union {
@@ -127,12 +149,27 @@ static int ec_command_lpc_mec_3(int command, int version, const void *outdata,
 	csum = ec_checksum_buffer(u.data, outsize + sizeof(u.rq));
 	u.rq.checksum = (uint8_t)(-csum);
 
+	/*
+	 * Send header and params as one dword burst. The EC only looks at
+	 * data_len bytes, so pad with zeroes rather than finishing with
+	 * byte accesses.
+	 */
+	len = (outsize + sizeof(u.rq) + 3) & ~3;
+	memset(&u.data[outsize + sizeof(u.rq)], 0,
+	       len - outsize - sizeof(u.rq));
+
+	/*
+	 * Another host-side user of EMI0 (e.g. the kernel driver) may have
+	 * moved the address register since our last transfer.
+	 */
+	mec_long_address = -1;
+
 	if (wait_for_ec(EC_LPC_ADDR_HOST_CMD, 1000000)) {
 		fprintf(stderr, "Timeout waiting for EC response\n");
 		return -EC_RES_ERROR;
 	}
 
-	ec_mec_xfer(EC_MEC_WRITE, 0, u.data, outsize + sizeof(u.rq));
+	ec_mec_xfer(EC_MEC_WRITE, 0, u.data, len);
 
 	/* Start the command */
 	outb(EC_COMMAND_PROTOCOL_3, EC_LPC_ADDR_HOST_CMD);
@@ -188,6 +225,7 @@ static int ec_readmem_lpc_mec(int offset, int bytes, void *dest)
 	if (offset >= EC_MEMMAP_SIZE - bytes)
 		return -1;
 
+	mec_long_address = -1;
 	if (bytes) {
 		ec_mec_xfer(EC_MEC_READ, MEC_EC_MEMMAP_START + i, dest, bytes);
 		cnt = bytes;
@@ -206,6 +244,17 @@ static int ec_readmem_lpc_mec(int offset, int bytes, void *dest)
 	return cnt;
 }
 
+static int ec_readbulk_lpc_mec(int offset, int bytes, void *dest)
+{
+	if (offset < 0 || bytes < 0 ||
+	    MEC_EC_BULK_START + offset + bytes > 0x10000)
+		return -1;
+
+	mec_long_address = -1;
+	ec_mec_xfer(EC_MEC_READ, MEC_EC_BULK_START + offset, dest, bytes);
+	return bytes;
+}
+
 int comm_init_lpc_mec(void)
 {
 	char signature[2];
@@ -219,6 +268,7 @@ int comm_init_lpc_mec(void)
 
 	ec_command_proto = ec_command_lpc_mec_3;
 	ec_readmem = ec_readmem_lpc_mec;
+	ec_readbulk = ec_readbulk_lpc_mec;
 
 	return 0;
 }
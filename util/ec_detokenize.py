@@ -0,0 +1,390 @@
+#!/usr/bin/env python3
+# Copyright 2022 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+"""Tokenized EC console decoder
+
+Turns the '$'-prefixed lines written by an EC built with
+CONFIG_CONSOLE_TOKENIZED back into text, by looking the format strings up in
+the EC's ELF files and formatting the arguments the way vfnprintf() does.
+See vfntokenize() in include/printf.h for the record format.
+
+Example:
+    ec_detokenize.py -b build/volteer < uart.log
+"""
+
+import argparse
+import base64
+import binascii
+import os
+import re
+import struct
+import sys
+
+TOKENIZE_MARKER = '$'
+TOKENIZE_TIMESTAMP = 1 << 0
+TOKENIZE_RW = 1 << 1
+TOKENIZE_LEGACY_LI = 1 << 2
+TOKENIZE_VERBOSE_TIME = 1 << 3
+
+# From common/printf.c
+MAX_FORMAT = 1024
+ERROR_STR = 'ERROR'
+INTBUF_DIGITS = 31
+
+TOKEN_RE = re.compile(r'\$([A-Za-z0-9+/]+={0,2})')
+
+PT_LOAD = 1
+
+
+class DecodeError(Exception):
+    """The record could not be decoded"""
+
+
+class ElfStrings:
+    """Reads NUL-terminated strings from the loadable segments of an ELF"""
+
+    def __init__(self, data):
+        if data[:4] != b'\x7fELF':
+            raise ValueError('not an ELF file')
+        is_64 = data[4] == 2
+        endian = '<' if data[5] == 1 else '>'
+        if is_64:
+            phoff, = struct.unpack_from(endian + 'Q', data, 0x20)
+            phentsize, phnum = struct.unpack_from(endian + 'HH', data, 0x36)
+            phdr = endian + 'IIQQQQQQ'
+        else:
+            phoff, = struct.unpack_from(endian + 'I', data, 0x1c)
+            phentsize, phnum = struct.unpack_from(endian + 'HH', data, 0x2a)
+            phdr = endian + 'IIIIIIII'
+
+        self.data = data
+        self.segments = []
+        for i in range(phnum):
+            fields = struct.unpack_from(phdr, data, phoff + i * phentsize)
+            if is_64:
+                p_type, _, p_offset, p_vaddr, _, p_filesz = fields[:6]
+            else:
+                p_type, p_offset, p_vaddr, _, p_filesz = fields[:5]
+            if p_type == PT_LOAD and p_filesz:
+                self.segments.append((p_vaddr & 0xffffffff, p_offset,
+                                      p_filesz))
+
+    @classmethod
+    def from_file(cls, path):
+        """Load an ELF file"""
+        with open(path, 'rb') as f:
+            return cls(f.read())
+
+    def string_at(self, address):
+        """Return the string at a 32-bit address, or None"""
+        for vaddr, offset, size in self.segments:
+            if vaddr <= address < vaddr + size:
+                start = offset + address - vaddr
+                end = self.data.find(b'\0', start, offset + size)
+                if end < 0:
+                    return None
+                return self.data[start:end].decode('latin-1')
+        return None
+
+
+class ArgReader:
+    """Pulls encoded arguments off a record"""
+
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos
+
+    def byte(self):
+        """Next raw byte"""
+        if self.pos >= len(self.data):
+            raise DecodeError('record too short')
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def varint(self):
+        """Unsigned LEB128"""
+        value = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7f) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    def signed(self):
+        """Zigzag-encoded LEB128"""
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def bytes(self):
+        """Varint length, then that many bytes"""
+        length = self.varint()
+        if self.pos + length > len(self.data):
+            raise DecodeError('record too short')
+        self.pos += length
+        return self.data[self.pos - length:self.pos]
+
+
+def format_int(value, base, precision, upper):
+    """Digits as vfnprintf() builds them, with fixed-point precision"""
+    digits = ''
+    precision = min(precision, INTBUF_DIGITS)
+    for _ in range(max(precision, 0)):
+        digits = str(value % 10) + digits
+        value //= 10
+    if precision >= 0:
+        digits = '.' + digits
+    if not value:
+        digits = '0' + digits
+    chars = '0123456789ABCDEF' if upper else '0123456789abcdef'
+    while value:
+        digits = chars[value % base] + digits
+        value //= base
+    return digits
+
+
+def format_timestamp(usec, flags):
+    """Format a time in us as %pT does"""
+    if flags & TOKENIZE_VERBOSE_TIME:
+        return format_int(usec, 10, 6, False)
+    return format_int(usec // 1000, 10, 3, False)
+
+
+def format_ec(fmt, args, flags):
+    """Format arguments from an ArgReader like vfnprintf()"""
+    out = []
+    i = 0
+
+    def next_char():
+        nonlocal i
+        c = fmt[i] if i < len(fmt) else '\0'
+        i += 1
+        return c
+
+    while i < len(fmt):
+        c = next_char()
+        if c != '%':
+            out.append(c)
+            continue
+
+        c = next_char()
+        if c in ('%', '\0'):
+            out.append('%')
+            if c == '\0':
+                break
+            continue
+
+        if c == 'c':
+            out.append(chr(args.signed() & 0xff))
+            continue
+
+        left = pad_zero = plus = False
+        if c == '-':
+            left = True
+            c = next_char()
+        if c == '+':
+            plus = True
+            c = next_char()
+        if c == '0':
+            pad_zero = True
+            c = next_char()
+
+        width = 0
+        if c == '*':
+            width = args.signed()
+            c = next_char()
+        else:
+            while c.isdigit():
+                width = 10 * width + int(c)
+                c = next_char()
+        if width < 0 or width > MAX_FORMAT:
+            out.append(ERROR_STR)
+            break
+
+        precision = -1
+        if c == '.':
+            c = next_char()
+            if c == '*':
+                precision = args.signed()
+                c = next_char()
+            else:
+                precision = 0
+                while c.isdigit():
+                    precision = 10 * precision + int(c)
+                    c = next_char()
+            if precision < 0 or precision > MAX_FORMAT:
+                out.append(ERROR_STR)
+                break
+
+        if c == 's':
+            vstr = args.bytes().decode('latin-1')
+        else:
+            base = 10
+            sign = ''
+            is_64 = False
+            if c == 'l':
+                c = next_char()
+                if c == 'l':
+                    is_64 = True
+                    c = next_char()
+                if not is_64:
+                    out.append(ERROR_STR)
+                    break
+            elif c == 'z':
+                c = next_char()
+
+            if c == 'p':
+                spec = next_char()
+                c = None
+                if spec == 'T':
+                    value = args.varint()
+                    if flags & TOKENIZE_VERBOSE_TIME:
+                        precision = 6
+                    else:
+                        precision = 3
+                        value //= 1000
+                elif spec == 'h':
+                    out.append(args.bytes().hex())
+                    continue
+                elif spec == 'P':
+                    value = args.varint()
+                    base = 16
+                elif spec == 'b':
+                    count = args.varint()
+                    if not count:
+                        continue
+                    width = count - 1
+                    value = args.varint()
+                    pad_zero = True
+                    base = 2
+                else:
+                    # vfnprintf() gives up on the rest of the output
+                    break
+            elif c == 'd' or (c == 'i' and flags & TOKENIZE_LEGACY_LI):
+                value = args.signed()
+            elif c in ('u', 'T', 'x', 'X'):
+                value = args.varint()
+                if c in ('x', 'X'):
+                    base = 16
+            else:
+                out.append(ERROR_STR)
+                break
+
+            if value < 0:
+                sign = '-'
+                value = -value
+            elif plus and c in ('d', 'i'):
+                sign = '+'
+            vstr = sign + format_int(value, base, precision, c == 'X')
+            precision = -1
+
+        if precision >= 0 and width > precision:
+            width = precision
+        if precision < 0:
+            precision = max(len(vstr), width)
+        vstr = vstr[:precision]
+
+        pad = width - len(vstr)
+        if pad > 0 and not left:
+            out.append(('0' if pad_zero else ' ') * pad)
+        out.append(vstr)
+        if pad > 0 and left:
+            out.append(' ' * pad)
+
+    return ''.join(out)
+
+
+def decode_record(payload, lookup):
+    """Decode one base64 record
+
+    Args:
+        payload: base64 text following the marker
+        lookup: function(address, is_rw) returning the format string or None
+
+    Returns:
+        The text the EC would have printed (without a trailing newline)
+    """
+    try:
+        data = base64.b64decode(payload, validate=True)
+    except binascii.Error as e:
+        raise DecodeError(str(e)) from e
+    if len(data) < 5:
+        raise DecodeError('record too short')
+
+    flags = data[0]
+    address, = struct.unpack_from('<I', data, 1)
+    args = ArgReader(data, 5)
+    fmt = lookup(address, bool(flags & TOKENIZE_RW))
+    if fmt is None:
+        raise DecodeError('no format string at 0x%08x' % address)
+
+    if flags & TOKENIZE_TIMESTAMP:
+        stamp = format_timestamp(args.varint(), flags)
+        return '[%s %s]' % (stamp, format_ec(fmt, args, flags))
+    return format_ec(fmt, args, flags)
+
+
+def decode_line(line, lookup):
+    """Replace every decodable record in a line of console output"""
+
+    def replace(match):
+        try:
+            return decode_record(match.group(1), lookup)
+        except DecodeError:
+            return match.group(0)
+
+    return TOKEN_RE.sub(replace, line)
+
+
+def parse_args(argv):
+    """Parse the program arguments
+
+    Args:
+        argv: List of arguments to parse, excluding the program name
+
+    Returns:
+        argparse.Namespace object containing the results
+    """
+    parser = argparse.ArgumentParser(
+        description='Decode a tokenized EC console log')
+    parser.add_argument('-b', '--build-dir', type=str,
+                        help='EC build directory (uses RO/ec.RO.elf and '
+                        'RW/ec.RW.elf)')
+    parser.add_argument('--ro', type=str, help='RO image ELF file')
+    parser.add_argument('--rw', type=str, help='RW image ELF file')
+    parser.add_argument('input', nargs='?', type=str,
+                        help='Console log (default: stdin)')
+    return parser.parse_args(argv)
+
+
+def main(argv):
+    """Decode a console log to stdout"""
+    args = parse_args(argv)
+    ro_path, rw_path = args.ro, args.rw
+    if args.build_dir:
+        ro_path = ro_path or os.path.join(args.build_dir, 'RO', 'ec.RO.elf')
+        rw_path = rw_path or os.path.join(args.build_dir, 'RW', 'ec.RW.elf')
+
+    images = {}
+    for is_rw, path in ((False, ro_path), (True, rw_path)):
+        if path and os.path.exists(path):
+            images[is_rw] = ElfStrings.from_file(path)
+    if not images:
+        sys.exit('No ELF files given (use -b, --ro or --rw)')
+
+    def lookup(address, is_rw):
+        image = images.get(is_rw) or next(iter(images.values()))
+        return image.string_at(address)
+
+    infile = open(args.input, 'rb') if args.input else sys.stdin.buffer
+    with infile:
+        for raw in infile:
+            line = raw.decode('latin-1')
+            sys.stdout.write(decode_line(line, lookup))
+            sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -11,11 +11,53 @@
 
 #include "comm-host.h"
 #include "misc_util.h"
+#include "sha256.h"
 #include "timer.h"
 
 static const uint32_t ERASE_ASYNC_TIMEOUT = 10 * SECOND;
 static const uint32_t ERASE_ASYNC_WAIT = 500 * MSEC;
 static const int FLASH_ERASE_BUSY_RV = -EECRESULT - EC_RES_BUSY;
+static const uint32_t BLOCK_HASH_BUSY_TIMEOUT = 10 * SECOND;
+static const uint32_t BLOCK_HASH_BUSY_WAIT = 100 * MSEC;
+
+/* Whether the EC supports EC_CMD_FLASH_READ_BULK; -1 until asked */
+static int read_bulk_supported = -1;
+
+/**
+ * Read flash through the EC's bulk window, as much as the window holds per
+ * host command.
+ */
+static int ec_flash_read_bulk(uint8_t *buf, int offset, int size)
+{
+	struct ec_params_flash_read_bulk p;
+	struct ec_response_flash_read_bulk r;
+	int rv;
+	int i;
+
+	for (i = 0; i < size; i += r.size) {
+		p.offset = offset + i;
+		p.size = size - i;
+		rv = ec_command(EC_CMD_FLASH_READ_BULK, 0,
+				&p, sizeof(p), &r, sizeof(r));
+		if (rv < 0) {
+			fprintf(stderr, "Read error at offset %d\n", i);
+			return rv;
+		}
+		if (r.size == 0 || r.size > p.size) {
+			fprintf(stderr, "Bad bulk read size %u at offset %d\n",
+				r.size, i);
+			return -1;
+		}
+		rv = ec_readbulk(0, r.size, buf + i);
+		if (rv < 0) {
+			fprintf(stderr, "Bulk window read error at offset %d\n",
+				i);
+			return rv;
+		}
+	}
+
+	return 0;
+}
 
 int ec_flash_read(uint8_t *buf, int offset, int size)
 {
@@ -23,6 +65,13 @@ int ec_flash_read(uint8_t *buf, int offset, int size)
 	int rv;
 	int i;
 
+	/* Only ask the EC once; callers may read in many small pieces */
+	if (ec_readbulk && read_bulk_supported < 0)
+		read_bulk_supported =
+			ec_cmd_version_supported(EC_CMD_FLASH_READ_BULK, 0);
+	if (ec_readbulk && read_bulk_supported)
+		return ec_flash_read_bulk(buf, offset, size);
+
 	/* Read data in chunks */
 	for (i = 0; i < size; i += ec_max_insize) {
 		p.offset = offset + i;
@@ -229,3 +278,179 @@ int ec_flash_erase_async(int offset, int size)
 	}
 	return rv;
 }
+
+int ec_flash_block_hash(int offset, int block_size, int num_blocks,
+			uint8_t *digests)
+{
+	struct ec_params_flash_block_hash p;
+	struct ec_response_flash_block_hash *r =
+		(struct ec_response_flash_block_hash *)ec_inbuf;
+	uint32_t waited = 0;
+	int done = 0;
+	int rv;
+
+	while (done < num_blocks) {
+		p.offset = offset + done * block_size;
+		p.block_size = block_size;
+		p.num_blocks = MIN(num_blocks - done, UINT16_MAX);
+		p.hash_type = EC_FLASH_BLOCK_HASH_SHA256;
+		p.reserved = 0;
+
+		rv = ec_command(EC_CMD_FLASH_BLOCK_HASH, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+
+		/* The EC may still be computing its own vboot hash */
+		if (rv == -EECRESULT - EC_RES_BUSY &&
+		    waited < BLOCK_HASH_BUSY_TIMEOUT) {
+			usleep(BLOCK_HASH_BUSY_WAIT);
+			waited += BLOCK_HASH_BUSY_WAIT;
+			continue;
+		}
+		if (rv < 0)
+			return rv;
+
+		if (rv < sizeof(*r) || r->num_blocks == 0 ||
+		    r->digest_size != SHA256_DIGEST_SIZE ||
+		    rv < sizeof(*r) + r->num_blocks * SHA256_DIGEST_SIZE) {
+			fprintf(stderr, "Bad block hash response\n");
+			return -1;
+		}
+
+		memcpy(digests + done * SHA256_DIGEST_SIZE, r->digest,
+		       r->num_blocks * SHA256_DIGEST_SIZE);
+		done += r->num_blocks;
+	}
+
+	return 0;
+}
+
+/**
+ * @return Erase block size on success, negative on failure
+ */
+static int get_flash_erase_size(void)
+{
+	struct ec_response_flash_info info = { 0 };
+	int rv;
+
+	rv = get_flash_info_v0(&info);
+	if (rv < 0)
+		return rv;
+
+	return info.erase_block_size;
+}
+
+static void sha256_block(const uint8_t *data, int size, uint8_t *digest)
+{
+	struct sha256_ctx ctx;
+
+	SHA256_init(&ctx);
+	SHA256_update(&ctx, data, size);
+	memcpy(digest, SHA256_final(&ctx), SHA256_DIGEST_SIZE);
+}
+
+int ec_flash_write_delta(const uint8_t *buf, int offset, int size)
+{
+	uint8_t *img = NULL;
+	uint8_t *remote = NULL;
+	uint8_t *local = NULL;
+	int erase_size;
+	int num_blocks;
+	int changed = 0;
+	int rv = -1;
+	int i, j;
+
+	erase_size = get_flash_erase_size();
+	if (erase_size <= 0)
+		return erase_size < 0 ? erase_size : -1;
+
+	if (offset % erase_size) {
+		fprintf(stderr, "Offset must be a multiple of the erase "
+			"block size (%d)\n", erase_size);
+		return -1;
+	}
+
+	num_blocks = (size + erase_size - 1) / erase_size;
+	img = (uint8_t *)malloc(num_blocks * erase_size);
+	remote = (uint8_t *)malloc(num_blocks * SHA256_DIGEST_SIZE);
+	local = (uint8_t *)malloc(num_blocks * SHA256_DIGEST_SIZE);
+	if (!img || !remote || !local) {
+		fprintf(stderr, "Unable to allocate buffer.\n");
+		goto out;
+	}
+
+	/*
+	 * Rewritten blocks are erased whole, so keep the current contents of
+	 * the last block past the end of the image.
+	 */
+	memcpy(img, buf, size);
+	if (num_blocks * erase_size > size) {
+		rv = ec_flash_read(img + size, offset + size,
+				   num_blocks * erase_size - size);
+		if (rv < 0)
+			goto out;
+	}
+
+	for (i = 0; i < num_blocks; i++)
+		sha256_block(img + i * erase_size, erase_size,
+			     local + i * SHA256_DIGEST_SIZE);
+
+	rv = ec_flash_block_hash(offset, erase_size, num_blocks, remote);
+	if (rv < 0)
+		goto out;
+
+	/* Erase and write each run of consecutive changed blocks */
+	for (i = 0; i < num_blocks; i = j) {
+		int run_offset, run_size;
+
+		if (!memcmp(local + i * SHA256_DIGEST_SIZE,
+			    remote + i * SHA256_DIGEST_SIZE,
+			    SHA256_DIGEST_SIZE)) {
+			j = i + 1;
+			continue;
+		}
+
+		for (j = i + 1; j < num_blocks; j++)
+			if (!memcmp(local + j * SHA256_DIGEST_SIZE,
+				    remote + j * SHA256_DIGEST_SIZE,
+				    SHA256_DIGEST_SIZE))
+				break;
+
+		run_offset = offset + i * erase_size;
+		run_size = (j - i) * erase_size;
+		changed += j - i;
+
+		rv = ec_flash_erase(run_offset, run_size);
+		if (rv < 0) {
+			fprintf(stderr, "Erase error at offset 0x%x\n",
+				run_offset);
+			goto out;
+		}
+		rv = ec_flash_write(img + i * erase_size, run_offset,
+				    run_size);
+		if (rv < 0)
+			goto out;
+	}
+
+	printf("%d of %d blocks changed.\n", changed, num_blocks);
+
+	/* Verify the result by hash rather than reading everything back */
+	if (changed) {
+		rv = ec_flash_block_hash(offset, erase_size, num_blocks,
+					 remote);
+		if (rv < 0)
+			goto out;
+
+		if (memcmp(local, remote, num_blocks * SHA256_DIGEST_SIZE)) {
+			fprintf(stderr, "Verify failed after write\n");
+			rv = -1;
+			goto out;
+		}
+	}
+
+	rv = 0;
+out:
+	free(img);
+	free(remote);
+	free(local);
+	return rv;
+}
@@ -9,6 +9,8 @@
 /**
  * Read EC flash memory
  *
+ * Uses the EC's bulk window when both the interface and the EC support it.
+ *
  * @param buf		Destination buffer
  * @param offset	Offset in EC flash to read
  * @param size		Number of bytes to read
@@ -59,4 +61,29 @@ int ec_flash_erase(int offset, int size);
  */
 int ec_flash_erase_async(int offset, int size);
 
+/**
+ * Get the SHA-256 digest of consecutive blocks of EC flash memory
+ *
+ * @param offset	Offset in EC flash of the first block
+ * @param block_size	Size of each block in bytes
+ * @param num_blocks	Number of blocks to hash
+ * @param digests	Destination for num_blocks * SHA256_DIGEST_SIZE bytes
+ *
+ * @return 0 if success, negative if error.
+ */
+int ec_flash_block_hash(int offset, int block_size, int num_blocks,
+			uint8_t *digests);
+
+/**
+ * Write EC flash memory, only erasing and writing the erase blocks whose
+ * contents differ, then verify the written range by hash.
+ *
+ * @param buf		Source buffer
+ * @param offset	Offset in EC flash to write; must be erase block aligned
+ * @param size		Number of bytes to write
+ *
+ * @return 0 if success, negative if error.
+ */
+int ec_flash_write_delta(const uint8_t *buf, int offset, int size);
+
 #endif
@@ -77,6 +77,8 @@ const char help_str[] =
 	"      Enable/disable LCD backlight\n"
 	"  basestate [attach | detach | reset]\n"
 	"      Manually force base state to attached, detached or reset.\n"
+	"  batch <cmd>[:<ver>[:<params>]] ...\n"
+	"      Run several host commands in a single EC_CMD_BATCH round trip\n"
 	"  battery\n"
 	"      Prints battery info\n"
 	"  batterycutoff [at-shutdown]\n"
@@ -101,6 +103,8 @@ const char help_str[] =
 	"      Prints chip info\n"
 	"  cmdversions <cmd>\n"
 	"      Prints supported version mask for a command number\n"
+	"  commbench [iterations [size ...]]\n"
+	"      Time host commands and memmap reads of the given payload sizes\n"
 	"  console\n"
 	"      Prints the last output to the EC debug console\n"
 	"  cec\n"
@@ -145,7 +149,7 @@ const char help_str[] =
 	"      Prints or sets EC flash protection state\n"
 	"  flashread <offset> <size> <outfile>\n"
 	"      Reads from EC flash to a file\n"
-	"  flashwrite <offset> <infile>\n"
+	"  flashwrite [--delta] <offset> <infile>\n"
 	"      Writes to EC flash from a file\n"
 	"  forcelidopen <enable>\n"
 	"      Forces the lid switch to open position\n"
@@ -190,6 +194,8 @@ const char help_str[] =
 	"      Read I2C bus\n"
 	"  i2cspeed <port> [speed]\n"
 	"      Get or set EC's I2C bus speed\n"
+	"  i2ctrace read [csv] | enable <port> <addr> [<addr-hi>] | disable\n"
+	"      Read or configure the binary I2C trace\n"
 	"  i2cwrite\n"
 	"      Write I2C bus\n"
 	"  i2cxfer <port> <peripheral_addr> <read_count> [write bytes...]\n"
@@ -204,6 +210,8 @@ const char help_str[] =
 	"      Get keyboard ID of supported keyboards\n"
 	"  kbinfo\n"
 	"      Dump keyboard matrix dimensions\n"
+	"  kblatency [clear]\n"
+	"      Print keypress-to-host latency per stage, optionally clearing\n"
 	"  kbpress\n"
 	"      Simulate key press\n"
 	"  keyscan <beat_us> <filename>\n"
@@ -242,6 +250,8 @@ const char help_str[] =
 	"      Print history of port 80 write\n"
 	"  powerinfo\n"
 	"      Prints power-related information\n"
+	"  powertimeline [clear]\n"
+	"      Prints power signal and state changes, optionally clearing them\n"
 	"  protoinfo\n"
 	"       Prints EC host protocol information\n"
 	"  pse\n"
@@ -827,6 +837,78 @@ int cmd_test(int argc, char *argv[])
 	return rv;
 }
 
+static uint64_t time_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int cmd_comm_bench(int argc, char *argv[])
+{
+	static const int default_sizes[] = { 4, 16, 64, 128, 240 };
+	struct ec_params_flash_read p;
+	uint8_t mem[EC_MEMMAP_SIZE];
+	int iterations = 1000;
+	int num_sizes;
+	int i, n, rv, size;
+	uint64_t start, cmd_us, mem_us;
+	char *e;
+
+	if (argc > 1) {
+		iterations = strtol(argv[1], &e, 0);
+		if ((e && *e) || iterations <= 0) {
+			fprintf(stderr, "Bad iterations '%s'\n", argv[1]);
+			return -1;
+		}
+	}
+	num_sizes = argc > 2 ? argc - 2 : ARRAY_SIZE(default_sizes);
+
+	printf("%8s %14s %14s\n", "size", "command us/op", "memmap us/op");
+	for (i = 0; i < num_sizes; i++) {
+		if (argc > 2) {
+			size = strtol(argv[i + 2], &e, 0);
+			if ((e && *e) || size < 0 || size > ec_max_insize) {
+				fprintf(stderr, "Bad size '%s' (max %d)\n",
+					argv[i + 2], ec_max_insize);
+				return -1;
+			}
+			p.size = size;
+		} else {
+			p.size = MIN(default_sizes[i], ec_max_insize);
+		}
+		p.offset = 0;
+
+		/* Flash read: fixed params, response of the given size */
+		start = time_usec();
+		for (n = 0; n < iterations; n++) {
+			rv = ec_command(EC_CMD_FLASH_READ, 0, &p, sizeof(p),
+					ec_inbuf, p.size);
+			if (rv < 0)
+				return rv;
+		}
+		cmd_us = time_usec() - start;
+
+		printf("%8d %14.2f ", p.size, (double)cmd_us / iterations);
+		if (p.size >= EC_MEMMAP_SIZE) {
+			printf("%14s\n", "-");
+			continue;
+		}
+
+		start = time_usec();
+		for (n = 0; n < iterations; n++) {
+			rv = ec_readmem(0, p.size, mem);
+			if (rv < 0)
+				return rv;
+		}
+		mem_us = time_usec() - start;
+		printf("%14.2f\n", (double)mem_us / iterations);
+	}
+
+	return 0;
+}
+
 int cmd_s5(int argc, char *argv[])
 {
 	struct ec_params_get_set_value p;
@@ -1488,9 +1570,17 @@ int cmd_flash_write(int argc, char *argv[])
 	int rv;
 	char *e;
 	char *buf;
+	bool delta = false;
+
+	if (argc > 1 && !strcmp(argv[1], "--delta")) {
+		delta = true;
+		argc--;
+		argv++;
+	}
 
 	if (argc < 3) {
-		fprintf(stderr, "Usage: %s <offset> <filename>\n", argv[0]);
+		fprintf(stderr, "Usage: %s [--delta] <offset> <filename>\n",
+			argv[0]);
 		return -1;
 	}
 
@@ -1508,8 +1598,12 @@ int cmd_flash_write(int argc, char *argv[])
 	printf("Writing to offset %d...\n", offset);
 
 	/* Write data in chunks */
-	rv = ec_flash_write((const uint8_t *)(buf), offset,
-			    size);
+	if (delta)
+		rv = ec_flash_write_delta((const uint8_t *)(buf), offset,
+					  size);
+	else
+		rv = ec_flash_write((const uint8_t *)(buf), offset,
+				    size);
 
 	free(buf);
 
@@ -6649,6 +6743,58 @@ int cmd_power_info(int argc, char *argv[])
 }
 
 
+int cmd_power_timeline(int argc, char *argv[])
+{
+	struct ec_params_power_timeline p;
+	struct ec_response_power_timeline *r = ec_inbuf;
+	const struct ec_power_timeline_entry *e;
+	uint32_t first = 0, prev = 0;
+	int clear = 0, shown = 0;
+	int rv, i;
+
+	if (argc > 1) {
+		if (argc > 2 || strcmp(argv[1], "clear")) {
+			fprintf(stderr, "Usage: %s [clear]\n", argv[0]);
+			return -1;
+		}
+		clear = 1;
+	}
+
+	memset(&p, 0, sizeof(p));
+	printf("   +us(first)    +us(prev)  signals  event\n");
+	while (1) {
+		rv = ec_command(EC_CMD_POWER_TIMELINE, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+
+		if (!shown && r->dropped)
+			printf("(%d older entries overwritten)\n", r->dropped);
+		for (i = 0; i < r->count; i++) {
+			e = r->entries + i;
+			if (!shown++)
+				first = prev = e->timestamp;
+			printf("%12u %12u   0x%04x  ", e->timestamp - first,
+			       e->timestamp - prev, e->signals);
+			if (e->type == EC_POWER_TIMELINE_EDGE)
+				printf("signal %d => %d\n", e->id, e->level);
+			else
+				printf("power state %d\n", e->id);
+			prev = e->timestamp;
+		}
+		p.seq = r->seq + r->count;
+
+		if (r->count)
+			continue;
+		if (!clear || p.flags)
+			break;
+		/* Clear with one more read, so nothing new is lost */
+		p.flags = EC_POWER_TIMELINE_CLEAR;
+	}
+
+	return 0;
+}
+
 int cmd_pse(int argc, char *argv[])
 {
 	struct ec_params_pse p;
@@ -8663,6 +8809,42 @@ static int cmd_kbinfo(int argc, char *argv[])
 	return 0;
 }
 
+static int cmd_kb_latency(int argc, char *argv[])
+{
+	static const char * const stage_names[] = {
+		[EC_KEYBOARD_LATENCY_SCAN] = "scan",
+		[EC_KEYBOARD_LATENCY_QUEUE] = "queue",
+		[EC_KEYBOARD_LATENCY_HOST] = "host",
+		[EC_KEYBOARD_LATENCY_TOTAL] = "total",
+	};
+	struct ec_params_keyboard_latency p = { 0 };
+	struct ec_response_keyboard_latency r;
+	int i, rv;
+
+	BUILD_ASSERT(ARRAY_SIZE(stage_names) ==
+		     EC_KEYBOARD_LATENCY_STAGE_COUNT);
+
+	if (argc > 2 || (argc == 2 && strcasecmp(argv[1], "clear"))) {
+		fprintf(stderr, "Usage: %s [clear]\n", argv[0]);
+		return -1;
+	}
+	if (argc == 2)
+		p.flags |= EC_KEYBOARD_LATENCY_CLEAR;
+
+	rv = ec_command(EC_CMD_KEYBOARD_LATENCY, 0, &p, sizeof(p), &r,
+			sizeof(r));
+	if (rv < 0)
+		return rv;
+
+	printf("stage       count   p50 us   p99 us   max us\n");
+	for (i = 0; i < EC_KEYBOARD_LATENCY_STAGE_COUNT; i++)
+		printf("%-6s %10u %8u %8u %8u\n", stage_names[i],
+		       r.stage[i].count, r.stage[i].p50_us, r.stage[i].p99_us,
+		       r.stage[i].max_us);
+
+	return 0;
+}
+
 static int cmd_kbid(int argc, char *argv[])
 {
 	struct ec_response_keyboard_id response;
@@ -9595,21 +9777,123 @@ static int cmd_pchg(int argc, char *argv[])
 	return -1;
 }
 
-int cmd_pd_log(int argc, char *argv[])
+static void print_pd_log_entry(const struct ec_response_pd_log *r,
+			       time_t now)
 {
-	union {
-		struct ec_response_pd_log r;
-		uint32_t words[8]; /* space for the payload */
-	} u;
 	struct mcdp_info minfo;
 	struct ec_response_usb_pd_power_info pinfo;
-	int rv;
 	unsigned long long milliseconds;
 	unsigned seconds;
-	time_t now;
 	struct tm ltime;
 	char time_str[64];
 
+	/* the timestamp is in 1024th of seconds */
+	milliseconds = ((uint64_t)r->timestamp <<
+			PD_LOG_TIMESTAMP_SHIFT) / 1000;
+	/* the timestamp is the number of milliseconds in the past */
+	seconds = (milliseconds + 999) / 1000;
+	milliseconds -= seconds * 1000;
+	now -= seconds;
+	localtime_r(&now, &ltime);
+	strftime(time_str, sizeof(time_str), "%F %T", &ltime);
+	printf("%s.%03lld P%d ", time_str, -milliseconds,
+		PD_LOG_PORT(r->size_port));
+	if (r->type == PD_EVENT_MCU_CHARGE) {
+		if (r->data & CHARGE_FLAGS_OVERRIDE)
+			printf("override ");
+		if (r->data & CHARGE_FLAGS_DELAYED_OVERRIDE)
+			printf("pending_override ");
+		memcpy(&pinfo.meas, r->payload,
+			sizeof(struct usb_chg_measures));
+		pinfo.dualrole = !!(r->data & CHARGE_FLAGS_DUAL_ROLE);
+		pinfo.role = r->data & CHARGE_FLAGS_ROLE_MASK;
+		pinfo.type = (r->data & CHARGE_FLAGS_TYPE_MASK)
+				>> CHARGE_FLAGS_TYPE_SHIFT;
+		pinfo.max_power = 0;
+		print_pd_power_info(&pinfo);
+	} else if (r->type == PD_EVENT_MCU_CONNECT) {
+		printf("New connection\n");
+	} else if (r->type == PD_EVENT_MCU_BOARD_CUSTOM) {
+		printf("Board-custom event\n");
+	} else if (r->type == PD_EVENT_ACC_RW_FAIL) {
+		printf("RW signature check failed\n");
+	} else if (r->type == PD_EVENT_PS_FAULT) {
+		static const char * const fault_names[] = {
+			"---", "OCP", "fast OCP", "OVP", "Discharge"
+		};
+		const char *fault = r->data < ARRAY_SIZE(fault_names) ?
+				fault_names[r->data] : "???";
+		printf("Power supply fault: %s\n", fault);
+	} else if (r->type == PD_EVENT_VIDEO_DP_MODE) {
+		printf("DP mode %sabled\n", (r->data == 1) ?
+		       "en" : "dis");
+	} else if (r->type == PD_EVENT_VIDEO_CODEC) {
+		memcpy(&minfo, r->payload,
+		       sizeof(struct mcdp_info));
+		printf("HDMI info: family:%04x chipid:%04x "
+		       "irom:%d.%d.%d fw:%d.%d.%d\n",
+		       MCDP_FAMILY(minfo.family),
+		       MCDP_CHIPID(minfo.chipid),
+		       minfo.irom.major, minfo.irom.minor,
+		       minfo.irom.build, minfo.fw.major,
+		       minfo.fw.minor, minfo.fw.build);
+	} else { /* Unknown type */
+		int i;
+		printf("Event %02x (%04x) [", r->type, r->data);
+		for (i = 0; i < PD_LOG_SIZE(r->size_port); i++)
+			printf("%02x ", r->payload[i]);
+		printf("]\n");
+	}
+}
+
+int cmd_pd_log(int argc, char *argv[])
+{
+	union {
+		struct ec_response_pd_log r;
+		uint32_t words[8]; /* space for the payload */
+	} u;
+	struct ec_response_pd_log_entries *bulk = ec_inbuf;
+	int bulk_supported, rv, i, offset, entries_size;
+	time_t now;
+
+	/* Fetch as many entries per command as the EC can */
+	bulk_supported = ec_cmd_version_supported(EC_CMD_PD_GET_LOG_ENTRIES, 0);
+	while (bulk_supported) {
+		now = time(NULL);
+		rv = ec_command(EC_CMD_PD_GET_LOG_ENTRIES, 0, NULL, 0,
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < (int)sizeof(*bulk)) {
+			fprintf(stderr, "Truncated log response\n");
+			return -1;
+		}
+		entries_size = rv - (int)sizeof(*bulk);
+
+		if (bulk->dropped)
+			printf("--- %d EVENTS DROPPED ---\n", bulk->dropped);
+		if (!bulk->count) {
+			printf("--- END OF LOG ---\n");
+			return 0;
+		}
+
+		offset = 0;
+		for (i = 0; i < bulk->count; i++) {
+			const struct ec_response_pd_log *r =
+				(void *)(bulk->entries + offset);
+
+			if (offset + (int)sizeof(*r) > entries_size ||
+			    offset + (int)sizeof(*r) +
+			    PD_LOG_SIZE(r->size_port) > entries_size) {
+				fprintf(stderr, "Truncated log response\n");
+				return -1;
+			}
+			print_pd_log_entry(r, now);
+			offset += sizeof(*r) +
+				  ((PD_LOG_SIZE(r->size_port) + 3) & ~3);
+		}
+	}
+
 	while (1) {
 		now = time(NULL);
 		rv = ec_command(EC_CMD_PD_GET_LOG_ENTRY, 0,
@@ -9622,63 +9906,7 @@ int cmd_pd_log(int argc, char *argv[])
 			break;
 		}
 
-		/* the timestamp is in 1024th of seconds */
-		milliseconds = ((uint64_t)u.r.timestamp <<
-					 PD_LOG_TIMESTAMP_SHIFT) / 1000;
-		/* the timestamp is the number of milliseconds in the past */
-		seconds = (milliseconds + 999) / 1000;
-		milliseconds -= seconds * 1000;
-		now -= seconds;
-		localtime_r(&now, &ltime);
-		strftime(time_str, sizeof(time_str), "%F %T", &ltime);
-		printf("%s.%03lld P%d ", time_str, -milliseconds,
-			PD_LOG_PORT(u.r.size_port));
-		if (u.r.type == PD_EVENT_MCU_CHARGE) {
-			if (u.r.data & CHARGE_FLAGS_OVERRIDE)
-				printf("override ");
-			if (u.r.data & CHARGE_FLAGS_DELAYED_OVERRIDE)
-				printf("pending_override ");
-			memcpy(&pinfo.meas, u.r.payload,
-				sizeof(struct usb_chg_measures));
-			pinfo.dualrole = !!(u.r.data & CHARGE_FLAGS_DUAL_ROLE);
-			pinfo.role = u.r.data & CHARGE_FLAGS_ROLE_MASK;
-			pinfo.type = (u.r.data & CHARGE_FLAGS_TYPE_MASK)
-					>> CHARGE_FLAGS_TYPE_SHIFT;
-			pinfo.max_power = 0;
-			print_pd_power_info(&pinfo);
-		} else if (u.r.type == PD_EVENT_MCU_CONNECT) {
-			printf("New connection\n");
-		} else if (u.r.type == PD_EVENT_MCU_BOARD_CUSTOM) {
-			printf("Board-custom event\n");
-		} else if (u.r.type == PD_EVENT_ACC_RW_FAIL) {
-			printf("RW signature check failed\n");
-		} else if (u.r.type == PD_EVENT_PS_FAULT) {
-			static const char * const fault_names[] = {
-				"---", "OCP", "fast OCP", "OVP", "Discharge"
-			};
-			const char *fault = u.r.data < ARRAY_SIZE(fault_names) ?
-					fault_names[u.r.data] : "???";
-			printf("Power supply fault: %s\n", fault);
-		} else if (u.r.type == PD_EVENT_VIDEO_DP_MODE) {
-			printf("DP mode %sabled\n", (u.r.data == 1) ?
-			       "en" : "dis");
-		} else if (u.r.type == PD_EVENT_VIDEO_CODEC) {
-			memcpy(&minfo, u.r.payload,
-			       sizeof(struct mcdp_info));
-			printf("HDMI info: family:%04x chipid:%04x "
-			       "irom:%d.%d.%d fw:%d.%d.%d\n",
-			       MCDP_FAMILY(minfo.family),
-			       MCDP_CHIPID(minfo.chipid),
-			       minfo.irom.major, minfo.irom.minor,
-			       minfo.irom.build, minfo.fw.major,
-			       minfo.fw.minor, minfo.fw.build);
-		} else { /* Unknown type */
-			int i;
-			printf("Event %02x (%04x) [", u.r.type, u.r.data);
-			for (i = 0; i < PD_LOG_SIZE(u.r.size_port); i++)
-				printf("%02x ", u.r.payload[i]);
-			printf("]\n");
-		}
+		print_pd_log_entry(&u.r, now);
 	}
 
 	return 0;
@@ -10609,6 +10837,106 @@ out:
 	return !!rv;
 }
 
+static void cmd_batch_help(const char *cmd)
+{
+	fprintf(stderr,
+		"Usage: %s <cmd>[:<ver>[:<params>]][/<insize>] ...\n"
+		"  Run host commands in as few EC_CMD_BATCH round trips as\n"
+		"  possible. <params> is a string of hex bytes. <insize> is\n"
+		"  the largest response expected; commands without one may\n"
+		"  fill a whole response packet, so they are sent alone.\n",
+		cmd);
+}
+
+int cmd_batch(int argc, char *argv[])
+{
+	struct ec_batch_cmd *cmds;
+	uint8_t *outbuf, *inbuf;
+	int count = argc - 1;
+	int i, j, len, rv = -1;
+	char *e, *params;
+
+	if (count < 1) {
+		cmd_batch_help(argv[0]);
+		return -1;
+	}
+
+	cmds = calloc(count, sizeof(*cmds));
+	outbuf = calloc(count, ec_max_outsize);
+	inbuf = calloc(count, ec_max_insize);
+	if (!cmds || !outbuf || !inbuf) {
+		fprintf(stderr, "Unable to allocate buffers\n");
+		goto out;
+	}
+
+	for (i = 0; i < count; i++) {
+		cmds[i].insize = ec_max_insize;
+		e = strchr(argv[i + 1], '/');
+		if (e) {
+			*e = '\0';
+			cmds[i].insize = strtol(e + 1, &e, 0);
+			if (*e || cmds[i].insize < 0 ||
+			    cmds[i].insize > ec_max_insize) {
+				fprintf(stderr, "Bad response size in \"%s\"\n",
+					argv[i + 1]);
+				goto out;
+			}
+		}
+
+		cmds[i].command = strtoul(argv[i + 1], &e, 0);
+		if (*e == ':')
+			cmds[i].version = strtoul(e + 1, &e, 0);
+		params = NULL;
+		if (*e == ':')
+			params = e + 1;
+		else if (*e) {
+			fprintf(stderr, "Bad command \"%s\"\n", argv[i + 1]);
+			goto out;
+		}
+
+		cmds[i].outdata = outbuf + i * ec_max_outsize;
+		cmds[i].indata = inbuf + i * ec_max_insize;
+
+		len = params ? strlen(params) : 0;
+		if (len % 2 || len / 2 > ec_max_outsize) {
+			fprintf(stderr, "Bad params \"%s\"\n", params);
+			goto out;
+		}
+		for (j = 0; j < len / 2; j++) {
+			char byte[3] = { params[2 * j], params[2 * j + 1], 0 };
+
+			outbuf[i * ec_max_outsize + j] = strtoul(byte, &e, 16);
+			if (*e) {
+				fprintf(stderr, "Bad params \"%s\"\n", params);
+				goto out;
+			}
+		}
+		cmds[i].outsize = len / 2;
+	}
+
+	rv = ec_command_batch(cmds, count);
+	if (rv < 0) {
+		fprintf(stderr, "Batch failed: %d\n", rv);
+		goto out;
+	}
+
+	for (i = 0; i < count; i++) {
+		printf("0x%04x v%d: ", cmds[i].command, cmds[i].version);
+		if (cmds[i].rv < 0) {
+			printf("error %d\n", cmds[i].rv);
+			continue;
+		}
+		printf("%d bytes\n", cmds[i].rv);
+		hexdump(cmds[i].indata, cmds[i].rv);
+	}
+
+out:
+	free(cmds);
+	free(outbuf);
+	free(inbuf);
+	return rv;
+}
+
 /* NULL-terminated list of commands */
 const struct command commands[] = {
 	{"adcread", cmd_adc_read},
@@ -10617,6 +10945,7 @@ const struct command commands[] = {
 	{"autofanctrl", cmd_thermal_auto_fan_ctrl},
 	{"backlight", cmd_lcd_backlight},
 	{"basestate", cmd_basestate},
+	{"batch", cmd_batch},
 	{"battery", cmd_battery},
 	{"batterycutoff", cmd_battery_cut_off},
 	{"batteryparam", cmd_battery_vendor_param},
@@ -10629,6 +10958,7 @@ const struct command commands[] = {
 	{"chargestate", cmd_charge_state},
 	{"chipinfo", cmd_chipinfo},
 	{"cmdversions", cmd_cmdversions},
+	{"commbench", cmd_comm_bench},
 	{"console", cmd_console},
 	{"cec", cmd_cec},
 	{"echash", cmd_ec_hash},
@@ -10673,6 +11003,7 @@ const struct command commands[] = {
 	{"i2cprotect", cmd_i2c_protect},
 	{"i2cread", cmd_i2c_read},
 	{"i2cspeed", cmd_i2c_speed},
+	{"i2ctrace", cmd_i2c_trace},
 	{"i2cwrite", cmd_i2c_write},
 	{"i2cxfer", cmd_i2c_xfer},
 	{"infopddev", cmd_pd_device_info},
@@ -10682,6 +11013,7 @@ const struct command commands[] = {
 	{"kbfactorytest", cmd_keyboard_factory_test},
 	{"kbid", cmd_kbid},
 	{"kbinfo", cmd_kbinfo},
+	{"kblatency", cmd_kb_latency},
 	{"kbpress", cmd_kbpress},
 	{"keyconfig", cmd_keyconfig},
 	{"keyscan", cmd_keyscan},
@@ -10700,6 +11032,7 @@ const struct command commands[] = {
 	{"pdchipinfo", cmd_pd_chip_info},
 	{"pdwritelog", cmd_pd_write_log},
 	{"powerinfo", cmd_power_info},
+	{"powertimeline", cmd_power_timeline},
 	{"protoinfo", cmd_proto_info},
 	{"pse", cmd_pse},
 	{"pstoreinfo", cmd_pstore_info},
@@ -409,3 +409,128 @@ int cmd_i2c_speed(int argc, char *argv[])
 
 	return i2c_set(port, speed);
 }
+
+static void cmd_i2c_trace_help(const char *cmd)
+{
+	fprintf(stderr,
+		"Usage: %s read [csv]\n"
+		"       %s enable <port> <addr> [<addr-hi>]\n"
+		"       %s disable\n"
+		"  read: drain the binary trace ring, as text or as CSV\n"
+		"        (timestamp_us,port,addr,flags,write,read)\n"
+		"  enable: trace 7-bit addresses <addr>..<addr-hi> on <port>\n"
+		"  disable: stop tracing all addresses\n",
+		cmd, cmd, cmd);
+}
+
+static void print_i2c_trace_bytes(const char *sep, const uint8_t *data,
+				  int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		printf("%s0x%02X", i ? " " : sep, data[i]);
+}
+
+static void print_i2c_trace_record(const struct ec_i2c_trace_record *rec,
+				   int csv)
+{
+	if (csv) {
+		printf("%u,%d,0x%02X,0x%02X,", rec->timestamp, rec->port,
+		       rec->addr_flags & EC_I2C_ADDR_MASK, rec->flags);
+		print_i2c_trace_bytes("", rec->data, rec->out_size);
+		printf(",");
+		print_i2c_trace_bytes("", rec->data + rec->out_size,
+				      rec->in_size);
+		printf("\n");
+		return;
+	}
+
+	printf("%10u.%06u i2c: %d:0x%X", rec->timestamp / 1000000,
+	       rec->timestamp % 1000000, rec->port,
+	       rec->addr_flags & EC_I2C_ADDR_MASK);
+	if (rec->out_size)
+		print_i2c_trace_bytes(" wr ", rec->data, rec->out_size);
+	if (rec->in_size)
+		print_i2c_trace_bytes("  rd ", rec->data + rec->out_size,
+				      rec->in_size);
+	if (rec->flags & EC_I2C_TRACE_TRUNCATED)
+		printf(" ...");
+	printf("\n");
+}
+
+static int cmd_i2c_trace_read(int csv)
+{
+	struct ec_params_i2c_trace p = { .subcmd = EC_I2C_TRACE_READ };
+	struct ec_response_i2c_trace *r = ec_inbuf;
+	const struct ec_i2c_trace_record *rec;
+	int rv, offset;
+
+	if (csv)
+		printf("timestamp_us,port,addr,flags,write,read\n");
+
+	do {
+		rv = ec_command(EC_CMD_I2C_TRACE, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < (int)sizeof(*r) || (int)sizeof(*r) + r->size > rv) {
+			fprintf(stderr, "Truncated trace response\n");
+			return -1;
+		}
+
+		if (r->dropped)
+			fprintf(stderr, "%d records dropped\n", r->dropped);
+
+		for (offset = 0; offset < r->size;
+		     offset += sizeof(*rec) + rec->out_size + rec->in_size) {
+			rec = (const void *)(r->records + offset);
+			print_i2c_trace_record(rec, csv);
+		}
+	} while (r->size);
+
+	return 0;
+}
+
+int cmd_i2c_trace(int argc, char *argv[])
+{
+	struct ec_params_i2c_trace p = { 0 };
+	char *e;
+	int rv;
+
+	if (argc >= 2 && !strcasecmp(argv[1], "read")) {
+		if (argc == 2)
+			return cmd_i2c_trace_read(0);
+		if (argc == 3 && !strcasecmp(argv[2], "csv"))
+			return cmd_i2c_trace_read(1);
+	} else if (argc == 2 && !strcasecmp(argv[1], "disable")) {
+		p.subcmd = EC_I2C_TRACE_DISABLE;
+		return ec_command(EC_CMD_I2C_TRACE, 0, &p, sizeof(p), NULL, 0);
+	} else if ((argc == 4 || argc == 5) &&
+		   !strcasecmp(argv[1], "enable")) {
+		p.subcmd = EC_I2C_TRACE_ENABLE;
+		p.port = strtol(argv[2], &e, 0);
+		if (e && *e) {
+			fprintf(stderr, "Bad port.\n");
+			return -1;
+		}
+		p.addr_lo = strtol(argv[3], &e, 0);
+		if (e && *e) {
+			fprintf(stderr, "Bad address.\n");
+			return -1;
+		}
+		p.addr_hi = p.addr_lo;
+		if (argc == 5) {
+			p.addr_hi = strtol(argv[4], &e, 0);
+			if (e && *e) {
+				fprintf(stderr, "Bad address.\n");
+				return -1;
+			}
+		}
+		rv = ec_command(EC_CMD_I2C_TRACE, 0, &p, sizeof(p), NULL, 0);
+		return rv < 0 ? rv : 0;
+	}
+
+	cmd_i2c_trace_help(argv[0]);
+	return -1;
+}
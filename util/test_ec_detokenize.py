@@ -0,0 +1,97 @@
+# Copyright 2022 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+"""Test for the tokenized console decoder"""
+
+import base64
+import struct
+import unittest
+
+import ec_detokenize
+
+FORMATS = {
+    0x1000: '%d %x %c',
+    0x1010: '%s%.2s%%',
+    0x1020: '%ph %pb %pT',
+    0x1030: 'C%d: %05d|%-4u|%+d',
+    0x1040: '%q %d',
+}
+
+
+def lookup(address, _is_rw):
+    """Format string table standing in for the ELF"""
+    return FORMATS.get(address)
+
+
+def record(flags, address, args):
+    """Encode a record the way vfntokenize() does"""
+    data = bytes([flags]) + struct.pack('<I', address) + bytes(args)
+    return '$' + base64.b64encode(data).decode()
+
+
+class TestDetokenize(unittest.TestCase):
+    """Tests for the record decoder"""
+
+    def test_integers(self):
+        """Zigzag signed and LEB128 unsigned arguments"""
+        line = record(0, 0x1000, [0x05, 0x81, 0x01, 0xf6, 0x01])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup), '-3 81 {')
+
+    def test_strings(self):
+        """Length-prefixed strings"""
+        line = record(0, 0x1010, [0x02, ord('a'), ord('b'),
+                                  0x02, ord('x'), ord('y')])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup), 'abxy%')
+
+    def test_pointers(self):
+        """%ph, %pb and %pT"""
+        line = record(0, 0x1020, [0x02, 0x00, 0x5e, 0x06, 0x05, 0xc8, 0x01])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup),
+                         '005e 00101 0.000')
+        line = record(ec_detokenize.TOKENIZE_VERBOSE_TIME, 0x1020,
+                      [0x00, 0x00, 0xc8, 0x01])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup),
+                         '  0.000200')
+
+    def test_padding(self):
+        """Width, zero padding, left justification and sign"""
+        line = record(0, 0x1030, [0x02, 0x54, 0x07, 0x0a])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup),
+                         'C1: 00042|7   |+5')
+
+    def test_timestamp(self):
+        """cprints() style lines"""
+        flags = ec_detokenize.TOKENIZE_TIMESTAMP
+        line = record(flags, 0x1000,
+                      [0xc0, 0x84, 0x3d, 0x00, 0x00, 0x82, 0x01])
+        self.assertEqual(ec_detokenize.decode_line(line + '\r\n', lookup),
+                         '[1.000 0 0 A]\r\n')
+
+    def test_bad_specifier(self):
+        """vfnprintf() prints ERROR and stops"""
+        line = record(0, 0x1040, [])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup), 'ERROR')
+
+    def test_undecodable(self):
+        """Unknown tokens and plain text pass through"""
+        line = record(0, 0x2000, [])
+        self.assertEqual(ec_detokenize.decode_line(line, lookup), line)
+        line = 'Price is $5\n'
+        self.assertEqual(ec_detokenize.decode_line(line, lookup), line)
+
+    def test_elf(self):
+        """Strings come from PT_LOAD segments"""
+        strings = b'hello %d\0world\0'
+        ehdr = struct.pack('<4sBBBB8xHHIIIIIHHHHHH', b'\x7fELF', 1, 1, 1, 0,
+                           2, 40, 1, 0, 52, 0, 0, 52, 32, 1, 0, 0, 0)
+        phdr = struct.pack('<IIIIIIII', ec_detokenize.PT_LOAD, 84,
+                           0x10000000, 0x10000000, len(strings),
+                           len(strings), 4, 4)
+        elf = ec_detokenize.ElfStrings(ehdr + phdr + strings)
+        self.assertEqual(elf.string_at(0x10000000), 'hello %d')
+        self.assertEqual(elf.string_at(0x10000009), 'world')
+        self.assertIsNone(elf.string_at(0x20000000))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -218,6 +218,13 @@ int uart_tx_char_raw(void *context, int c)
 	return 0;
 }
 
+int uart_tx_str_raw(void *context, const char *str, int len)
+{
+	while (len--)
+		uart_write_char(*str++);
+	return 0;
+}
+
 void uart_write_char(char c)
 {
 	uart_poll_out(uart_shell_dev, c);